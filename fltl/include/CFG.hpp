@@ -36,14 +36,16 @@
 #include <cctype>
 #include <map>
 #include <list>
+#include <vector>
 #include <utility>
 #include <stdint.h>
 #include <functional>
 
 #include "fltl/include/helper/Align.hpp"
 #include "fltl/include/helper/Array.hpp"
+#include "fltl/include/helper/BitTree.hpp"
 #include "fltl/include/helper/BlockAllocator.hpp"
-#include "fltl/include/helper/StorageChain.hpp"
+#include "fltl/include/helper/ThreadLocal.hpp"
 #include "fltl/include/helper/UnsafeCast.hpp"
 
 #include "fltl/include/mpl/If.hpp"
@@ -82,6 +84,7 @@
     typedef typename type::symbol_string_type func(prefix, symbol_string_type); \
     typedef typename type::generator_type func(prefix, generator_type); \
     typedef typename type::pattern_type func(prefix, pattern_type); \
+    typedef typename type::frozen_grammar_type func(prefix, frozen_grammar_type); \
     typedef type func(prefix, cfg_type)
 
 #define FLTL_CFG_NO_PREFIX(prefix, str) str
@@ -107,6 +110,7 @@ namespace fltl {
         // forward declarations
         template <typename> class Variable;
         template <typename> class Production;
+        template <typename> class Occurrence;
         template <typename> class OpaqueProduction;
         template <typename> class ProductionBuilder;
         template <typename> class Symbol;
@@ -116,6 +120,8 @@ namespace fltl {
         template <typename, typename> class Unbound;
         template <typename> class Generator;
         template <typename> class OpaquePattern;
+        template <typename> class FrozenGrammar;
+        template <typename> class AnalysisCache;
 
         template <typename, typename> class Pattern;
         template <typename> class AnySymbol;
@@ -188,6 +194,7 @@ namespace fltl {
 #include "fltl/include/cfg/Symbol.hpp"
 #include "fltl/include/cfg/TerminalSymbol.hpp"
 #include "fltl/include/cfg/VariableSymbol.hpp"
+#include "fltl/include/cfg/Occurrence.hpp"
 #include "fltl/include/cfg/Production.hpp"
 #include "fltl/include/cfg/Variable.hpp"
 
@@ -219,8 +226,11 @@ namespace fltl {
         template <typename, typename>
         friend class cfg::detail::PatternGenerator;
 
-        template <typename, const unsigned>
-        friend class cfg::detail::SymbolStringAllocator;
+        /// allocators for the variables and productions of this grammar.
+        /// their blocks are freed all at once when the grammar is
+        /// destroyed, so productions must not outlive their grammar.
+        helper::BlockAllocator<cfg::Variable<AlphaT> > variable_allocator;
+        helper::BlockAllocator<cfg::Production<AlphaT> > production_allocator;
 
         /// the next variable id that can be assigned, goes toward +inf
         cfg::internal_sym_type next_variable_id;
@@ -232,12 +242,14 @@ namespace fltl {
         /// to the parameterized alphabet type. the association between
         /// terminals and their representations needs to be maintained.
         mutable helper::Array<std::pair<alphabet_type, const char *> > terminal_map;
-        typedef std::map<
-            alphabet_type,
-            cfg::internal_sym_type,
-            typename traits_type::less_type
-        > terminal_map_inv_type;
-        terminal_map_inv_type terminal_map_inv;
+
+        /// open-addressing hash index from alphabet values to terminals. each
+        /// slot holds the hash of the alphabet value and the terminal's
+        /// number, where number 0 marks an empty slot. the table is kept at
+        /// most half full so that probe sequences stay short.
+        typedef std::pair<uint32_t, unsigned> terminal_slot_type;
+        std::vector<terminal_slot_type> terminal_index;
+        unsigned terminal_index_mask;
 
         /// injective mapping between strings and terminal types representing
         /// variable terminals.
@@ -259,12 +271,20 @@ namespace fltl {
         > named_variable_map_type;
         named_variable_map_type named_variable_map;
 
+        /// the ids of the variables in variable_map, used to find the
+        /// neighbours of a variable without looking at every id
+        helper::BitTree variable_ids;
+
         /// unused variables
         cfg::Variable<AlphaT> *unused_variables;
 
         /// represents an upper-bound on any auto-generated symbol name
         mutable const char *auto_symbol_upper_bound;
 
+        /// copy of the upper bound above that is owned by the grammar, for
+        /// when the variable that had the name is freed (see compact)
+        const char *owned_symbol_upper_bound;
+
         /// number of productions and variables
         unsigned num_productions_;
         unsigned num_variables_;
@@ -276,15 +296,18 @@ namespace fltl {
         /// the start variable
         cfg::Variable<AlphaT> *start_variable;
 
-        /// allocator for variables
-        static helper::StorageChain<helper::BlockAllocator<
-            cfg::Variable<AlphaT>
-        > > variable_allocator;
+        /// reverse index from symbols to the productions that use them.
+        /// each entry is the sentinel of a symbol's list of occurrences,
+        /// or 0 if the symbol has never been used in a production.
+        std::vector<cfg::Occurrence<AlphaT> *> variable_occurrences;
+        std::vector<cfg::Occurrence<AlphaT> *> terminal_occurrences;
 
-        /// allocator for productions
-        static helper::StorageChain<helper::BlockAllocator<
-            cfg::Production<AlphaT>
-        > > production_allocator;
+        /// changes whenever the language or symbols of the grammar might
+        /// have changed
+        uint64_t modification_epoch_;
+
+        /// results of analyses of the grammar, or 0
+        mutable cfg::AnalysisCache<AlphaT> *analysis_cache;
 
         // copy constructor
         CFG(const CFG<AlphaT> &) throw() { assert(false); }
@@ -295,6 +318,53 @@ namespace fltl {
 
         typedef CFG<AlphaT> self_type;
 
+        /// find the slot of the terminal index that holds an alphabet value,
+        /// or the empty slot where it would go.
+        const terminal_slot_type &find_terminal_slot(
+            const alphabet_type &term,
+            const uint32_t hash
+        ) const throw() {
+            for(unsigned i(hash & terminal_index_mask); ;
+                i = (i + 1U) & terminal_index_mask) {
+
+                const terminal_slot_type &slot(terminal_index[i]);
+                if(0 == slot.second
+                || (hash == slot.first && traits_type::equal(
+                    term, terminal_map.get(slot.second).first
+                ))) {
+                    return slot;
+                }
+            }
+        }
+
+        /// add a new terminal to the terminal index, growing the index if
+        /// it is half full.
+        void add_terminal_slot(const uint32_t hash, const unsigned id) throw() {
+            if(((terminal_map.size() - 1U) * 2U) > terminal_index_mask) {
+                std::vector<terminal_slot_type> old_index(
+                    (terminal_index_mask + 1U) * 2U,
+                    terminal_slot_type(0U, 0U)
+                );
+                old_index.swap(terminal_index);
+                terminal_index_mask = terminal_index_mask * 2U + 1U;
+
+                for(unsigned i(0); i < old_index.size(); ++i) {
+                    if(0 != old_index[i].second) {
+                        insert_terminal_slot(old_index[i]);
+                    }
+                }
+            }
+
+            insert_terminal_slot(terminal_slot_type(hash, id));
+        }
+
+        void insert_terminal_slot(const terminal_slot_type &new_slot) throw() {
+            unsigned i(new_slot.first & terminal_index_mask);
+            for(; 0 != terminal_index[i].second;
+                i = (i + 1U) & terminal_index_mask) { }
+            terminal_index[i] = new_slot;
+        }
+
     public:
 
         /// arbitrary symbol (terminal, non-terminal) of a grammar
@@ -320,6 +390,9 @@ namespace fltl {
 
         typedef cfg::OpaquePattern<AlphaT> pattern_type;
 
+        /// read-only snapshot of the productions of the grammar
+        typedef cfg::FrozenGrammar<AlphaT> frozen_grammar_type;
+
         /// short forms
         typedef symbol_type sym_t;
         typedef symbol_buffer_type sym_buff_t;
@@ -339,18 +412,27 @@ namespace fltl {
         /// constructor
         CFG(void) throw()
             : trait::Uncopyable()
+            , variable_allocator()
+            , production_allocator()
             , next_variable_id(1)
             , next_terminal_id(-1)
             , terminal_map(256U)
-            , terminal_map_inv()
+            , terminal_index(16U, terminal_slot_type(0U, 0U))
+            , terminal_index_mask(15U)
             , variable_terminal_map()
             , variable_map(256U)
             , named_variable_map()
+            , variable_ids()
             , unused_variables(0)
+            , owned_symbol_upper_bound(0)
             , num_productions_(0)
             , num_variables_(0)
             , first_production(0)
             , start_variable(0)
+            , variable_occurrences()
+            , terminal_occurrences()
+            , modification_epoch_(0)
+            , analysis_cache(0)
             , _()
             , __()
         {
@@ -371,11 +453,14 @@ namespace fltl {
 
             unsigned j(0);
 
+            delete analysis_cache;
+            analysis_cache = 0;
+
             // free the variables
             const unsigned max(static_cast<unsigned>(next_variable_id));
             for(unsigned i(1U); i < max; ++i) {
                 if(0 != variable_map.get(i)) {
-                    variable_allocator->deallocate(variable_map.get(i));
+                    variable_allocator.deallocate(variable_map.get(i));
                     variable_map.set(i, 0);
                     ++j;
                 }
@@ -396,12 +481,22 @@ namespace fltl {
                 var = next_var) {
 
                 next_var = var->next;
-                variable_allocator->deallocate(var);
+                variable_allocator.deallocate(var);
                 ++j;
             }
 
+            // detach any occurrences of productions that are still
+            // referenced before freeing the lists
+            free_occurrences(variable_occurrences);
+            free_occurrences(terminal_occurrences);
+
+            if(0 != owned_symbol_upper_bound) {
+                trait::Alphabet<const char *>::destroy(owned_symbol_upper_bound);
+            }
+
             first_production = 0;
             unused_variables = 0;
+            owned_symbol_upper_bound = 0;
             num_productions_ = 0;
             auto_symbol_upper_bound = 0;
         }
@@ -419,6 +514,7 @@ namespace fltl {
         /// change the start variable
         void set_start_variable(const variable_type &var) throw() {
             start_variable = get_variable(var);
+            ++modification_epoch_;
         }
 
         /// get a variable symbol. a variable symbol is either a variable
@@ -448,6 +544,7 @@ namespace fltl {
             // create a variable terminal for it
             terminal_type term(next_terminal_id);
             --next_terminal_id;
+            ++modification_epoch_;
             const char *name_copy(trait::Alphabet<const char *>::copy(name));
             terminal_map.append(std::make_pair(
                 mpl::Static<alphabet_type>::VALUE,
@@ -477,6 +574,7 @@ namespace fltl {
 
             terminal_type term(next_terminal_id);
             --next_terminal_id;
+            ++modification_epoch_;
 
             const char *name(trait::Alphabet<const char *>::copy(buffer));
             terminal_map.append(std::make_pair(
@@ -532,7 +630,7 @@ namespace fltl {
             cfg::internal_sym_type var_id(1);
 
             if(0 == var) {
-                var = variable_allocator->allocate();
+                var = variable_allocator.allocate();
                 var->name = 0;
                 var_id = next_variable_id;
                 ++next_variable_id;
@@ -543,6 +641,8 @@ namespace fltl {
                 variable_map.set(static_cast<unsigned>(var_id), var);
             }
 
+            variable_ids.insert(static_cast<unsigned>(var_id));
+
             cfg::Variable<AlphaT> *prev(find_variable(var_id, -1));
             cfg::Variable<AlphaT> *next(find_variable(var_id, 1));
 
@@ -566,6 +666,7 @@ namespace fltl {
             }
 
             ++num_variables_;
+            ++modification_epoch_;
 
             variable_type ret(var_id);
             return ret;
@@ -624,7 +725,9 @@ namespace fltl {
 
             // clear out this var's info
             var->first_production = 0;
+            var->last_production = 0;
             var->num_productions = 0;
+            var->clear_production_index();
             var->prev = 0;
 
             // add it to the unused variable list
@@ -632,8 +735,10 @@ namespace fltl {
             unused_variables = var;
 
             variable_map.set(static_cast<unsigned>(var->id), 0);
+            variable_ids.remove(static_cast<unsigned>(var->id));
 
             --num_variables_;
+            ++modification_epoch_;
         }
 
         /// remove a variable and all productions in the grammar that
@@ -684,34 +789,60 @@ namespace fltl {
 
         /// does this grammar have this particular terminal?
         bool has_terminal(const alphabet_type term) const throw() {
-            return 0 != terminal_map_inv.count(term);
+            return 0 != find_terminal_slot(term, traits_type::hash(term)).second;
+        }
+
+        /// look up the terminal for an alphabet value. returns false if the
+        /// grammar has no such terminal, in which case found is unchanged.
+        bool find_terminal(
+            const alphabet_type term,
+            terminal_type &found
+        ) const throw() {
+            const unsigned id(
+                find_terminal_slot(term, traits_type::hash(term)).second
+            );
+            if(0 == id) {
+                return false;
+            }
+            found = terminal_type(-static_cast<cfg::internal_sym_type>(id));
+            return true;
         }
 
         /// get the terminal reference for a particular terminal.
         const terminal_type get_terminal(const alphabet_type term) throw() {
-            typename terminal_map_inv_type::iterator pos(
-                terminal_map_inv.find(term)
-            );
+            const uint32_t hash(traits_type::hash(term));
+            const terminal_slot_type &slot(find_terminal_slot(term, hash));
             cfg::internal_sym_type term_id;
 
             // add in the terminal
-            if(terminal_map_inv.end() == pos) {
+            if(0 == slot.second) {
                 term_id = next_terminal_id;
                 --next_terminal_id;
                 alphabet_type copy(traits_type::copy(term));
                 terminal_map.append(std::make_pair<alphabet_type,const char *>(
                     copy, 0
                 ));
-                terminal_map_inv[copy] = term_id;
+                add_terminal_slot(hash, static_cast<unsigned>(-term_id));
+                ++modification_epoch_;
 
             // return the terminal
             } else {
-                term_id = (*pos).second;
+                term_id = -static_cast<cfg::internal_sym_type>(slot.second);
             }
 
             return terminal_type(term_id);
         }
 
+        /// get the terminal reference for a terminal that is already in
+        /// this grammar, without changing the grammar.
+        const terminal_type get_terminal(const alphabet_type term) const throw() {
+            const unsigned id(
+                find_terminal_slot(term, traits_type::hash(term)).second
+            );
+            assert(0 != id);
+            return terminal_type(-static_cast<cfg::internal_sym_type>(id));
+        }
+
         inline bool has_start_variable(void) const throw() {
             return 0 != start_variable;
         }
@@ -774,85 +905,64 @@ namespace fltl {
         ) throw() {
 
             cfg::Variable<AlphaT> *var(get_variable(_var));
-            cfg::Production<AlphaT> *prod(production_allocator->allocate());
-
-            prod->var = var;
-            prod->symbols.assign(str);
-
-            ++num_productions_;
-            ++(var->num_productions);
+            cfg::Production<AlphaT> *prod(var->find_production(
+                str,
+                0 == str.symbols ? 0U : static_cast<uint32_t>(
+                    symbol_type::mix32(str.symbols[cfg::str::HASH].value)
+                )
+            ));
 
-            // if we have a no productions then add this production in
-            if(0 == var->first_production) {
+            // duplicate found; it might have been deleted but still be
+            // referenced, in which case it comes back to life
+            if(0 != prod) {
+                if(prod->is_deleted) {
+                    prod->is_deleted = false;
+                    cfg::Production<AlphaT>::hold(prod);
+                    ++num_productions_;
+                    ++(var->num_productions);
+                    ++modification_epoch_;
+
+                    if(0 != analysis_cache) {
+                        analysis_cache->added_production(production_type(prod));
+                    }
 
-                prod->next = 0;
-                var->first_production = prod;
-                cfg::Production<AlphaT>::hold(prod);
+                    // the production might come before the first one
+                    if(0 != first_production && first_production->var == var) {
+                        set_next_production(var->id);
+                    }
+                }
 
-            // no null production; go look for equivalent productions to
-            // make sure we don't add a duplicate
+            // add the production to the end of the variable's productions
             } else {
+                prod = production_allocator.allocate();
+                prod->allocator = &production_allocator;
+                prod->var = var;
+                prod->symbols.assign(str);
+                prod->next = 0;
+                prod->prev = var->last_production;
+                index_occurrences(prod);
 
-                cfg::Production<AlphaT> *related_prod(var->first_production);
-                cfg::Production<AlphaT> *prev_prod(0);
-
-                // make sure the production is unique
-                for(; 0 != related_prod;
-                    prev_prod = related_prod,
-                    related_prod = related_prod->next) {
-
-                    // we've found our insertion point
-                    if(prod->is_less_than(*related_prod)) {
-
-                        prod->next = related_prod;
-                        prod->prev = related_prod->prev;
-                        related_prod->prev = prod;
-
-                        if(0 == prod->prev) {
-                            var->first_production = prod;
-                        } else {
-                            prod->prev->next = prod;
-                        }
-
-                        cfg::Production<AlphaT>::hold(prod);
-                        goto done;
-
-                    // insertion sort by hash value
-                    } else if(prod->is_greater_than(*related_prod)) {
-                        continue;
+                if(0 == var->last_production) {
+                    var->first_production = prod;
+                } else {
+                    var->last_production->next = prod;
+                }
 
-                    // possible duplicate found
-                    } else if(related_prod->is_equivalent_to(*prod)) {
+                var->last_production = prod;
+                var->index_production(prod);
+                cfg::Production<AlphaT>::hold(prod);
 
-                        if(related_prod->is_deleted) {
-                            related_prod->is_deleted = false;
-                            cfg::Production<AlphaT>::hold(related_prod);
-                        } else {
-                            --num_productions_;
-                            --(var->num_productions);
-                        }
+                ++num_productions_;
+                ++(var->num_productions);
+                ++modification_epoch_;
 
-                        production_allocator->deallocate(prod);
-                        prod = related_prod;
-                        goto done;
-                    }
+                if(0 != analysis_cache) {
+                    analysis_cache->added_production(production_type(prod));
                 }
-
-                // add to the end of the list
-
-                assert(0 != prev_prod);
-                prev_prod->next = prod;
-                prod->prev = prev_prod;
-                prod->next = 0;
-                cfg::Production<AlphaT>::hold(prod);
             }
 
-        done:
-
-            if(0 == first_production
-            || first_production->var->id > var->id
-            || (first_production->var->id == var->id
-                && prod->is_less_than(*first_production))) {
+            // every other production of var is deleted
+            if(0 == first_production || first_production->var->id > var->id) {
                 first_production = prod;
             }
 
@@ -909,15 +1019,274 @@ namespace fltl {
 
             // go find the next production
             if(first_production == prod) {
-                set_next_production(var->id);
+                set_next_production(prod);
             }
 
             --num_productions_;
             --(var->num_productions);
+            ++modification_epoch_;
+
+            if(0 != analysis_cache) {
+                analysis_cache->removed_production(_prod);
+            }
 
             cfg::Production<AlphaT>::release(prod);
         }
 
+        /// drop the deleted productions that are still referenced, free
+        /// the removed variables, and renumber the remaining variables
+        /// from 1 without gaps, keeping their order. remap is filled in
+        /// with the new number of each old variable number, or 0 if the
+        /// variable was removed. terminals are never removed, so their
+        /// numbers don't change.
+        ///
+        /// !!! symbols, symbol strings, and frozen grammars from before
+        ///     the compaction keep the old numbers, and no generators may
+        ///     be in use. productions that use removed variables must
+        ///     have been removed.
+        void compact(std::vector<unsigned> &remap) throw() {
+            const unsigned old_capacity(static_cast<unsigned>(next_variable_id));
+            remap.assign(old_capacity, 0U);
+
+            // the new number of each variable
+            std::vector<cfg::Variable<AlphaT> *> vars;
+            vars.push_back(0);
+            for(cfg::Variable<AlphaT> *var(find_variable_from(1));
+                0 != var;
+                var = var->next) {
+                remap[static_cast<unsigned>(var->id)] = static_cast<unsigned>(
+                    vars.size()
+                );
+                vars.push_back(var);
+            }
+
+            const unsigned new_capacity(static_cast<unsigned>(vars.size()));
+
+            // drop the deleted productions. whoever is holding them sees
+            // them as productions of a removed variable
+            for(unsigned i(1U); i < new_capacity; ++i) {
+                cfg::Variable<AlphaT> *var(vars[i]);
+                cfg::Production<AlphaT> *prod(var->first_production);
+
+                var->first_production = 0;
+                var->last_production = 0;
+                var->clear_production_index();
+
+                for(cfg::Production<AlphaT> *next_prod(0); 0 != prod; prod = next_prod) {
+                    next_prod = prod->next;
+
+                    if(prod->is_deleted) {
+                        if(0 != prod->occurrences) {
+                            for(unsigned j(0), len(prod->length()); j < len; ++j) {
+                                prod->occurrences[j].unlink();
+                            }
+                        }
+                        prod->var = 0;
+                        prod->next = 0;
+                        prod->prev = helper::unsafe_cast<
+                            cfg::Production<AlphaT> *
+                        >(var);
+                        continue;
+                    }
+
+                    prod->prev = var->last_production;
+                    prod->next = 0;
+                    if(0 == var->last_production) {
+                        var->first_production = prod;
+                    } else {
+                        var->last_production->next = prod;
+                    }
+                    var->last_production = prod;
+                }
+            }
+
+            // renumber the symbols of the productions; the hashes of the
+            // productions change, so their indexes are rebuilt
+            std::vector<symbol_type> syms;
+            for(unsigned i(1U); i < new_capacity; ++i) {
+                cfg::Variable<AlphaT> *var(vars[i]);
+
+                for(cfg::Production<AlphaT> *prod(var->first_production);
+                    0 != prod;
+                    prod = prod->next) {
+
+                    const unsigned len(prod->length());
+                    bool uses_variable(false);
+
+                    syms.clear();
+                    for(unsigned j(0); j < len; ++j) {
+                        symbol_type sym(prod->symbols.at(j));
+                        if(sym.is_variable()) {
+                            assert(
+                                0 != remap[sym.number()] &&
+                                "Production uses a removed variable."
+                            );
+                            sym.value = static_cast<cfg::internal_sym_type>(
+                                remap[sym.number()]
+                            );
+                            uses_variable = true;
+                        }
+                        syms.push_back(sym);
+                    }
+
+                    if(uses_variable) {
+                        prod->symbols.assign(symbol_string_type(&(syms[0]), len));
+                    }
+                }
+            }
+
+            for(unsigned i(1U); i < new_capacity; ++i) {
+                cfg::Variable<AlphaT> *var(vars[i]);
+                var->id = static_cast<cfg::internal_sym_type>(i);
+
+                for(cfg::Production<AlphaT> *prod(var->first_production);
+                    0 != prod;
+                    prod = prod->next) {
+                    var->index_production(prod);
+                }
+            }
+
+            // move the occurrences of the variables to their new numbers
+            std::vector<cfg::Occurrence<AlphaT> *> occurrences(new_capacity, 0);
+            for(unsigned i(0); i < variable_occurrences.size(); ++i) {
+                cfg::Occurrence<AlphaT> *sentinel(variable_occurrences[i]);
+                if(0 == sentinel) {
+                    continue;
+                } else if(0 != remap[i]) {
+                    occurrences[remap[i]] = sentinel;
+                    continue;
+                }
+
+                assert(
+                    sentinel->next == sentinel &&
+                    "Production uses a removed variable."
+                );
+                delete sentinel;
+            }
+            variable_occurrences.swap(occurrences);
+
+            typename named_variable_map_type::iterator it(
+                named_variable_map.begin()
+            );
+            for(; named_variable_map.end() != it; ) {
+                const unsigned id((*it).second.number());
+                if(0 == remap[id]) {
+                    named_variable_map.erase(it++);
+                } else {
+                    (*it).second.value = static_cast<cfg::internal_sym_type>(
+                        remap[id]
+                    );
+                    ++it;
+                }
+            }
+
+            // free the removed variables, keeping their names alive if one
+            // of them is the upper bound on automatic names
+            for(cfg::Variable<AlphaT> *var(unused_variables), *next_var(0);
+                0 != var;
+                var = next_var) {
+
+                next_var = var->next;
+
+                if(0 != var->name && auto_symbol_upper_bound == var->name) {
+                    if(0 != owned_symbol_upper_bound) {
+                        trait::Alphabet<const char *>::destroy(
+                            owned_symbol_upper_bound
+                        );
+                    }
+                    owned_symbol_upper_bound = var->name;
+                    var->name = 0;
+                }
+
+                variable_allocator.deallocate(var);
+            }
+            unused_variables = 0;
+
+            variable_map.set_size(0);
+            variable_ids = helper::BitTree();
+            for(unsigned i(0); i < new_capacity; ++i) {
+                variable_map.append(vars[i]);
+                if(0 != i) {
+                    variable_ids.insert(i);
+                }
+            }
+
+            next_variable_id = static_cast<cfg::internal_sym_type>(new_capacity);
+            set_next_production(1);
+            ++modification_epoch_;
+        }
+
+        /// compact the grammar without keeping the new variable numbers
+        void compact(void) throw() {
+            std::vector<unsigned> remap;
+            compact(remap);
+        }
+
+
+        /// pack the productions of the grammar into a read-only snapshot
+        /// for analyses that don't change the grammar.
+        void freeze(frozen_grammar_type &frozen) const throw() {
+            const unsigned num_vars(static_cast<unsigned>(next_variable_id));
+
+            frozen.variables.clear();
+            frozen.production_offsets.assign(num_vars + 1U, 0U);
+            frozen.symbol_offsets.clear();
+            frozen.production_variables.clear();
+            frozen.symbols.clear();
+
+            frozen.variables.reserve(num_variables_);
+            frozen.symbol_offsets.reserve(num_productions_ + 1U);
+            frozen.production_variables.reserve(num_productions_);
+
+            frozen.num_terminals_ = num_terminals();
+            frozen.start_variable_ = 0 == start_variable
+                ? 0U
+                : static_cast<unsigned>(start_variable->id);
+
+            unsigned next_id(0);
+            unsigned num_prods(0);
+
+            for(cfg::Variable<AlphaT> *var(find_variable_from(1));
+                0 != var;
+                var = var->next) {
+
+                const unsigned id(static_cast<unsigned>(var->id));
+
+                for(; next_id <= id; ++next_id) {
+                    frozen.production_offsets[next_id] = num_prods;
+                }
+
+                frozen.variables.push_back(id);
+
+                for(cfg::Production<AlphaT> *prod(var->first_production);
+                    0 != prod;
+                    prod = prod->next) {
+
+                    if(prod->is_deleted) {
+                        continue;
+                    }
+
+                    frozen.symbol_offsets.push_back(
+                        static_cast<unsigned>(frozen.symbols.size())
+                    );
+                    frozen.production_variables.push_back(id);
+
+                    for(unsigned i(0), len(prod->length()); i < len; ++i) {
+                        frozen.symbols.push_back(prod->symbols.at(i));
+                    }
+
+                    ++num_prods;
+                }
+            }
+
+            for(; next_id <= num_vars; ++next_id) {
+                frozen.production_offsets[next_id] = num_prods;
+            }
+
+            frozen.symbol_offsets.push_back(
+                static_cast<unsigned>(frozen.symbols.size())
+            );
+        }
 
         /// get the variable representing the empty string, epsilon
         inline const symbol_string_type &epsilon(void) const throw() {
@@ -956,6 +1325,29 @@ namespace fltl {
             return static_cast<unsigned>(variable_terminal_map.size());
         }
 
+        /// a number that changes every time that productions, variables,
+        /// or terminals are added to or removed from the grammar, or the
+        /// start variable changes. results of analyses can be kept for as
+        /// long as the epoch that they were computed at is current.
+        inline uint64_t modification_epoch(void) const throw() {
+            return modification_epoch_;
+        }
+
+        /// get the results of analyses kept along with this grammar, or 0
+        inline cfg::AnalysisCache<AlphaT> *get_analysis_cache(void) const throw() {
+            return analysis_cache;
+        }
+
+        /// keep the results of analyses along with this grammar. the
+        /// grammar takes ownership of the cache, and deletes any previous
+        /// one.
+        void set_analysis_cache(cfg::AnalysisCache<AlphaT> *cache) const throw() {
+            if(cache != analysis_cache) {
+                delete analysis_cache;
+                analysis_cache = cache;
+            }
+        }
+
         /// create a variable generator
         inline generator_type
         search(cfg::Unbound<AlphaT, cfg::variable_tag> sym) const throw() {
@@ -1096,34 +1488,124 @@ namespace fltl {
         cfg::Variable<AlphaT> *find_variable(
             const cfg::internal_sym_type id,
             const cfg::internal_sym_type increment
+        ) const throw() {
+            const unsigned next_id(0 < increment
+                ? variable_ids.find_next(static_cast<unsigned>(id))
+                : variable_ids.find_prev(static_cast<unsigned>(id))
+            );
+
+            if(helper::BitTree::NOT_FOUND == next_id) {
+                return 0;
+            }
+
+            return variable_map.get(next_id);
+        }
+
+        /// go find the variable with the smallest id that is at least id
+        cfg::Variable<AlphaT> *
+        find_variable_from(const cfg::internal_sym_type id) const throw() {
+            if(variable_ids.contains(static_cast<unsigned>(id))) {
+                return variable_map.get(static_cast<unsigned>(id));
+            }
+            return find_variable(id, 1);
+        }
+
+        /// get the sentinel of the occurrences of a symbol, or 0 if the
+        /// symbol has never been used.
+        cfg::Occurrence<AlphaT> *
+        find_occurrences(const cfg::internal_sym_type value) const throw() {
+            const std::vector<cfg::Occurrence<AlphaT> *> &occurrences(
+                0 < value ? variable_occurrences : terminal_occurrences
+            );
+            const unsigned id(static_cast<unsigned>(0 < value ? value : -value));
+
+            if(id >= occurrences.size()) {
+                return 0;
+            }
+
+            return occurrences[id];
+        }
+
+        /// add each symbol of a new production to the end of that symbol's
+        /// occurrences.
+        void index_occurrences(cfg::Production<AlphaT> *prod) throw() {
+            const unsigned len(prod->length());
+
+            if(0 == len) {
+                return;
+            }
+
+            prod->occurrences = new cfg::Occurrence<AlphaT>[len];
+
+            for(unsigned i(0); i < len; ++i) {
+                const symbol_type &sym(prod->symbols.at(i));
+                std::vector<cfg::Occurrence<AlphaT> *> &occurrences(
+                    sym.is_variable() ? variable_occurrences : terminal_occurrences
+                );
+                const unsigned id(sym.number());
+
+                if(id >= occurrences.size()) {
+                    occurrences.resize(id + 1U, 0);
+                }
+
+                if(0 == occurrences[id]) {
+                    occurrences[id] = new cfg::Occurrence<AlphaT>;
+                }
+
+                prod->occurrences[i].production = prod;
+                prod->occurrences[i].position = i;
+                prod->occurrences[i].link_before(occurrences[id]);
+            }
+        }
+
+        /// free the sentinels of some occurrence lists
+        static void free_occurrences(
+            std::vector<cfg::Occurrence<AlphaT> *> &occurrences
         ) throw() {
-            cfg::Variable<AlphaT> *next(0);
-            for(cfg::internal_sym_type i(id + increment);
-                i < next_variable_id && 0 < i;
-                i += increment) {
-
-                next = variable_map.get(static_cast<unsigned>(i));
-                if(0 != next) {
-                    break;
+            for(unsigned i(0); i < occurrences.size(); ++i) {
+                cfg::Occurrence<AlphaT> *sentinel(occurrences[i]);
+                if(0 == sentinel) {
+                    continue;
                 }
+
+                for(; sentinel->next != sentinel; ) {
+                    sentinel->next->unlink();
+                }
+
+                delete sentinel;
             }
-            return next;
+            occurrences.clear();
+        }
+
+        /// go find and set the first production that isn't deleted after
+        /// some production
+        void set_next_production(cfg::Production<AlphaT> *prod) throw() {
+            cfg::Production<AlphaT> *next(prod->next);
+
+            for(cfg::Variable<AlphaT> *var(prod->var); 0 != var; ) {
+                for(; 0 != next; next = next->next) {
+                    if(!next->is_deleted) {
+                        first_production = next;
+                        return;
+                    }
+                }
+
+                var = var->next;
+                if(0 != var) {
+                    next = var->first_production;
+                }
+            }
+
+            first_production = 0;
         }
 
         /// go find and set the next production
         void set_next_production(const cfg::internal_sym_type id) throw() {
             cfg::Production<AlphaT> *next(0);
-            cfg::Variable<AlphaT> *next_var(0);
-
-            for(cfg::internal_sym_type i(id);
-                i < next_variable_id;
-                ++i) {
-
-                next_var = variable_map.get(static_cast<unsigned>(i));
 
-                if(0 == next_var) {
-                    continue;
-                }
+            for(cfg::Variable<AlphaT> *next_var(find_variable_from(id));
+                0 != next_var;
+                next_var = next_var->next) {
 
                 for(next = next_var->first_production;
                     0 != next;
@@ -1181,17 +1663,6 @@ namespace fltl {
             return true;
         }
     };
-
-    // initialize the static variables
-    template <typename AlphaT>
-    helper::StorageChain<helper::BlockAllocator<
-        cfg::Variable<AlphaT>
-    > > CFG<AlphaT>::variable_allocator;
-
-    template <typename AlphaT>
-    helper::StorageChain<helper::BlockAllocator<
-        cfg::Production<AlphaT>
-    > > CFG<AlphaT>::production_allocator(CFG<AlphaT>::variable_allocator);
 }
 
 #include "fltl/include/cfg/ProductionBuilder.hpp"
@@ -1202,5 +1673,7 @@ namespace fltl {
 #include "fltl/include/cfg/Generator.hpp"
 #include "fltl/include/cfg/Pattern.hpp"
 #include "fltl/include/cfg/OpaquePattern.hpp"
+#include "fltl/include/cfg/FrozenGrammar.hpp"
+#include "fltl/include/cfg/AnalysisCache.hpp"
 
 #endif /* FLTL_LIB_CONTEXTFREEGRAMMAR_HPP_ */
@@ -38,7 +38,6 @@
 
 #include "fltl/include/helper/Array.hpp"
 #include "fltl/include/helper/BlockAllocator.hpp"
-#include "fltl/include/helper/StorageChain.hpp"
 #include "fltl/include/helper/UnsafeCast.hpp"
 
 #include "fltl/include/trait/Alphabet.hpp"
@@ -193,6 +192,12 @@ namespace fltl {
             typename traits_type::less_type
         > symbol_map_inv_type;
 
+        /// allocators for the transitions and search patterns of this PDA.
+        /// their blocks are freed all at once when the PDA is destroyed,
+        /// so transitions must not outlive their PDA.
+        helper::BlockAllocator<pda::Transition<AlphaT> > transition_allocator;
+        mutable helper::BlockAllocator<pda::Pattern<AlphaT> > pattern_allocator;
+
         /// bijective mapping between external alphabet elements and the
         /// symbols used to represent those alphabet elements.
         symbol_map_inv_type symbol_map_inv;
@@ -238,16 +243,6 @@ namespace fltl {
         /// the first transition of this PDA
         pda::Transition<AlphaT> *first_transition;
 
-        /// transition allocator
-        static helper::StorageChain<helper::BlockAllocator<
-            pda::Transition<AlphaT>
-        > > transition_allocator;
-
-        /// pattern allocator
-        static helper::StorageChain<helper::BlockAllocator<
-            pda::Pattern<AlphaT>
-        > > pattern_allocator;
-
     public:
 
         /// represents any state or symbol
@@ -255,7 +250,9 @@ namespace fltl {
 
         /// constructor
         PDA(void) throw()
-            : symbol_map_inv()
+            : transition_allocator()
+            , pattern_allocator()
+            , symbol_map_inv()
             , symbol_map(256U)
             , state_transitions(256U)
             , start_state()
@@ -799,7 +796,8 @@ namespace fltl {
             ]);
 
             // initialize the pattern
-            pda::Pattern<AlphaT> *pattern(pattern_allocator->allocate());
+            pda::Pattern<AlphaT> *pattern(pattern_allocator.allocate());
+            pattern->allocator = &pattern_allocator;
             pda::pattern::Init<AlphaT>::init(&source_state, &(pattern->source));
             pda::pattern::Init<AlphaT>::init(&read_symbol, &(pattern->read));
             pda::pattern::Init<AlphaT>::init(&pop_symbol, &(pattern->pop));
@@ -886,7 +884,7 @@ namespace fltl {
         ) throw() {
 
             bool added(true);
-            pda::Transition<AlphaT> *trans(transition_allocator->allocate());
+            pda::Transition<AlphaT> *trans(transition_allocator.allocate());
 
             trans->source_state = source_state;
             trans->sym_read = read;
@@ -894,6 +892,7 @@ namespace fltl {
             trans->sym_push = push;
             trans->sink_state = sink_state;
             trans->pda = this;
+            trans->allocator = &transition_allocator;
 
             pda::Transition<AlphaT> *prev(0);
             pda::Transition<AlphaT> *curr(state_transitions.get(
@@ -929,7 +928,7 @@ namespace fltl {
                         curr->is_deleted = false;
                     }
 
-                    transition_allocator->deallocate(trans);
+                    transition_allocator.deallocate(trans);
                     trans = curr;
                     added = false;
 
@@ -973,17 +972,6 @@ namespace fltl {
         }
 
     };
-
-    // static initialize
-    template <typename AlphaT>
-    helper::StorageChain<helper::BlockAllocator<
-        pda::Pattern<AlphaT>
-    > > PDA<AlphaT>::pattern_allocator;
-
-    template <typename AlphaT>
-    helper::StorageChain<helper::BlockAllocator<
-        pda::Transition<AlphaT>
-    > > PDA<AlphaT>::transition_allocator(pattern_allocator);
 }
 
 #endif /* FLTL_PDA_HPP_ */
@@ -0,0 +1,68 @@
+/*
+ * AnalysisCache.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_ANALYSIS_CACHE_HPP_
+#define FLTL_ANALYSIS_CACHE_HPP_
+
+namespace fltl { namespace cfg {
+
+    /// base class of the results of analyses that are kept along with a
+    /// grammar (see CFG::set_analysis_cache), so that they are computed
+    /// once and shared by whoever needs them. the grammar owns its cache
+    /// and deletes it when the grammar is destroyed.
+    ///
+    /// Note: - the grammar does not clear the cache when it changes; the
+    ///         cached results should remember the modification epoch of
+    ///         the grammar that they were computed at (see
+    ///         CFG::modification_epoch).
+    ///
+    ///       - the grammar tells its cache about every production that is
+    ///         added or removed, after the epoch changes, so that the
+    ///         results can be brought up to date instead of being computed
+    ///         again. other changes are only seen through the epoch.
+    template <typename AlphaT>
+    class AnalysisCache {
+    public:
+
+        virtual ~AnalysisCache(void) throw() { }
+
+        /// a production was added to the grammar, or a removed production
+        /// came back
+        virtual void added_production(
+            const OpaqueProduction<AlphaT> &
+        ) throw() { }
+
+        /// a production was removed from the grammar
+        virtual void removed_production(
+            const OpaqueProduction<AlphaT> &
+        ) throw() { }
+    };
+
+}}
+
+#endif /* FLTL_ANALYSIS_CACHE_HPP_ */
@@ -0,0 +1,152 @@
+/*
+ * FrozenGrammar.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_FROZEN_GRAMMAR_HPP_
+#define FLTL_FROZEN_GRAMMAR_HPP_
+
+namespace fltl { namespace cfg {
+
+    /// read-only snapshot of the productions of a grammar (see CFG::freeze)
+    /// packed into flat arrays, so that analyses can go over the grammar
+    /// with plain indices instead of generators.
+    ///
+    /// Note: - productions are numbered from zero, and are ordered by
+    ///         variable and then in the order that the CFG generates them.
+    ///         the productions of variable V are the productions in
+    ///         [productions_begin(V), productions_end(V)).
+    ///
+    ///       - the snapshot does not follow later changes to the CFG.
+    template <typename AlphaT>
+    class FrozenGrammar {
+    public:
+
+        typedef Symbol<AlphaT> symbol_type;
+
+    private:
+
+        friend class CFG<AlphaT>;
+
+        /// numbers of the variables of the grammar, in order
+        std::vector<unsigned> variables;
+
+        /// offset of the first production of each variable, indexed by
+        /// variable number, plus one past the last variable
+        std::vector<unsigned> production_offsets;
+
+        /// offset of the first symbol of each production, plus one past
+        /// the last production
+        std::vector<unsigned> symbol_offsets;
+
+        /// number of the variable of each production
+        std::vector<unsigned> production_variables;
+
+        /// symbols of all productions
+        std::vector<symbol_type> symbols;
+
+        unsigned num_terminals_;
+
+        /// number of the start variable, or zero if there is none
+        unsigned start_variable_;
+
+    public:
+
+        FrozenGrammar(void) throw()
+            : variables()
+            , production_offsets(1U, 0U)
+            , symbol_offsets(1U, 0U)
+            , production_variables()
+            , symbols()
+            , num_terminals_(0)
+            , start_variable_(0)
+        { }
+
+        /// one more than the largest variable number of the grammar
+        inline unsigned num_variables_capacity(void) const throw() {
+            return static_cast<unsigned>(production_offsets.size() - 1U);
+        }
+
+        inline unsigned num_variables(void) const throw() {
+            return static_cast<unsigned>(variables.size());
+        }
+
+        /// number of the ith variable of the grammar
+        inline unsigned variable(const unsigned i) const throw() {
+            return variables[i];
+        }
+
+        inline unsigned num_terminals(void) const throw() {
+            return num_terminals_;
+        }
+
+        inline unsigned num_productions(void) const throw() {
+            return static_cast<unsigned>(production_variables.size());
+        }
+
+        inline bool has_start_variable(void) const throw() {
+            return 0 != start_variable_;
+        }
+
+        inline unsigned start_variable(void) const throw() {
+            return start_variable_;
+        }
+
+        inline unsigned productions_begin(const unsigned var) const throw() {
+            return production_offsets[var];
+        }
+
+        inline unsigned productions_end(const unsigned var) const throw() {
+            return production_offsets[var + 1U];
+        }
+
+        /// number of the variable of a production
+        inline unsigned production_variable(const unsigned prod) const throw() {
+            return production_variables[prod];
+        }
+
+        inline unsigned length(const unsigned prod) const throw() {
+            return symbol_offsets[prod + 1U] - symbol_offsets[prod];
+        }
+
+        inline const symbol_type *symbols_begin(const unsigned prod) const throw() {
+            if(symbols.empty()) {
+                return 0;
+            }
+            return &(symbols[0]) + symbol_offsets[prod];
+        }
+
+        inline const symbol_type *symbols_end(const unsigned prod) const throw() {
+            if(symbols.empty()) {
+                return 0;
+            }
+            return &(symbols[0]) + symbol_offsets[prod + 1U];
+        }
+    };
+
+}}
+
+#endif /* FLTL_FROZEN_GRAMMAR_HPP_ */
@@ -103,16 +103,9 @@ namespace fltl { namespace cfg {
 
                     // start by looking back at the same variable just in
                     // case the variable was re-added after being deleted
-                    for(unsigned i(static_cast<unsigned>(curr_var->id)),
-                        max(static_cast<unsigned>(cfg->next_variable_id));
-                        i < max;
-                        ++i) {
-
-                        curr_var = cfg->variable_map.get(i);
-                        if(0 != curr_var) {
-                            next_prod = curr_var->first_production;
-                            break;
-                        }
+                    curr_var = cfg->find_variable_from(curr_var->id);
+                    if(0 != curr_var) {
+                        next_prod = curr_var->first_production;
                     }
                 }
 
@@ -190,6 +183,7 @@ namespace fltl { namespace cfg {
                     Production<AlphaT>::release(state->cursor.production);
                     state->cursor.production = 0;
                 }
+                state->occurrence = 0;
             }
 
             /// reset the variable generator
@@ -215,8 +209,16 @@ namespace fltl { namespace cfg {
                 const unsigned num_vars(state->cfg->variable_map.size());
 
                 Variable<AlphaT> *var(0);
-                for(; 0 == var && offset < num_vars; ++offset) {
-                    var = state->cfg->variable_map.get(offset);
+                if(offset < num_vars) {
+                    var = state->cfg->find_variable_from(
+                        static_cast<internal_sym_type>(offset)
+                    );
+                }
+
+                if(0 == var) {
+                    offset = num_vars;
+                } else {
+                    offset = static_cast<unsigned>(var->id) + 1U;
                 }
 
                 state->cursor.variable_offset = offset;
@@ -263,16 +265,178 @@ namespace fltl { namespace cfg {
         /// template for complex patterns
         template <typename AlphaT, typename PatternBuilderT>
         class PatternGenerator {
+        private:
+
+            /// find the first occurrence at or after some occurrence that
+            /// is the first occurrence of its symbol in a production that
+            /// hasn't been deleted
+            static Occurrence<AlphaT> *
+            find_occurrence(Occurrence<AlphaT> *occurrence) throw() {
+                for(; 0 != occurrence->production;
+                    occurrence = occurrence->next) {
+
+                    Production<AlphaT> *prod(occurrence->production);
+                    if(0 != prod->var
+                    && !prod->is_deleted
+                    && occurrence->is_first_in_production()) {
+                        return occurrence;
+                    }
+                }
+                return 0;
+            }
+
+            /// go through the occurrences of the pattern's first bound
+            /// symbol instead of through every production of the grammar
+            static bool bind_next_occurrence(Generator<AlphaT> *state) throw() {
+
+                Production<AlphaT> *orig_prod(state->cursor.production);
+                Occurrence<AlphaT> *occurrence(state->occurrence);
+                OpaqueProduction<AlphaT> opaque_prod;
+
+                OpaqueProduction<AlphaT> *binder(
+                    helper::unsafe_cast<OpaqueProduction<AlphaT> *>(
+                        state->binder
+                    )
+                );
+
+                // the held production might have been deleted since it was
+                // found
+                if(0 != occurrence) {
+                    occurrence = find_occurrence(occurrence);
+                }
+
+                for(; 0 != occurrence; ) {
+                    opaque_prod.assign(occurrence->production);
+                    if(PatternBuilderT::static_match(state->pattern, opaque_prod)) {
+                        break;
+                    }
+                    occurrence = find_occurrence(occurrence->next);
+                }
+
+                // hold the next production before letting go of the one we
+                // were holding, as it might take its occurrences with it
+                state->occurrence = 0;
+                state->cursor.production = 0;
+
+                if(0 != occurrence) {
+                    state->occurrence = find_occurrence(occurrence->next);
+                    if(0 != state->occurrence) {
+                        state->cursor.production = state->occurrence->production;
+                        Production<AlphaT>::hold(state->cursor.production);
+                    }
+                }
+
+                if(0 != orig_prod) {
+                    Production<AlphaT>::release(orig_prod);
+                }
+
+                if(0 == occurrence) {
+                    opaque_prod.assign(0);
+                }
+
+                if(0 != binder) {
+                    *binder = opaque_prod;
+                }
+
+                return 0 != occurrence;
+            }
+
+            /// try to go through the occurrences of the first bound symbol
+            /// of the right-hand side of the pattern. like the variable of
+            /// a pattern, the symbol is read when the generator is reset.
+            /// the index is not used if the symbol is also bound by the
+            /// pattern itself, as its value then changes while matching.
+            static bool reset_next_occurrence(Generator<AlphaT> *state) throw() {
+                const int offset(PatternBuilderT::BOUND_SYMBOL_OFFSET);
+                if(0 > offset) {
+                    return false;
+                }
+
+                PatternData<AlphaT> *pattern(state->pattern);
+                const Symbol<AlphaT> *sym(pattern->slots[offset].as_symbol);
+
+                if(sym == pattern->var) {
+                    return false;
+                }
+
+                for(int i(0); i < PatternData<AlphaT>::NUM_SLOTS; ++i) {
+                    if(i != offset && sym == pattern->slots[i].as_symbol) {
+                        return false;
+                    }
+                }
+
+                Occurrence<AlphaT> *sentinel(
+                    state->cfg->find_occurrences(sym->value)
+                );
+
+                state->cursor.production = 0;
+                state->occurrence = 0;
+
+                if(0 != sentinel) {
+                    state->occurrence = find_occurrence(sentinel->next);
+                }
+
+                if(0 != state->occurrence) {
+                    state->cursor.production = state->occurrence->production;
+                    Production<AlphaT>::hold(state->cursor.production);
+                }
+
+                return true;
+            }
+
+            /// find the next production that the pattern might match. if
+            /// the pattern is bound to a variable then only the productions
+            /// of that variable are looked at.
+            static Production<AlphaT> *
+            find_next_production(
+                CFG<AlphaT> *cfg,
+                Production<AlphaT> *prod
+            ) throw() {
+                if(1 != PatternBuilderT::IS_BOUND_TO_VAR) {
+                    return SimpleGenerator<AlphaT>::find_next_production(
+                        cfg,
+                        prod
+                    );
+                }
+
+                // the variable was removed along with its productions
+                if(0 == prod || 0 == prod->var) {
+                    return 0;
+                }
+
+                for(prod = prod->next;
+                    0 != prod && prod->is_deleted;
+                    prod = prod->next) { }
+
+                return prod;
+            }
+
+            static Production<AlphaT> *
+            find_current_production(
+                CFG<AlphaT> *cfg,
+                Production<AlphaT> *prod
+            ) throw() {
+                if(0 != prod && (0 == prod->var || prod->is_deleted)) {
+                    return find_next_production(cfg, prod);
+                }
+                return prod;
+            }
+
         public:
 
             static bool bind_next_pattern(Generator<AlphaT> *state) throw() {
 
+                if(0 != state->occurrence) {
+                    return bind_next_occurrence(state);
+                }
+
                 // remember the production that the generator is holding
                 Production<AlphaT> *orig_prod(state->cursor.production);
                 OpaqueProduction<AlphaT> opaque_prod;
-                Production<AlphaT> *curr_prod(SimpleGenerator<
-                    AlphaT
-                >::find_current_production(state->cfg, orig_prod));
+                Production<AlphaT> *curr_prod(find_current_production(
+                    state->cfg,
+                    orig_prod
+                ));
 
                 OpaqueProduction<AlphaT> *binder(
                     helper::unsafe_cast<OpaqueProduction<AlphaT> *>(
@@ -300,10 +464,7 @@ namespace fltl { namespace cfg {
 
                 while(!PatternBuilderT::static_match(state->pattern, opaque_prod)) {
 
-                    curr_prod = SimpleGenerator<AlphaT>::find_next_production(
-                        state->cfg,
-                        curr_prod
-                    );
+                    curr_prod = find_next_production(state->cfg, curr_prod);
                     opaque_prod.assign(curr_prod);
 
                     // can't match
@@ -319,7 +480,7 @@ namespace fltl { namespace cfg {
                 }
 
                 // go find the next production
-                state->cursor.production = SimpleGenerator<AlphaT>::find_next_production(
+                state->cursor.production = find_next_production(
                     state->cfg,
                     curr_prod
                 );
@@ -333,6 +494,8 @@ namespace fltl { namespace cfg {
 
             static void reset_next_pattern(Generator<AlphaT> *state) throw() {
                 state->free_func(state);
+                state->occurrence = 0;
+
                 if(1 == PatternBuilderT::IS_BOUND_TO_VAR) {
                     Variable<AlphaT> *var(state->cfg->variable_map.get(
                         static_cast<unsigned>(
@@ -346,6 +509,9 @@ namespace fltl { namespace cfg {
                         state->cursor.production = var->first_production;
                     }
 
+                } else if(reset_next_occurrence(state)) {
+                    return;
+
                 } else {
                     state->cursor.production = state->cfg->first_production;
                 }
@@ -390,6 +556,10 @@ namespace fltl { namespace cfg {
 
         } cursor;
 
+        /// occurrence of a symbol in the production bound by the cursor if
+        /// the generator is going through the occurrences of that symbol
+        Occurrence<AlphaT> *occurrence;
+
         /// pointer to some sort of type to which we are binding results
         void *binder;
         detail::PatternData<AlphaT> *pattern;
@@ -416,6 +586,7 @@ namespace fltl { namespace cfg {
             free_func_type *_free_func
         ) throw()
             : cfg(_cfg)
+            , occurrence(0)
             , binder(_binder)
             , pattern(_pattern)
             , binder_func(_binder_func)
@@ -434,6 +605,7 @@ namespace fltl { namespace cfg {
 
         Generator(void) throw()
             : cfg(0)
+            , occurrence(0)
             , binder(0)
             , pattern(0)
             , binder_func(&detail::default_gen_next)
@@ -447,6 +619,7 @@ namespace fltl { namespace cfg {
         /// copy constructor for public use
         Generator(const self_type &that) throw()
             : cfg(that.cfg)
+            , occurrence(that.occurrence)
             , binder(that.binder)
             , pattern(that.pattern)
             , binder_func(that.binder_func)
@@ -481,6 +654,7 @@ namespace fltl { namespace cfg {
 
             cfg = that.cfg;
             memcpy(&cursor, &(that.cursor), sizeof cursor);
+            occurrence = that.occurrence;
             binder = that.binder;
             pattern = that.pattern;
             binder_func = that.binder_func;
@@ -0,0 +1,116 @@
+/*
+ * Occurrence.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_OCCURRENCE_HPP_
+#define FLTL_OCCURRENCE_HPP_
+
+namespace fltl { namespace cfg {
+
+    /// an occurrence of a symbol at some position in the right-hand side
+    /// of a production.
+    ///
+    /// Note: - the occurrences of a symbol are chained into a circular
+    ///         doubly-linked list whose head is a sentinel occurrence that
+    ///         has no production. the CFG owns the sentinels.
+    ///
+    ///       - each production owns one occurrence per symbol, and all of
+    ///         them are added to the lists at once, so the occurrences of
+    ///         one symbol in one production are adjacent in that symbol's
+    ///         list, in order of position.
+    template <typename AlphaT>
+    class Occurrence {
+    private:
+
+        friend class CFG<AlphaT>;
+        friend class Production<AlphaT>;
+        template <typename, typename> friend class detail::PatternGenerator;
+
+        typedef Occurrence<AlphaT> self_type;
+
+        /// occurrences chain in to a circular doubly-linked list
+        self_type *prev;
+        self_type *next;
+
+        /// production containing the symbol, or 0 for a sentinel
+        Production<AlphaT> *production;
+
+        /// position of the symbol in the production
+        unsigned position;
+
+        /// add this occurrence to the end of a list
+        inline void link_before(self_type *sentinel) throw() {
+            prev = sentinel->prev;
+            next = sentinel;
+            prev->next = this;
+            sentinel->prev = this;
+        }
+
+        /// remove this occurrence from its list; this can be done any
+        /// number of times.
+        inline void unlink(void) throw() {
+            prev->next = next;
+            next->prev = prev;
+            prev = this;
+            next = this;
+        }
+
+        /// is this the first occurrence of its symbol in its production?
+        inline bool is_first_in_production(void) const throw() {
+            return prev->production != production;
+        }
+
+    public:
+
+        Occurrence(void) throw()
+            : prev(this)
+            , next(this)
+            , production(0)
+            , position(0)
+        { }
+
+        ~Occurrence(void) throw() {
+            prev = 0;
+            next = 0;
+            production = 0;
+        }
+
+    private:
+
+        Occurrence(const self_type &) throw() {
+            assert(false);
+        }
+
+        self_type &operator=(const self_type &) throw() {
+            assert(false);
+            return *this;
+        }
+    };
+
+}}
+
+#endif /* FLTL_OCCURRENCE_HPP_ */
@@ -702,7 +702,15 @@ namespace fltl { namespace cfg {
         public:
 
             enum {
-                IS_BOUND_TO_VAR = mpl::IfTypesEqual<VarTagT,variable_tag>::RESULT
+                IS_BOUND_TO_VAR = mpl::IfTypesEqual<VarTagT,variable_tag>::RESULT,
+
+                // offset of the slot of the first bound symbol in the
+                // right-hand side, or negative if there is none
+                BOUND_SYMBOL_OFFSET = pattern::GetBoundSymbolOffset<
+                    StringT,
+                    typename pattern::GetFactor<StringT,0>::type,
+                    0
+                >::RESULT
             };
 
             friend class CFG<AlphaT>;
@@ -784,7 +792,15 @@ namespace fltl { namespace cfg {
         public:
 
             enum {
-                IS_BOUND_TO_VAR = mpl::IfTypesEqual<VarTagT,variable_tag>::RESULT
+                IS_BOUND_TO_VAR = mpl::IfTypesEqual<VarTagT,variable_tag>::RESULT,
+
+                // offset of the slot of the first bound symbol in the
+                // right-hand side, or negative if there is none
+                BOUND_SYMBOL_OFFSET = pattern::GetBoundSymbolOffset<
+                    StringT,
+                    typename pattern::GetFactor<StringT,0>::type,
+                    0
+                >::RESULT
             };
 
             friend class CFG<AlphaT>;
@@ -898,8 +914,11 @@ namespace fltl { namespace cfg {
             /// slots holding pointers back to pattern data
             detail::Slot<AlphaT> slots[NUM_SLOTS];
 
-            /// allocator for patterns
-            static helper::BlockAllocator<self_type, 8U> pattern_allocator;
+            /// allocator for patterns; patterns are built before they are
+            /// given to a grammar, so each thread has its own allocator.
+            typedef helper::ThreadLocal<
+                helper::BlockAllocator<self_type, 8U>
+            > pattern_allocator;
 
         public:
 
@@ -950,19 +969,19 @@ namespace fltl { namespace cfg {
         public:
 
             static self_type *allocate(variable_type *_var) throw() {
-                self_type *self(pattern_allocator.allocate());
+                self_type *self(pattern_allocator::get()->allocate());
                 self->var = _var;
                 return self;
             }
 
             static self_type *allocate(Unbound<AlphaT, variable_tag> *_var) throw() {
-                self_type *self(pattern_allocator.allocate());
+                self_type *self(pattern_allocator::get()->allocate());
                 self->var = _var->symbol;
                 return self;
             }
 
             static self_type *allocate(AnySymbol<AlphaT> *) throw() {
-                return pattern_allocator.allocate();
+                return pattern_allocator::get()->allocate();
             }
 
             static void incref(self_type *self) throw() {
@@ -971,17 +990,10 @@ namespace fltl { namespace cfg {
 
             static void decref(PatternData<AlphaT> *self) throw() {
                 if(0 == --(self->ref_count)) {
-                    pattern_allocator.deallocate(self);
+                    pattern_allocator::get()->deallocate(self);
                 }
             }
         };
-
-        /// static allocator for patterns
-        template <typename AlphaT>
-        helper::BlockAllocator<
-            PatternData<AlphaT>,
-            8U
-        > PatternData<AlphaT>::pattern_allocator;
     }
 
     template <typename AlphaT, typename VarTagT>
@@ -65,6 +65,12 @@ namespace fltl { namespace cfg {
         /// symbols of this production
         SymbolString<AlphaT> symbols;
 
+        /// occurrences of each symbol of this production, one per position
+        Occurrence<AlphaT> *occurrences;
+
+        /// allocator of the grammar that owns this production
+        helper::BlockAllocator<self_type> *allocator;
+
         /// reference counter
         uint32_t ref_count;
 
@@ -126,16 +132,43 @@ namespace fltl { namespace cfg {
                     if(0 != prod->next->var) {
                         prod->next->prev = prod->prev;
                     }
+                } else if(0 != prod->var) {
+                    prod->var->last_production = prod->prev;
+                }
+
+                if(0 != prod->var) {
+                    prod->var->unindex_production(prod);
+                }
+
+                if(0 != prod->occurrences) {
+                    for(unsigned i(0), len(prod->length()); i < len; ++i) {
+                        prod->occurrences[i].unlink();
+                    }
+                    delete [] prod->occurrences;
+                    prod->occurrences = 0;
                 }
 
                 prod->next = 0;
                 prod->prev = 0;
                 prod->symbols.clear();
-                CFG<AlphaT>::production_allocator->deallocate(prod);
+                prod->allocator->deallocate(prod);
                 prod = 0;
             }
         }
 
+        /// hash of this production's symbols, used to find duplicate
+        /// productions of a variable
+        inline uint32_t index_hash(void) const throw() {
+            if(0 == symbols.symbols) {
+                return 0U;
+            }
+            return static_cast<uint32_t>(Symbol<AlphaT>::mix32(
+                symbols.symbols[str::HASH].value
+            ));
+        }
+
+        /// order productions by the hashes of their symbols, and then
+        /// lexicographically if the hashes collide
         inline bool is_less_than(const self_type &that) const throw() {
             if(0 == symbols.symbols && 0 == that.symbols.symbols) {
                 return false;
@@ -143,22 +176,12 @@ namespace fltl { namespace cfg {
                 return true;
             } else if(0 == that.symbols.symbols) {
                 return false;
-            } else {
+            } else if(symbols.symbols[str::HASH].value
+                   != that.symbols.symbols[str::HASH].value) {
                 return symbols.symbols[str::HASH].value
                      < that.symbols.symbols[str::HASH].value;
-            }
-        }
-
-        inline bool is_greater_than(const self_type &that) const throw() {
-            if(0 == symbols.symbols && 0 == that.symbols.symbols) {
-                return false;
-            } else if(0 == symbols.symbols) {
-                return false;
-            } else if(0 == that.symbols.symbols) {
-                return true;
             } else {
-                return symbols.symbols[str::HASH].value
-                     > that.symbols.symbols[str::HASH].value;
+                return symbols < that.symbols;
             }
         }
 
@@ -170,6 +193,8 @@ namespace fltl { namespace cfg {
             , next(0)
             , var()
             , symbols()
+            , occurrences(0)
+            , allocator(0)
             , ref_count(0)
             , is_deleted(false)
         { }
@@ -179,6 +204,8 @@ namespace fltl { namespace cfg {
             , next(0)
             , var()
             , symbols()
+            , occurrences(0)
+            , allocator(0)
             , ref_count(0)
             , is_deleted(false)
         {
@@ -152,7 +152,7 @@ namespace fltl { namespace cfg {
                 return ret;
             }
 
-            ret.symbols = symbol_string_type::allocate(total_len);
+            ret.allocate_symbols(total_len);
             ret.symbols[str::FIRST_SYMBOL].value = value;
             ret.symbols[
                 str::FIRST_SYMBOL + this_len
@@ -166,7 +166,8 @@ namespace fltl { namespace cfg {
                 ret.symbols[str::HASH].value = (
                     symbol_string_type::hash(
                         hash(),
-                        that.hash()
+                        that.hash(),
+                        that_len
                     )
                 );
             }
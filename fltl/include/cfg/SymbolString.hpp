@@ -36,6 +36,12 @@
 // allocators
 #define FLTL_SYMBOL_STRING_ALLOC_LIST_SIZE 64U
 
+// longest symbol string that is stored inside of the symbol string object
+// instead of in a shared array
+#ifndef FLTL_SYMBOL_STRING_INLINE_LENGTH
+#define FLTL_SYMBOL_STRING_INLINE_LENGTH 4U
+#endif
+
 // element in a statically initialized array for a de/allocator
 #define FLTL_SYMBOL_STRING_INIT_FUNC(n, func) \
     , &detail::SymbolArray<AlphaT,n>::func
@@ -71,13 +77,13 @@ namespace fltl { namespace cfg {
             static Symbol<AlphaT> *allocate(const unsigned) throw() {
                 return SymbolStringAllocator<
                     AlphaT,num_symbols
-                >::allocator->allocate()->symbols;
+                >::allocator::get()->allocate()->symbols;
             }
 
             static void deallocate(Symbol<AlphaT> *ptr) throw() {
                 SymbolStringAllocator<
                     AlphaT,num_symbols
-                >::allocator->deallocate(
+                >::allocator::get()->deallocate(
                     helper::unsafe_cast<SymbolArray<AlphaT, num_symbols> *>(
                         ptr
                     )
@@ -89,25 +95,17 @@ namespace fltl { namespace cfg {
             { }
         };
 
-        /// static allocator for symbol arrays
+        /// allocator for symbol arrays. symbol strings aren't owned by
+        /// any one grammar, so each thread has its own allocator.
         template <typename AlphaT, const unsigned num_symbols>
         class SymbolStringAllocator {
         public:
-            static helper::StorageChain<helper::BlockAllocator<
+            typedef helper::ThreadLocal<helper::BlockAllocator<
                 SymbolArray<AlphaT, num_symbols>,
                 FLTL_SYMBOL_STRING_ALLOC_LIST_SIZE
             > > allocator;
         };
 
-        /// static initialize the symbol array's allocator
-        template <typename AlphaT, const unsigned num_symbols>
-        helper::StorageChain<helper::BlockAllocator<
-            SymbolArray<AlphaT, num_symbols>,
-            FLTL_SYMBOL_STRING_ALLOC_LIST_SIZE
-        > > SymbolStringAllocator<AlphaT, num_symbols>::allocator(
-            CFG<AlphaT>::production_allocator
-        );
-
         /// symbol array of size zero, i.e. flexible symbol array
         template <typename AlphaT>
         class SymbolArray<AlphaT, 0U> {
@@ -128,6 +126,10 @@ namespace fltl { namespace cfg {
     ///
     /// Note: - the first symbol is a reference count
     ///       - the second symbol is the length of the symbol string
+    ///       - short strings (at most FLTL_SYMBOL_STRING_INLINE_LENGTH
+    ///         symbols) are stored inside of the symbol string and are
+    ///         copied by value; longer strings are in shared arrays that
+    ///         are reference counted.
     ///       - a symbol string that was constructed using prod.symbols()
     ///         to get all symbols of a production has *undefined* behavior
     ///         if the symbol string is used after the production has been
@@ -183,9 +185,18 @@ namespace fltl { namespace cfg {
         static Symbol<AlphaT> EPSILON;
         static internal_sym_type EPSILON_HASH;
 
-        /// the symbols of this string
+        enum {
+            INLINE_LENGTH = FLTL_SYMBOL_STRING_INLINE_LENGTH
+        };
+
+        /// the symbols of this string: 0 for the empty string, either
+        /// inline_symbols or a shared array otherwise
         mutable symbol_type *symbols;
 
+        /// storage for short strings, with the same layout as a shared
+        /// array
+        symbol_type inline_symbols[str::FIRST_SYMBOL + INLINE_LENGTH];
+
         /// allocate a new array of symbols and increase its reference count
         static symbol_type *
         allocate(const unsigned num_symbols) throw() {
@@ -215,6 +226,50 @@ namespace fltl { namespace cfg {
             return syms;
         }
 
+        /// make room for the symbols of this string, which must be empty.
+        /// short strings use the inline storage.
+        inline symbol_type *allocate_symbols(const unsigned num_symbols) throw() {
+            if(0 == num_symbols) {
+                symbols = 0;
+            } else if(INLINE_LENGTH >= num_symbols) {
+                symbols = inline_symbols;
+                symbols[str::REF_COUNT].value = 0;
+                symbols[str::LENGTH].value = static_cast<internal_sym_type>(
+                    num_symbols
+                );
+            } else {
+                symbols = allocate(num_symbols);
+            }
+            return symbols;
+        }
+
+        inline bool is_inline(void) const throw() {
+            return symbols == inline_symbols;
+        }
+
+        /// make this (empty) string have the same symbols as another
+        /// string. short strings are copied, and long ones are shared.
+        inline void share(const self_type &that) throw() {
+            if(that.is_inline()) {
+                const unsigned end(str::FIRST_SYMBOL + that.length());
+                for(unsigned i(0); i < end; ++i) {
+                    inline_symbols[i].value = that.inline_symbols[i].value;
+                }
+                symbols = inline_symbols;
+            } else {
+                symbols = that.symbols;
+                incref(symbols);
+            }
+        }
+
+        /// empty this string
+        inline void release(void) throw() {
+            if(!is_inline()) {
+                decref(symbols);
+            }
+            symbols = 0;
+        }
+
         /// increase the reference count on a symbol array
         static void incref(symbol_type *syms) throw() {
             if(0 != syms) {
@@ -254,7 +309,7 @@ namespace fltl { namespace cfg {
             const unsigned len = length();
 
             self_type ret;
-            ret.symbols = allocate(len + 1U);
+            ret.allocate_symbols(len + 1U);
             ret.symbols[str::FIRST_SYMBOL + len] = *sym;
 
             if(0 != len) {
@@ -266,7 +321,8 @@ namespace fltl { namespace cfg {
 
                 ret.symbols[str::HASH].value = hash(
                     symbols[str::HASH].value,
-                    sym->hash()
+                    sym->hash(),
+                    1U
                 );
             } else {
                 ret.symbols[str::HASH].value = sym->hash();
@@ -284,7 +340,7 @@ namespace fltl { namespace cfg {
             const unsigned len = length();
 
             self_type ret;
-            ret.symbols = allocate(len + 1U);
+            ret.allocate_symbols(len + 1U);
             ret.symbols[str::FIRST_SYMBOL] = *sym;
 
             if(0 != len) {
@@ -295,8 +351,9 @@ namespace fltl { namespace cfg {
                 );
 
                 ret.symbols[str::HASH].value = hash(
+                    sym->hash(),
                     symbols[str::HASH].value,
-                    sym->hash()
+                    len
                 );
             } else {
                 ret.symbols[str::HASH].value = sym->hash();
@@ -305,18 +362,32 @@ namespace fltl { namespace cfg {
             return ret;
         }
 
-        /// very simple associative, commutative hash function
-        FLTL_FORCE_INLINE static internal_sym_type hash(
-            const internal_sym_type a,
-            const internal_sym_type b
+        /// the base of the polynomial hash of symbol strings
+        enum {
+            HASH_BASE = 0x9E3779B1U
+        };
+
+        /// hash of the concatenation of two strings, given their hashes and
+        /// the length of the second string. the hash of a string s1 ... sn
+        /// is (h(s1) * B^(n-1) + ... + h(sn)) mod 2^32, where h is the hash
+        /// of a symbol, and so the hash depends on the order of the symbols
+        /// and can be extended at either end.
+        inline static internal_sym_type hash(
+            const internal_sym_type lhash,
+            const internal_sym_type rhash,
+            unsigned rlen
         ) throw() {
-            return a * b;
-            //return symbol_type::mix32(a * b);
-            //return (a * b) % 3931;
-            /*return symbol_type::mix32(
-            //    ((b & 0xFF0000FF) | (a & 0x00FFFF00)) *
-                ((a & 0x0FFF000F) | (b & 0xF000FFF0))
-            );*/
+            uint32_t scale(1U);
+            for(uint32_t base(HASH_BASE); 0 != rlen; rlen >>= 1U) {
+                if(0 != (rlen & 1U)) {
+                    scale *= base;
+                }
+                base *= base;
+            }
+            return static_cast<internal_sym_type>(
+                static_cast<uint32_t>(lhash) * scale
+              + static_cast<uint32_t>(rhash)
+            );
         }
 
         /// get the hash of this symbol
@@ -332,14 +403,14 @@ namespace fltl { namespace cfg {
             const symbol_type *syms,
             const unsigned num_syms
         ) throw() {
-            internal_sym_type ihash(syms->hash());
+            uint32_t ihash(static_cast<uint32_t>(syms->hash()));
             for(const symbol_type *sym(syms + 1), *last(syms + num_syms);
                 sym < last;
                 ++sym) {
 
-                ihash = hash(ihash, sym->hash());
+                ihash = ihash * HASH_BASE + static_cast<uint32_t>(sym->hash());
             }
-            return ihash;
+            return static_cast<internal_sym_type>(ihash);
         }
 
         /// works even if symbol_type has a virtual destructor, whereas
@@ -361,7 +432,7 @@ namespace fltl { namespace cfg {
         {
 
             if(0 < num_syms) {
-                symbols = allocate(num_syms);
+                allocate_symbols(num_syms);
                 memcpy(
                     &(symbols[str::FIRST_SYMBOL]),
                     arr,
@@ -382,7 +453,7 @@ namespace fltl { namespace cfg {
             : symbols(0)
         {
             if(0 != sym.value) {
-                symbols = allocate(1U);
+                allocate_symbols(1U);
                 symbols[str::FIRST_SYMBOL] = sym;
                 symbols[str::HASH].value = sym.hash();
             }
@@ -390,29 +461,26 @@ namespace fltl { namespace cfg {
 
         /// copy constructor
         SymbolString(const self_type &that) throw()
-            : symbols(const_cast<symbol_type *>(that.symbols))
+            : symbols(0)
         {
-            incref(symbols);
+            share(that);
         }
 
         /// destructor
         ~SymbolString(void) throw() {
-            decref(symbols);
-            symbols = 0;
+            release();
         }
 
         /// clear out this symbol string
         void clear(void) throw() {
-            decref(symbols);
-            symbols = 0;
+            release();
         }
 
         /// assign by reference contained in value
         void assign(const self_type that) throw() {
             if(symbols != that.symbols) {
-                decref(symbols);
-                symbols = const_cast<symbol_type *>(that.symbols);
-                incref(symbols);
+                release();
+                share(that);
             }
         }
 
@@ -422,18 +490,16 @@ namespace fltl { namespace cfg {
                 return *this;
             }
 
-            decref(symbols);
-            symbols = const_cast<symbol_type *>(that.symbols);
-            incref(symbols);
+            release();
+            share(that);
 
             return *this;
         }
 
         self_type &operator=(const symbol_type sym) throw() {
-            decref(symbols);
-            symbols = 0;
+            release();
             if(0 != sym.value) {
-                symbols = allocate(1U);
+                allocate_symbols(1U);
                 symbols[str::FIRST_SYMBOL] = sym;
                 symbols[str::HASH].value = sym.hash();
             }
@@ -442,19 +508,19 @@ namespace fltl { namespace cfg {
 
         /// copy a symbol string by value
         void copy(const self_type &that) throw() {
-            decref(symbols);
-
-            if(0 == that.symbols) {
+            if(symbols == that.symbols) {
+                return;
+            }
 
-                symbols = 0;
+            release();
 
-            } else if(symbols != that.symbols) {
+            if(0 != that.symbols) {
 
                 const unsigned str_length(static_cast<unsigned>(
                     that.symbols[str::LENGTH].value
                 ));
 
-                symbols = allocate(str_length);
+                allocate_symbols(str_length);
                 symbols[str::HASH] = that.symbols[str::HASH];
                 memcpy(
                     &(symbols[str::FIRST_SYMBOL]),
@@ -482,11 +548,10 @@ namespace fltl { namespace cfg {
             const unsigned other_len = that.length();
 
             self_type ret;
-            ret.symbols = allocate(len + other_len);
-            if(0 != ret.symbols) {
+            if(0 != ret.allocate_symbols(len + other_len)) {
 
-                internal_sym_type lhash(1);
-                internal_sym_type rhash(1);
+                internal_sym_type lhash(0);
+                internal_sym_type rhash(0);
 
                 if(0 != len) {
                     memcpy(
@@ -506,7 +571,7 @@ namespace fltl { namespace cfg {
                     rhash = that.symbols[str::HASH].value;
                 }
 
-                ret.symbols[str::HASH].value = hash(lhash, rhash);
+                ret.symbols[str::HASH].value = hash(lhash, rhash, other_len);
             }
 
             return ret;
@@ -554,11 +619,9 @@ namespace fltl { namespace cfg {
 
             if(len == stride) {
                 return *this;
-            } else if(0 == stride) {
-                ret.symbols = allocate(0);
             } else {
 
-                ret.symbols = allocate(stride);
+                ret.allocate_symbols(stride);
                 memcpy(
                     &(ret.symbols[str::FIRST_SYMBOL]),
                     &(symbols[str::FIRST_SYMBOL + start]),
@@ -607,6 +670,11 @@ namespace fltl { namespace cfg {
                 // actually accessing it
                 &(this_syms[str::LENGTH + this_len])
             )) {
+                // short strings aren't shared
+                if(is_inline() || that.is_inline()) {
+                    return true;
+                }
+
                 // TODO: this might be overkill
                 if(this_syms[str::REF_COUNT].value
                  < that_syms[str::REF_COUNT].value) {
@@ -51,12 +51,21 @@ namespace fltl { namespace cfg {
         Variable<AlphaT> *next;
         Variable<AlphaT> *prev;
 
-        /// the first production related to this variable
+        /// the first and last productions related to this variable. new
+        /// productions are added to the end of the list.
         Production<AlphaT> *first_production;
+        Production<AlphaT> *last_production;
 
         /// the number of productions
         unsigned num_productions;
 
+        /// open-addressing hash set of the productions in the list above,
+        /// including deleted productions that are still referenced. the set
+        /// uses linear probing and is kept at most half full.
+        Production<AlphaT> **production_index;
+        unsigned production_index_mask;
+        unsigned production_index_size;
+
         /// the name associated with this variable. if the name is 0 then
         /// an automatic name is generated when the CFG is printed. note:
         /// the name is *owned* by the variable
@@ -69,7 +78,11 @@ namespace fltl { namespace cfg {
             , next(0)
             , prev(0)
             , first_production(0)
+            , last_production(0)
             , num_productions(0)
+            , production_index(0)
+            , production_index_mask(0)
+            , production_index_size(0)
             , name(0)
         { }
 
@@ -96,6 +109,109 @@ namespace fltl { namespace cfg {
 
             name = 0;
             num_productions = 0;
+            last_production = 0;
+            clear_production_index();
+        }
+
+    private:
+
+        /// find a production of this variable with the same symbols as a
+        /// string whose production hash is index_hash, or return 0.
+        Production<AlphaT> *find_production(
+            const SymbolString<AlphaT> &syms,
+            const uint32_t index_hash
+        ) const throw() {
+            if(0 == production_index) {
+                return 0;
+            }
+
+            for(unsigned i(index_hash & production_index_mask); ;
+                i = (i + 1U) & production_index_mask) {
+
+                Production<AlphaT> *prod(production_index[i]);
+                if(0 == prod
+                || (index_hash == prod->index_hash() && syms == prod->symbols)) {
+                    return prod;
+                }
+            }
+        }
+
+        /// add a production to the index; the production must not already
+        /// be in the index.
+        void index_production(Production<AlphaT> *prod) throw() {
+            if(((production_index_size + 1U) * 2U) > production_index_mask) {
+                Production<AlphaT> **old_index(production_index);
+                const unsigned old_size(production_index_mask + 1U);
+                const unsigned new_size(0 == production_index ? 8U : old_size * 2U);
+
+                production_index = new Production<AlphaT> *[new_size];
+                production_index_mask = new_size - 1U;
+                memset(production_index, 0, new_size * sizeof(prod));
+
+                if(0 != old_index) {
+                    for(unsigned i(0); i < old_size; ++i) {
+                        if(0 != old_index[i]) {
+                            insert_production(old_index[i]);
+                        }
+                    }
+                    delete [] old_index;
+                }
+            }
+
+            insert_production(prod);
+            ++production_index_size;
+        }
+
+        /// remove a production from the index, shifting back later entries
+        /// of its probe sequence so that lookups don't need tombstones.
+        void unindex_production(Production<AlphaT> *prod) throw() {
+            if(0 == production_index) {
+                return;
+            }
+
+            unsigned i(prod->index_hash() & production_index_mask);
+            for(; production_index[i] != prod;
+                i = (i + 1U) & production_index_mask) {
+                if(0 == production_index[i]) {
+                    return;
+                }
+            }
+
+            for(unsigned j((i + 1U) & production_index_mask);
+                0 != production_index[j];
+                j = (j + 1U) & production_index_mask) {
+
+                const unsigned home(
+                    production_index[j]->index_hash() & production_index_mask
+                );
+
+                // move j into the hole at i if j's home slot isn't in the
+                // cyclic range (i, j]
+                if(((j - home) & production_index_mask)
+                 >= ((j - i) & production_index_mask)) {
+                    production_index[i] = production_index[j];
+                    i = j;
+                }
+            }
+
+            production_index[i] = 0;
+            --production_index_size;
+        }
+
+        void clear_production_index(void) throw() {
+            if(0 != production_index) {
+                delete [] production_index;
+            }
+            production_index = 0;
+            production_index_mask = 0;
+            production_index_size = 0;
+        }
+
+        void insert_production(Production<AlphaT> *prod) throw() {
+            unsigned i(prod->index_hash() & production_index_mask);
+            for(; 0 != production_index[i];
+                i = (i + 1U) & production_index_mask) { }
+            production_index[i] = prod;
         }
     };
 
@@ -0,0 +1,250 @@
+/*
+ * BitTree.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_BIT_TREE_HPP_
+#define FLTL_BIT_TREE_HPP_
+
+#include <vector>
+#include <stdint.h>
+
+namespace fltl { namespace helper {
+
+    /// set of unsigned integers that can find the next larger or smaller
+    /// member of some integer in O(log n) time.
+    ///
+    /// the set is a tree of bitmaps. the bottom level has one bit per
+    /// integer, and every bit of a level above tells whether the
+    /// corresponding word of the level below has any bits set.
+    class BitTree {
+    public:
+
+        enum {
+            NOT_FOUND = ~0U
+        };
+
+    private:
+
+        typedef uint64_t word_type;
+
+        enum {
+            WORD_BITS = 64U,
+
+            // 64^6 covers every unsigned integer
+            MAX_LEVELS = 6U
+        };
+
+        std::vector<word_type> levels[MAX_LEVELS];
+        unsigned num_levels;
+
+        static word_type bit(const unsigned i) throw() {
+            return static_cast<word_type>(1) << (i % WORD_BITS);
+        }
+
+        /// index of the lowest set bit of a non-zero word
+        static unsigned lowest_bit(word_type word) throw() {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+            unsigned i(0);
+            for(; 0 == (word & 1U); word >>= 1U) {
+                ++i;
+            }
+            return i;
+#endif
+        }
+
+        /// index of the highest set bit of a non-zero word
+        static unsigned highest_bit(word_type word) throw() {
+#if defined(__GNUC__) || defined(__clang__)
+            return (WORD_BITS - 1U) - static_cast<unsigned>(
+                __builtin_clzll(word)
+            );
+#else
+            unsigned i(0);
+            for(; 0 != (word >>= 1U); ) {
+                ++i;
+            }
+            return i;
+#endif
+        }
+
+        /// make room for the integers [0, max], and rebuild the upper levels
+        void grow(const unsigned max) throw() {
+            const size_t min_size(max / WORD_BITS + 1U);
+            size_t size(levels[0].size() * 2U);
+            if(size < min_size) {
+                size = min_size;
+            }
+
+            levels[0].resize(size, 0);
+
+            for(num_levels = 1U; 1U < size; ++num_levels) {
+                const std::vector<word_type> &below(levels[num_levels - 1U]);
+                std::vector<word_type> &level(levels[num_levels]);
+
+                size = (size + WORD_BITS - 1U) / WORD_BITS;
+                level.assign(size, 0);
+
+                for(size_t i(0); i < below.size(); ++i) {
+                    if(0 != below[i]) {
+                        level[i / WORD_BITS] |= bit(static_cast<unsigned>(i));
+                    }
+                }
+            }
+        }
+
+    public:
+
+        BitTree(void) throw()
+            : num_levels(0)
+        { }
+
+        bool contains(const unsigned i) const throw() {
+            const size_t word(i / WORD_BITS);
+            return word < levels[0].size() && 0 != (levels[0][word] & bit(i));
+        }
+
+        void insert(unsigned i) throw() {
+            if(i / WORD_BITS >= levels[0].size()) {
+                grow(i);
+            }
+
+            for(unsigned level(0); level < num_levels; ++level) {
+                word_type &word(levels[level][i / WORD_BITS]);
+                const bool was_empty(0 == word);
+                word |= bit(i);
+
+                if(!was_empty) {
+                    break;
+                }
+
+                i /= WORD_BITS;
+            }
+        }
+
+        void remove(unsigned i) throw() {
+            if(!contains(i)) {
+                return;
+            }
+
+            for(unsigned level(0); level < num_levels; ++level) {
+                word_type &word(levels[level][i / WORD_BITS]);
+                word &= ~bit(i);
+
+                if(0 != word) {
+                    break;
+                }
+
+                i /= WORD_BITS;
+            }
+        }
+
+        /// find the smallest member greater than i, or NOT_FOUND
+        unsigned find_next(const unsigned i) const throw() {
+            unsigned level(0);
+            unsigned pos(i);
+
+            // go up until some word has a member after pos
+            for(;; ++level) {
+                if(level >= num_levels) {
+                    return NOT_FOUND;
+                }
+
+                const size_t word(pos / WORD_BITS);
+                if(word >= levels[level].size()) {
+                    return NOT_FOUND;
+                }
+
+                const unsigned offset(pos % WORD_BITS);
+                const word_type after(
+                    (WORD_BITS - 1U) == offset
+                        ? 0
+                        : (~static_cast<word_type>(0) << (offset + 1U))
+                );
+                const word_type bits(levels[level][word] & after);
+
+                if(0 != bits) {
+                    pos = static_cast<unsigned>(word * WORD_BITS) + lowest_bit(bits);
+                    break;
+                }
+
+                pos = static_cast<unsigned>(word);
+            }
+
+            // go down to the smallest member under pos
+            for(; 0 < level; ) {
+                --level;
+                pos = pos * WORD_BITS + lowest_bit(levels[level][pos]);
+            }
+
+            return pos;
+        }
+
+        /// find the largest member smaller than i, or NOT_FOUND
+        unsigned find_prev(const unsigned i) const throw() {
+            unsigned level(0);
+            unsigned pos(i);
+
+            // go up until some word has a member before pos
+            for(;; ++level) {
+                if(level >= num_levels) {
+                    return NOT_FOUND;
+                }
+
+                const std::vector<word_type> &words(levels[level]);
+                size_t word(pos / WORD_BITS);
+                word_type before(bit(pos) - 1U);
+
+                // everything in the level is before pos
+                if(word >= words.size()) {
+                    word = words.size() - 1U;
+                    before = ~static_cast<word_type>(0);
+                }
+
+                const word_type bits(words[word] & before);
+
+                if(0 != bits) {
+                    pos = static_cast<unsigned>(word * WORD_BITS) + highest_bit(bits);
+                    break;
+                }
+
+                pos = static_cast<unsigned>(word);
+            }
+
+            // go down to the largest member under pos
+            for(; 0 < level; ) {
+                --level;
+                pos = pos * WORD_BITS + highest_bit(levels[level][pos]);
+            }
+
+            return pos;
+        }
+    };
+}}
+
+#endif /* FLTL_BIT_TREE_HPP_ */
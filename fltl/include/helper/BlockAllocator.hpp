@@ -161,6 +161,14 @@ namespace fltl { namespace helper {
             ptr->~T();
             new (ptr) T;
 
+            // the object might come from another allocator (e.g. one of
+            // another thread); we still need a block to find the offset of
+            // objects in slots
+            if(0 == block_list) {
+                block_list = new block_type(block_list);
+                free_list = &(block_list->slots[0]);
+            }
+
             const ptrdiff_t diff(
                 reinterpret_cast<char *>(&(block_list->slots[0].obj)) -
                 reinterpret_cast<char *>(&(block_list->slots[0]))
@@ -126,6 +126,53 @@ namespace fltl { namespace pattern {
         };
     };
 
+    /// find the offset of the first bound symbol (variable, terminal, or
+    /// symbol) at or after a specific offset of the pattern string. the
+    /// result is negative if there is no such symbol.
+    template <typename StringT, typename CurrT, const unsigned offset>
+    class GetBoundSymbolOffset {
+    public:
+        enum {
+            RESULT = GetBoundSymbolOffset<
+                StringT,
+                typename GetFactor<StringT,offset + 1>::type,
+                offset + 1
+            >::RESULT
+        };
+    };
+
+    template <typename StringT, const unsigned offset>
+    class GetBoundSymbolOffset<StringT,void,offset> {
+    public:
+        enum {
+            RESULT = -1
+        };
+    };
+
+    template <typename StringT, const unsigned offset>
+    class GetBoundSymbolOffset<StringT,cfg::variable_tag,offset> {
+    public:
+        enum {
+            RESULT = offset
+        };
+    };
+
+    template <typename StringT, const unsigned offset>
+    class GetBoundSymbolOffset<StringT,cfg::terminal_tag,offset> {
+    public:
+        enum {
+            RESULT = offset
+        };
+    };
+
+    template <typename StringT, const unsigned offset>
+    class GetBoundSymbolOffset<StringT,cfg::symbol_tag,offset> {
+    public:
+        enum {
+            RESULT = offset
+        };
+    };
+
     template <typename AlphaT, typename StringT, const unsigned offset, typename T0, typename T1>
     class Match;
 
@@ -0,0 +1,136 @@
+/*
+ * ThreadLocal.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_THREAD_LOCAL_STORAGE_HPP_
+#define FLTL_THREAD_LOCAL_STORAGE_HPP_
+
+#include <pthread.h>
+
+#include "fltl/include/preprocessor/THREAD_LOCAL.hpp"
+
+#include "fltl/include/trait/StaticOnly.hpp"
+
+namespace fltl { namespace helper {
+
+    /// one instance of some type for each thread.
+    ///
+    /// Note: - instances are never destroyed. when a thread exits, its
+    ///         instance is put into a pool, and is given to the next thread
+    ///         that needs one. this way, memory owned by an instance (e.g.
+    ///         the blocks of an allocator) stays valid for any objects that
+    ///         were handed to other threads.
+    template <typename T>
+    class ThreadLocal : private trait::StaticOnly {
+    private:
+
+        class Node {
+        public:
+            T value;
+            Node *next;
+
+            Node(void)
+                : value()
+                , next(0)
+            { }
+        };
+
+        /// the instance of the current thread
+        static FLTL_THREAD_LOCAL Node *instance;
+
+        /// instances of threads that have exited
+        static Node *pool;
+        static pthread_mutex_t pool_lock;
+
+        /// used to find out when a thread exits
+        static pthread_key_t exit_key;
+        static pthread_once_t exit_key_once;
+
+        static void make_exit_key(void) throw() {
+            pthread_key_create(&exit_key, &release);
+        }
+
+        /// put the instance of an exiting thread into the pool
+        static void release(void *node_) throw() {
+            Node *node(reinterpret_cast<Node *>(node_));
+
+            pthread_mutex_lock(&pool_lock);
+            node->next = pool;
+            pool = node;
+            pthread_mutex_unlock(&pool_lock);
+
+            instance = 0;
+        }
+
+        /// get an instance from the pool, or make a new one
+        static Node *acquire(void) throw() {
+            pthread_once(&exit_key_once, &make_exit_key);
+
+            pthread_mutex_lock(&pool_lock);
+            Node *node(pool);
+            if(0 != node) {
+                pool = node->next;
+            }
+            pthread_mutex_unlock(&pool_lock);
+
+            if(0 == node) {
+                node = new Node;
+            }
+
+            node->next = 0;
+            pthread_setspecific(exit_key, node);
+            return node;
+        }
+
+    public:
+
+        /// get the instance of the current thread
+        inline static T *get(void) throw() {
+            if(0 == instance) {
+                instance = acquire();
+            }
+            return &(instance->value);
+        }
+    };
+
+    template <typename T>
+    FLTL_THREAD_LOCAL typename ThreadLocal<T>::Node *ThreadLocal<T>::instance(0);
+
+    template <typename T>
+    typename ThreadLocal<T>::Node *ThreadLocal<T>::pool(0);
+
+    template <typename T>
+    pthread_mutex_t ThreadLocal<T>::pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+    template <typename T>
+    pthread_key_t ThreadLocal<T>::exit_key;
+
+    template <typename T>
+    pthread_once_t ThreadLocal<T>::exit_key_once = PTHREAD_ONCE_INIT;
+}}
+
+#endif /* FLTL_THREAD_LOCAL_STORAGE_HPP_ */
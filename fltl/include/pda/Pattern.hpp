@@ -181,6 +181,9 @@ namespace fltl { namespace pda {
 
         unsigned ref_count;
 
+        /// allocator of the PDA that searched for this pattern
+        helper::BlockAllocator<self_type> *allocator;
+
         static void hold(self_type *self) throw() {
             assert(0 != self);
             ++(self->ref_count);
@@ -189,7 +192,7 @@ namespace fltl { namespace pda {
         static void release(self_type *self) throw() {
             assert(0 != self);
             if(0 == --(self->ref_count)) {
-                PDA<AlphaT>::pattern_allocator->deallocate(self);
+                self->allocator->deallocate(self);
             }
         }
 
@@ -202,6 +205,7 @@ namespace fltl { namespace pda {
             , pop(0)
             , push(0)
             , ref_count(0)
+            , allocator(0)
         { }
     };
 
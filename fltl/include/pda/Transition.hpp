@@ -85,6 +85,9 @@ namespace fltl { namespace pda {
         /// the PDA of this production
         PDA<AlphaT> *pda;
 
+        /// allocator of the PDA that owns this transition
+        helper::BlockAllocator<self_type> *allocator;
+
         static void hold(self_type *trans) throw() {
             assert(0 != trans);
             ++(trans->ref_count);
@@ -112,7 +115,7 @@ namespace fltl { namespace pda {
                     }
                 }
 
-                PDA<AlphaT>::transition_allocator->deallocate(trans);
+                trans->allocator->deallocate(trans);
             }
         }
 
@@ -164,6 +167,7 @@ namespace fltl { namespace pda {
             , prev(0)
             , is_deleted(false)
             , pda(0)
+            , allocator(0)
         { }
 
         ~Transition(void) throw() {
@@ -31,6 +31,7 @@
 
 #include <functional>
 #include <cstring>
+#include <stdint.h>
 
 #include "fltl/include/mpl/UserOperators.hpp"
 
@@ -53,13 +54,22 @@ namespace fltl { namespace trait {
                 return;
             }
 
+            static uint32_t hash(const T &that) throw() {
+                return static_cast<uint32_t>(that) * 2654435761U;
+            }
+
+            static bool equal(const T &a, const T &b) throw() {
+                return a == b;
+            }
+
             static void unserialize(const char *, T &) throw() {
                 assert(false && "Unimplemented.");
             }
         };
     }
 
-    /// alphabet type
+    /// alphabet type. besides the types below, an alphabet provides static
+    /// copy, destroy, hash, equal, and unserialize functions.
     template <typename T>
     class Alphabet : public T {
     public:
@@ -118,6 +128,20 @@ namespace fltl { namespace trait {
             }
         }
 
+        /// FNV-1a
+        static uint32_t hash(const char *that) throw() {
+            uint32_t h(2166136261U);
+            for(; '\0' != *that; ++that) {
+                h ^= static_cast<unsigned char>(*that);
+                h *= 16777619U;
+            }
+            return h;
+        }
+
+        static bool equal(const char *a, const char *b) throw() {
+            return 0 == strcmp(a, b);
+        }
+
         static void unserialize(const char *from, const char *&to) throw() {
             to = from;
         }
@@ -26,8 +26,12 @@
  * THE SOFTWARE.
  */
 
+#include <pthread.h>
+
 #include "fltl/test/cfg/CFG.hpp"
 
+#include "grail/include/cfg/GrammarAnalyses.hpp"
+
 namespace fltl { namespace test { namespace cfg {
 
     using fltl::CFG;
@@ -508,6 +512,58 @@ namespace fltl { namespace test { namespace cfg {
         FLTL_TEST_ASSERT_FALSE(var_gen2.match_next());
     }
 
+    void test_many_variables(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        std::vector<CFG<char>::var_t> vars;
+
+        const unsigned num_vars(1000000U);
+        for(unsigned i(0); i < num_vars; ++i) {
+            vars.push_back(cfg.add_variable());
+        }
+
+        FLTL_TEST_EQUAL(cfg.num_variables(), num_vars);
+
+        // remove the first half of the variables, then add them back; their
+        // ids are reused in reverse order, each one far from any other
+        // variable with a smaller id
+        for(unsigned i(0); i < num_vars / 2U; ++i) {
+            cfg.unsafe_remove_variable(vars[i]);
+        }
+
+        FLTL_TEST_EQUAL(cfg.num_variables(), num_vars / 2U);
+
+        for(unsigned i(0); i < num_vars / 2U; ++i) {
+            cfg.add_variable();
+        }
+
+        FLTL_TEST_EQUAL(cfg.num_variables(), num_vars);
+        FLTL_TEST_EQUAL(cfg.num_variables_capacity(), num_vars + 1U);
+
+        CFG<char>::prod_t last(cfg.add_production(vars[num_vars - 1U], a));
+        CFG<char>::prod_t first(cfg.add_production(vars[0], a));
+
+        // variables and productions are generated in order of their ids
+        CFG<char>::var_t V;
+        CFG<char>::generator_t var_gen(cfg.search(~V));
+        unsigned num_seen(0);
+        bool in_order(true);
+        for(; var_gen.match_next(); ++num_seen) {
+            in_order = in_order && V == vars[num_seen];
+        }
+
+        FLTL_TEST_EQUAL(num_seen, num_vars);
+        FLTL_TEST_ASSERT_TRUE(in_order);
+
+        CFG<char>::prod_t P;
+        CFG<char>::generator_t prod_gen(cfg.search(~P));
+        FLTL_TEST_ASSERT_TRUE(prod_gen.match_next());
+        FLTL_TEST_EQUAL(P, first);
+        FLTL_TEST_ASSERT_TRUE(prod_gen.match_next());
+        FLTL_TEST_EQUAL(P, last);
+        FLTL_TEST_ASSERT_FALSE(prod_gen.match_next());
+    }
+
     void test_generate_productions(void) throw() {
         CFG<char> cfg;
         CFG<char>::prod_t P;
@@ -551,6 +607,840 @@ namespace fltl { namespace test { namespace cfg {
         FLTL_TEST_ASSERT_TRUE(p_seen[2]);
     }
 
+    void test_many_productions(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::var_t S(cfg.add_variable());
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+        CFG<char>::symbol_buffer_type builder;
+
+        // every string of a's and b's of length 10
+        for(unsigned i(0); i < 1024U; ++i) {
+            builder.clear();
+            for(unsigned j(0); j < 10U; ++j) {
+                builder << ((i >> j) & 1U ? a : b);
+            }
+            cfg.add_production(S, builder);
+        }
+
+        FLTL_TEST_EQUAL(cfg.num_productions(), 1024U);
+
+        for(unsigned i(0); i < 1024U; ++i) {
+            builder.clear();
+            for(unsigned j(0); j < 10U; ++j) {
+                builder << ((i >> j) & 1U ? a : b);
+            }
+            cfg.add_production(S, builder);
+        }
+
+        FLTL_TEST_EQUAL(cfg.num_productions(), 1024U);
+
+        // remove the productions that start with a
+        CFG<char>::prod_t P;
+        CFG<char>::generator_t gen(cfg.search(~P, S --->* a + cfg.__));
+        for(; gen.match_next(); ) {
+            cfg.remove_production(P);
+        }
+
+        FLTL_TEST_EQUAL(cfg.num_productions(), 512U);
+
+        CFG<char>::prod_t ab(cfg.add_production(S, a + b));
+        CFG<char>::prod_t ba(cfg.add_production(S, b + a));
+
+        FLTL_TEST_NOT_EQUAL(ab, ba);
+        FLTL_TEST_EQUAL(cfg.num_productions(), 514U);
+        FLTL_TEST_EQUAL(cfg.add_production(S, a + b), ab);
+        FLTL_TEST_EQUAL(cfg.num_productions(), 514U);
+    }
+
+    void test_find_terminals(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t found;
+
+        FLTL_TEST_ASSERT_TRUE(cfg.find_terminal('a', found));
+        FLTL_TEST_EQUAL(found, a);
+        FLTL_TEST_ASSERT_FALSE(cfg.find_terminal('b', found));
+        FLTL_TEST_EQUAL(found, a);
+        FLTL_TEST_ASSERT_FALSE(cfg.has_terminal('b'));
+
+        // enough terminals to grow the index a few times
+        CFG<char>::term_t terms[100];
+        for(unsigned i(0); i < 100; ++i) {
+            terms[i] = cfg.get_terminal(static_cast<char>('0' + i));
+        }
+
+        FLTL_TEST_EQUAL(cfg.num_terminals(), 100U);
+        FLTL_TEST_EQUAL(cfg.get_terminal('a'), a);
+
+        bool all_found(true);
+        for(unsigned i(0); i < 100; ++i) {
+            all_found = cfg.find_terminal(static_cast<char>('0' + i), found)
+                     && found == terms[i]
+                     && cfg.get_alpha(found) == static_cast<char>('0' + i)
+                     && all_found;
+        }
+        FLTL_TEST_ASSERT_TRUE(all_found);
+
+        CFG<const char *> named;
+        CFG<const char *>::term_t plus(named.get_terminal("+"));
+        CFG<const char *>::term_t plus_plus(named.get_terminal("++"));
+        CFG<const char *>::term_t named_found;
+        char buffer[] = {'+', '+', '\0'};
+
+        FLTL_TEST_NOT_EQUAL(plus, plus_plus);
+        FLTL_TEST_ASSERT_TRUE(named.find_terminal(&(buffer[0]), named_found));
+        FLTL_TEST_EQUAL(named_found, plus_plus);
+        FLTL_TEST_ASSERT_FALSE(named.find_terminal("+++", named_found));
+    }
+
+    /// build, search, and change a grammar; the result is a summary of
+    /// what was found
+    static void *build_grammar(void *result_) throw() {
+        unsigned *result(reinterpret_cast<unsigned *>(result_));
+        *result = 0;
+
+        for(unsigned round(0); round < 20U; ++round) {
+            CFG<char> cfg;
+            CFG<char>::term_t a(cfg.get_terminal('a'));
+            CFG<char>::term_t b(cfg.get_terminal('b'));
+            std::vector<CFG<char>::var_t> vars;
+
+            for(unsigned i(0); i < 100U; ++i) {
+                vars.push_back(cfg.add_variable());
+            }
+
+            for(unsigned i(0); i < 100U; ++i) {
+                CFG<char>::var_t next(vars[(i + 1U) % 100U]);
+                cfg.add_production(vars[i], a + next + b);
+                cfg.add_production(vars[i], b + next);
+                cfg.add_production(vars[i], next + next + a + vars[i]);
+                cfg.add_production(vars[i], cfg.epsilon());
+            }
+
+            CFG<char>::prod_t P;
+            CFG<char>::var_t V;
+            CFG<char>::generator_t starting_with_b(
+                cfg.search(~P, (~V) --->* b + cfg.__)
+            );
+
+            for(; starting_with_b.match_next(); ) {
+                cfg.remove_production(P);
+                ++*result;
+            }
+
+            CFG<char>::generator_t prods(cfg.search(~P));
+            for(; prods.match_next(); ) {
+                *result += P.symbols().length();
+            }
+
+            *result += cfg.num_productions();
+        }
+
+        return 0;
+    }
+
+    void test_concurrent_grammars(void) throw() {
+        const unsigned num_threads(4U);
+        unsigned expected(0);
+        unsigned results[num_threads];
+        pthread_t threads[num_threads];
+
+        build_grammar(&expected);
+
+        for(unsigned i(0); i < num_threads; ++i) {
+            pthread_create(&(threads[i]), 0, &build_grammar, &(results[i]));
+        }
+
+        for(unsigned i(0); i < num_threads; ++i) {
+            pthread_join(threads[i], 0);
+        }
+
+        FLTL_TEST_EQUAL(expected, 20U * (100U + 300U + 700U));
+        for(unsigned i(0); i < num_threads; ++i) {
+            FLTL_TEST_EQUAL(results[i], expected);
+        }
+    }
+
+    void test_freeze(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::var_t S(cfg.add_variable());
+        CFG<char>::var_t A(cfg.add_variable());
+        CFG<char>::var_t B(cfg.add_variable());
+        CFG<char>::var_t C(cfg.add_variable());
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+
+        cfg.add_production(S, A + a + C);
+        cfg.add_production(A, cfg.epsilon());
+        CFG<char>::prod_t removed(cfg.add_production(A, b));
+        cfg.add_production(A, A + b);
+        cfg.add_production(B, a);
+        cfg.add_production(C, b + S);
+
+        // leave a gap in the variable numbers, and a removed production
+        cfg.unsafe_remove_variable(B);
+        cfg.remove_production(removed);
+        cfg.set_start_variable(S);
+
+        CFG<char>::frozen_grammar_type grammar;
+        cfg.freeze(grammar);
+
+        FLTL_TEST_EQUAL(grammar.num_variables(), 3U);
+        FLTL_TEST_EQUAL(grammar.num_variables_capacity(), 5U);
+        FLTL_TEST_EQUAL(grammar.num_productions(), 4U);
+        FLTL_TEST_EQUAL(grammar.num_terminals(), 2U);
+        FLTL_TEST_ASSERT_TRUE(grammar.has_start_variable());
+        FLTL_TEST_EQUAL(grammar.start_variable(), S.number());
+
+        FLTL_TEST_EQUAL(grammar.variable(0), S.number());
+        FLTL_TEST_EQUAL(grammar.variable(1), A.number());
+        FLTL_TEST_EQUAL(grammar.variable(2), C.number());
+
+        // no productions for the removed variable
+        FLTL_TEST_EQUAL(
+            grammar.productions_begin(B.number()),
+            grammar.productions_end(B.number())
+        );
+
+        // S --> A a C
+        unsigned prod(grammar.productions_begin(S.number()));
+        FLTL_TEST_EQUAL(grammar.productions_end(S.number()), prod + 1U);
+        FLTL_TEST_EQUAL(grammar.production_variable(prod), S.number());
+        FLTL_TEST_EQUAL(grammar.length(prod), 3U);
+        FLTL_TEST_ASSERT_TRUE(grammar.symbols_begin(prod)[0] == A);
+        FLTL_TEST_ASSERT_TRUE(grammar.symbols_begin(prod)[1] == a);
+        FLTL_TEST_ASSERT_TRUE(grammar.symbols_begin(prod)[2] == C);
+        FLTL_TEST_ASSERT_TRUE(grammar.symbols_begin(prod) + 3 == grammar.symbols_end(prod));
+
+        // A --> epsilon | A b
+        prod = grammar.productions_begin(A.number());
+        FLTL_TEST_EQUAL(grammar.productions_end(A.number()), prod + 2U);
+        FLTL_TEST_EQUAL(grammar.length(prod), 0U);
+        FLTL_TEST_EQUAL(grammar.length(prod + 1U), 2U);
+        FLTL_TEST_EQUAL(grammar.production_variable(prod + 1U), A.number());
+        FLTL_TEST_ASSERT_TRUE(grammar.symbols_begin(prod + 1U)[0] == A);
+        FLTL_TEST_ASSERT_TRUE(grammar.symbols_begin(prod + 1U)[1] == b);
+
+        // C --> b S
+        prod = grammar.productions_begin(C.number());
+        FLTL_TEST_EQUAL(grammar.productions_end(C.number()), prod + 1U);
+        FLTL_TEST_EQUAL(grammar.productions_end(C.number()), grammar.num_productions());
+        FLTL_TEST_ASSERT_TRUE(grammar.symbols_begin(prod)[1] == S);
+
+        // the snapshot doesn't follow the CFG
+        cfg.add_production(C, a);
+        FLTL_TEST_EQUAL(grammar.num_productions(), 4U);
+
+        // freezing again replaces the snapshot
+        cfg.freeze(grammar);
+        FLTL_TEST_EQUAL(grammar.num_productions(), 5U);
+        FLTL_TEST_EQUAL(grammar.productions_end(C.number()), 5U);
+
+        CFG<char> empty;
+        empty.freeze(grammar);
+        FLTL_TEST_EQUAL(grammar.num_variables(), 0U);
+        FLTL_TEST_EQUAL(grammar.num_productions(), 0U);
+        FLTL_TEST_ASSERT_FALSE(grammar.has_start_variable());
+    }
+
+    void test_short_strings(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::var_t S(cfg.add_variable());
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+
+        // on either side of the longest string stored inline
+        CFG<char>::sym_str_t short_str(a + S + b + a);
+        CFG<char>::sym_str_t long_str(short_str + b);
+
+        FLTL_TEST_EQUAL(short_str.length(), 4U);
+        FLTL_TEST_EQUAL(long_str.length(), 5U);
+        FLTL_TEST_EQUAL(long_str.substring(0, 4), short_str);
+        FLTL_TEST_EQUAL(long_str.substring(1), S + b + a + b);
+        FLTL_TEST_NOT_EQUAL(long_str.substring(1), short_str);
+
+        // copies don't change when the original does
+        CFG<char>::sym_str_t copy(short_str);
+        CFG<char>::sym_str_t assigned;
+        assigned = short_str;
+        short_str = b;
+
+        FLTL_TEST_EQUAL(copy, a + S + b + a);
+        FLTL_TEST_EQUAL(assigned, copy);
+        FLTL_TEST_EQUAL(short_str.length(), 1U);
+        FLTL_TEST_ASSERT_TRUE(short_str.at(0) == b);
+
+        assigned = assigned;
+        FLTL_TEST_EQUAL(assigned, copy);
+
+        // long strings can become short ones, and back
+        long_str = long_str.substring(2, 2);
+        FLTL_TEST_EQUAL(long_str, b + a);
+        long_str = long_str + long_str + long_str;
+        FLTL_TEST_EQUAL(long_str.length(), 6U);
+        FLTL_TEST_EQUAL(long_str.substring(4), b + a);
+
+        // short strings and productions
+        CFG<char>::prod_t P(cfg.add_production(S, copy));
+        FLTL_TEST_EQUAL(P.symbols(), copy);
+        FLTL_TEST_EQUAL(cfg.add_production(S, a + S + b + a), P);
+
+        copy.clear();
+        FLTL_TEST_EQUAL(copy, cfg.epsilon());
+        FLTL_TEST_EQUAL(P.symbols(), assigned);
+    }
+
+    void test_add_remove_search(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::var_t S(cfg.add_variable());
+        CFG<char>::var_t A(cfg.add_variable());
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+
+        CFG<char>::prod_t P;
+        CFG<char>::var_t V;
+        CFG<char>::generator_t using_a(
+            cfg.search(~P, (~V) --->* cfg.__ + a + cfg.__)
+        );
+        CFG<char>::generator_t prods(cfg.search(~P));
+
+        cfg.add_production(S, A + a);
+
+        CFG<char>::prod_t Aa(cfg.add_production(A, a));
+        CFG<char>::prod_t Ab(cfg.add_production(A, b));
+
+        CFG<char>::prod_t transient(cfg.add_production(S, a + a + b));
+        cfg.remove_production(transient);
+
+        cfg.remove_production(Ab);
+        cfg.add_production(S, b + a);
+
+        FLTL_TEST_EQUAL(cfg.num_productions(), 3U);
+
+        // searches see the new productions, including ones added to the
+        // current variable while searching
+        unsigned num_using_a(0);
+        for(; using_a.match_next(); ) {
+            ++num_using_a;
+            if(P == Aa) {
+                cfg.add_production(A, a + A);
+            }
+        }
+
+        FLTL_TEST_EQUAL(num_using_a, 4U);
+
+        using_a.rewind();
+        num_using_a = 0;
+        for(; using_a.match_next(); ) {
+            ++num_using_a;
+        }
+        FLTL_TEST_EQUAL(num_using_a, 4U);
+
+        // removing every production of the first variable
+        for(CFG<char>::generator_t S_prods(cfg.search(~P, S --->* cfg.__));
+            S_prods.match_next(); ) {
+            cfg.remove_production(P);
+        }
+
+        unsigned num_prods(0);
+        for(; prods.match_next(); ) {
+            FLTL_TEST_ASSERT_TRUE(P.variable() == A);
+            ++num_prods;
+        }
+        FLTL_TEST_EQUAL(num_prods, 2U);
+        FLTL_TEST_EQUAL(cfg.num_productions(), 2U);
+
+        // and adding one back
+        cfg.add_production(S, b);
+        prods.rewind();
+        FLTL_TEST_ASSERT_TRUE(prods.match_next());
+        FLTL_TEST_ASSERT_TRUE(P.variable() == S);
+    }
+
+    void test_compact(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::var_t S(cfg.get_variable("S"));
+        CFG<char>::var_t A(cfg.get_variable("A"));
+        CFG<char>::var_t B(cfg.get_variable("B"));
+        CFG<char>::var_t C(cfg.get_variable("C"));
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+
+        cfg.add_production(S, A + C);
+        cfg.add_production(S, B + a);
+        cfg.add_production(S, C);
+        cfg.add_production(A, a);
+        cfg.add_production(B, b);
+        cfg.add_production(C, C + b);
+        cfg.add_production(C, b);
+
+        // a deleted production that is still referenced
+        CFG<char>::prod_t held(cfg.add_production(C, a + C));
+        cfg.remove_production(held);
+
+        cfg.remove_variable(B);
+        cfg.remove_variable(A);
+
+        std::vector<unsigned> remap;
+        cfg.compact(remap);
+
+        FLTL_TEST_EQUAL(remap.size(), 5U);
+        FLTL_TEST_EQUAL(remap[S.number()], 1U);
+        FLTL_TEST_EQUAL(remap[A.number()], 0U);
+        FLTL_TEST_EQUAL(remap[B.number()], 0U);
+        FLTL_TEST_EQUAL(remap[C.number()], 2U);
+        FLTL_TEST_EQUAL(cfg.num_variables(), 2U);
+        FLTL_TEST_EQUAL(cfg.num_variables_capacity(), 3U);
+        FLTL_TEST_EQUAL(cfg.num_productions(), 3U);
+
+        S = cfg.get_variable("S");
+        C = cfg.get_variable("C");
+        FLTL_TEST_EQUAL(S.number(), 1U);
+        FLTL_TEST_EQUAL(C.number(), 2U);
+        FLTL_TEST_ASSERT_TRUE(cfg.get_start_variable() == S);
+
+        // adding an existing production finds it by its renumbered symbols
+        CFG<char>::prod_t P(cfg.add_production(C, C + b));
+        FLTL_TEST_EQUAL(cfg.num_productions(), 3U);
+        FLTL_TEST_ASSERT_TRUE(P.variable() == C);
+
+        CFG<char>::var_t V;
+        unsigned num_prods(0);
+        for(CFG<char>::generator_t prods(cfg.search(~P)); prods.match_next(); ) {
+            FLTL_TEST_ASSERT_TRUE(P != held);
+            ++num_prods;
+        }
+        FLTL_TEST_EQUAL(num_prods, 3U);
+
+        unsigned num_using_C(0);
+        for(CFG<char>::generator_t using_C(
+                cfg.search(~P, (~V) --->* cfg.__ + C + cfg.__));
+            using_C.match_next(); ) {
+            ++num_using_C;
+        }
+        FLTL_TEST_EQUAL(num_using_C, 2U);
+
+        // new variables go after the compacted ones
+        CFG<char>::var_t D(cfg.add_variable());
+        FLTL_TEST_EQUAL(D.number(), 3U);
+        FLTL_TEST_ASSERT_TRUE(cfg.get_variable("A") != S);
+        cfg.add_production(D, S + C);
+        FLTL_TEST_EQUAL(cfg.num_productions(), 4U);
+    }
+
+    void test_modification_epoch(void) throw() {
+        CFG<char> cfg;
+        uint64_t epoch(cfg.modification_epoch());
+
+        CFG<char>::var_t S(cfg.get_variable("S"));
+        FLTL_TEST_ASSERT_TRUE(epoch != cfg.modification_epoch());
+        epoch = cfg.modification_epoch();
+
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        FLTL_TEST_ASSERT_TRUE(epoch != cfg.modification_epoch());
+        epoch = cfg.modification_epoch();
+
+        CFG<char>::prod_t P(cfg.add_production(S, a + S));
+        FLTL_TEST_ASSERT_TRUE(epoch != cfg.modification_epoch());
+        epoch = cfg.modification_epoch();
+
+        // looking things up and adding duplicates doesn't change anything
+        cfg.get_variable("S");
+        cfg.get_terminal('a');
+        cfg.add_production(S, a + S);
+
+        CFG<char>::prod_t Q;
+        for(CFG<char>::generator_t prods(cfg.search(~Q)); prods.match_next(); ) {
+            // nothing
+        }
+        FLTL_TEST_EQUAL(epoch, cfg.modification_epoch());
+
+        cfg.remove_production(P);
+        FLTL_TEST_ASSERT_TRUE(epoch != cfg.modification_epoch());
+        epoch = cfg.modification_epoch();
+
+        // a removed production coming back to life is a change
+        cfg.add_production(S, a + S);
+        FLTL_TEST_ASSERT_TRUE(epoch != cfg.modification_epoch());
+        epoch = cfg.modification_epoch();
+
+        CFG<char>::var_t T(cfg.add_variable());
+        FLTL_TEST_ASSERT_TRUE(epoch != cfg.modification_epoch());
+        epoch = cfg.modification_epoch();
+
+        // naming a variable doesn't change the grammar
+        cfg.get_name(T);
+        FLTL_TEST_EQUAL(epoch, cfg.modification_epoch());
+
+        cfg.set_start_variable(T);
+        FLTL_TEST_ASSERT_TRUE(epoch != cfg.modification_epoch());
+        epoch = cfg.modification_epoch();
+
+        cfg.compact();
+        FLTL_TEST_ASSERT_TRUE(epoch != cfg.modification_epoch());
+    }
+
+    /// analysis cache that counts what it is told about
+    class CountingCache : public fltl::cfg::AnalysisCache<char> {
+    public:
+
+        unsigned num_added;
+        unsigned num_removed;
+        bool *is_deleted;
+
+        CountingCache(bool *is_deleted_) throw()
+            : fltl::cfg::AnalysisCache<char>()
+            , num_added(0)
+            , num_removed(0)
+            , is_deleted(is_deleted_)
+        { }
+
+        virtual ~CountingCache(void) throw() {
+            *is_deleted = true;
+        }
+
+        virtual void added_production(const CFG<char>::prod_t &) throw() {
+            ++num_added;
+        }
+
+        virtual void removed_production(const CFG<char>::prod_t &) throw() {
+            ++num_removed;
+        }
+    };
+
+    void test_analysis_cache(void) throw() {
+        bool first_deleted(false);
+        bool second_deleted(false);
+
+        {
+            CFG<char> cfg;
+            CountingCache *first(new CountingCache(&first_deleted));
+            CountingCache *second(new CountingCache(&second_deleted));
+
+            cfg.set_analysis_cache(first);
+            FLTL_TEST_ASSERT_TRUE(cfg.get_analysis_cache() == first);
+
+            CFG<char>::var_t S(cfg.get_variable("S"));
+            CFG<char>::term_t a(cfg.get_terminal('a'));
+
+            CFG<char>::prod_t P(cfg.add_production(S, a + S));
+            cfg.add_production(S, a + S);
+            cfg.add_production(S, cfg.epsilon());
+            FLTL_TEST_EQUAL(first->num_added, 2U);
+
+            cfg.remove_production(P);
+            FLTL_TEST_EQUAL(first->num_removed, 1U);
+
+            // a removed production coming back is an addition
+            cfg.add_production(S, a + S);
+            FLTL_TEST_EQUAL(first->num_added, 3U);
+
+            // replacing the cache deletes the old one
+            cfg.set_analysis_cache(second);
+            FLTL_TEST_ASSERT_TRUE(first_deleted);
+            FLTL_TEST_ASSERT_FALSE(second_deleted);
+        }
+
+        // the grammar deletes its cache
+        FLTL_TEST_ASSERT_TRUE(second_deleted);
+    }
+
+    /// do two sets of terminals have the same members?
+    static bool same_terminals(
+        const grail::cfg::TerminalSet &a,
+        const grail::cfg::TerminalSet &b
+    ) throw() {
+        unsigned i(a.find_first());
+        unsigned j(b.find_first());
+        for(; i == j && i != grail::cfg::TerminalSet::NOT_FOUND; ) {
+            i = a.find_next(i);
+            j = b.find_next(j);
+        }
+        return i == j;
+    }
+
+    /// are the NULL, FIRST, and FOLLOW sets kept with a grammar the same
+    /// as those computed from scratch?
+    static bool analyses_agree(CFG<char> &cfg) throw() {
+        const std::vector<bool> &nullable(grail::cfg::nullable(cfg));
+        const std::vector<grail::cfg::TerminalSet> &first(
+            grail::cfg::first(cfg)
+        );
+        const std::vector<grail::cfg::TerminalSet> &follow(
+            grail::cfg::follow(cfg)
+        );
+
+        fltl::cfg::FrozenGrammar<char> frozen;
+        std::vector<bool> fresh_nullable;
+        std::vector<grail::cfg::TerminalSet> fresh_first;
+        std::vector<grail::cfg::TerminalSet> fresh_follow;
+
+        cfg.freeze(frozen);
+        grail::cfg::compute_null_set(frozen, fresh_nullable);
+        grail::cfg::compute_first_terminals(frozen, fresh_nullable, fresh_first);
+        grail::cfg::compute_follow_set(
+            frozen, fresh_nullable, fresh_first, fresh_follow
+        );
+
+        CFG<char>::var_t V;
+        CFG<char>::generator_t vars(cfg.search(~V));
+        for(; vars.match_next(); ) {
+            const unsigned var(V.number());
+            if(nullable[var] != fresh_nullable[var]
+            || !same_terminals(first[var], fresh_first[var])
+            || !same_terminals(follow[var], fresh_follow[var])) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void test_incremental_analyses(void) throw() {
+        CFG<char> cfg;
+
+        CFG<char>::var_t S(cfg.get_variable("S"));
+        CFG<char>::var_t A(cfg.get_variable("A"));
+        CFG<char>::var_t B(cfg.get_variable("B"));
+        CFG<char>::var_t C(cfg.get_variable("C"));
+        CFG<char>::var_t D(cfg.get_variable("D"));
+        CFG<char>::var_t E(cfg.get_variable("E"));
+        CFG<char>::var_t F(cfg.get_variable("F"));
+
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+        CFG<char>::term_t c(cfg.get_terminal('c'));
+        CFG<char>::term_t d(cfg.get_terminal('d'));
+        CFG<char>::term_t e(cfg.get_terminal('e'));
+
+        cfg.set_start_variable(S);
+
+        // A, B, and C are one cycle of dependencies, and D, E, F is a
+        // chain of variables that are only nullable because of F
+        cfg.add_production(S, A + D + e);
+        cfg.add_production(S, D);
+        cfg.add_production(A, B + a);
+        cfg.add_production(A, c);
+        cfg.add_production(B, C + b);
+        CFG<char>::prod_t B_A(cfg.add_production(B, A + d));
+        cfg.add_production(C, A + C);
+        cfg.add_production(C, cfg.epsilon());
+        cfg.add_production(D, E);
+        cfg.add_production(D, a + D);
+        cfg.add_production(E, F);
+        CFG<char>::prod_t F_eps(cfg.add_production(F, cfg.epsilon()));
+        cfg.add_production(F, d);
+
+        // a longer nullable chain, more than a quarter of the variables
+        // long, followed by variables that nothing uses
+        enum {
+            CHAIN_LENGTH = 10,
+            NUM_UNUSED = 12
+        };
+
+        CFG<char>::var_t Y[CHAIN_LENGTH];
+        for(unsigned i(0); i < CHAIN_LENGTH; ++i) {
+            Y[i] = cfg.add_variable();
+        }
+        cfg.add_production(S, Y[0] + c);
+        for(unsigned i(0); i + 1U < CHAIN_LENGTH; ++i) {
+            cfg.add_production(Y[i], Y[i + 1U] + e);
+            cfg.add_production(Y[i], Y[i + 1U]);
+        }
+        CFG<char>::prod_t Y_eps(
+            cfg.add_production(Y[CHAIN_LENGTH - 1], cfg.epsilon())
+        );
+
+        for(unsigned i(0); i < NUM_UNUSED; ++i) {
+            CFG<char>::var_t U(cfg.add_variable());
+            cfg.add_production(U, U + a);
+            cfg.add_production(U, b);
+        }
+
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+
+        // grow the cycle
+        cfg.add_production(C, c + C);
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+
+        // shrink the cycle
+        cfg.remove_production(B_A);
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+
+        // F, E, D, and S stop being nullable, which shrinks FIRST and
+        // FOLLOW sets
+        cfg.remove_production(F_eps);
+        FLTL_TEST_ASSERT_FALSE(grail::cfg::nullable(cfg)[D.number()]);
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+
+        F_eps = cfg.add_production(F, cfg.epsilon());
+        FLTL_TEST_ASSERT_TRUE(grail::cfg::nullable(cfg)[D.number()]);
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+
+        // several changes at once, some of which undo others
+        cfg.remove_production(F_eps);
+        B_A = cfg.add_production(B, A + d);
+        cfg.add_production(E, b + F);
+        F_eps = cfg.add_production(F, cfg.epsilon());
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+
+        // too many changes to remember, so the sets are computed again
+        for(unsigned i(0); i < 600U; ++i) {
+            cfg.remove_production(B_A);
+            B_A = cfg.add_production(B, A + d);
+        }
+        cfg.remove_production(B_A);
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+
+        // too many variables stop being nullable to derive them again, so
+        // the sets are computed again
+        cfg.remove_production(Y_eps);
+        FLTL_TEST_ASSERT_FALSE(grail::cfg::nullable(cfg)[Y[0].number()]);
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+
+        // and are brought up to date after that
+        cfg.remove_production(F_eps);
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+
+        Y_eps = cfg.add_production(Y[CHAIN_LENGTH - 1], cfg.epsilon());
+        FLTL_TEST_ASSERT_TRUE(analyses_agree(cfg));
+    }
+
+    void test_symbol_occurrences(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::var_t S(cfg.add_variable());
+        CFG<char>::var_t A(cfg.add_variable());
+        CFG<char>::var_t B(cfg.add_variable());
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+
+        CFG<char>::prod_t p[6];
+        p[0] = cfg.add_production(S, A + a + A);
+        p[1] = cfg.add_production(S, b);
+        p[2] = cfg.add_production(A, a);
+        p[3] = cfg.add_production(A, A + b);
+        p[4] = cfg.add_production(B, S + A);
+        p[5] = cfg.add_production(B, a);
+
+        CFG<char>::prod_t P;
+        CFG<char>::var_t V;
+        CFG<char>::generator_t using_A(
+            cfg.search(~P, (~V) --->* cfg.__ + A + cfg.__)
+        );
+        CFG<char>::generator_t using_a(
+            cfg.search(~P, (~V) --->* cfg.__ + a + cfg.__)
+        );
+
+        unsigned seen[6] = {0, 0, 0, 0, 0, 0};
+        for(; using_A.match_next(); ) {
+            for(unsigned i(0); i < 6; ++i) {
+                seen[i] += P == p[i] ? 1U : 0U;
+            }
+        }
+
+        FLTL_TEST_EQUAL(seen[0], 1U);
+        FLTL_TEST_EQUAL(seen[1], 0U);
+        FLTL_TEST_EQUAL(seen[2], 0U);
+        FLTL_TEST_EQUAL(seen[3], 1U);
+        FLTL_TEST_EQUAL(seen[4], 1U);
+        FLTL_TEST_EQUAL(seen[5], 0U);
+
+        // remove the productions while going through them
+        unsigned num_using_a(0);
+        for(; using_a.match_next(); ) {
+            cfg.remove_production(P);
+            ++num_using_a;
+        }
+
+        FLTL_TEST_EQUAL(num_using_a, 3U);
+        FLTL_TEST_EQUAL(cfg.num_productions(), 3U);
+        FLTL_TEST_ASSERT_FALSE(using_a.match_next());
+        using_a.rewind();
+        FLTL_TEST_ASSERT_FALSE(using_a.match_next());
+
+        // removed productions come back
+        cfg.add_production(A, a);
+        using_a.rewind();
+        FLTL_TEST_ASSERT_TRUE(using_a.match_next());
+        FLTL_TEST_EQUAL(P, p[2]);
+        FLTL_TEST_ASSERT_FALSE(using_a.match_next());
+
+        // the symbol is also bound by the pattern
+        CFG<char>::prod_t loop(cfg.add_production(B, B));
+        CFG<char>::generator_t loops(cfg.search(~P, (~V) --->* V));
+        FLTL_TEST_ASSERT_TRUE(loops.match_next());
+        FLTL_TEST_EQUAL(P, loop);
+        FLTL_TEST_EQUAL(V, B);
+        FLTL_TEST_ASSERT_FALSE(loops.match_next());
+
+        // removing A removes A --> A b and B --> S A, but not S --> b
+        cfg.remove_variable(A);
+        FLTL_TEST_EQUAL(cfg.num_productions(), 2U);
+        FLTL_TEST_EQUAL(cfg.num_productions(S), 1U);
+        FLTL_TEST_EQUAL(cfg.num_productions(B), 1U);
+    }
+
+    void test_generate_added_productions(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::var_t A(cfg.add_variable());
+        CFG<char>::var_t B(cfg.add_variable());
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+        CFG<char>::term_t c(cfg.get_terminal('c'));
+
+        cfg.add_production(A, a + a);
+        cfg.add_production(A, a + c);
+        cfg.add_production(B, b + b);
+
+        CFG<char>::prod_t P;
+        CFG<char>::generator_t pairs(
+            cfg.search(~P, cfg._ --->* cfg._ + cfg._)
+        );
+
+        // productions are appended to the end of their variable, and a
+        // generator moves its cursor to the next production before giving
+        // back the current one. it sees the productions added after its
+        // cursor, but not those added to a variable that it has passed,
+        // and not those added to the variable of the current production
+        // when the current production was the last one of that variable.
+        unsigned num_pairs(0);
+        bool seen_A_ab(false);
+        bool seen_B_ba(false);
+        bool seen_A_cc(false);
+        bool seen_B_ca(false);
+        for(; pairs.match_next(); ) {
+            ++num_pairs;
+            if(P.symbols() == a + a) {
+                cfg.add_production(A, a + b);
+                cfg.add_production(B, b + a);
+            } else if(P.symbols() == b + b) {
+                cfg.add_production(A, c + c);
+            } else if(P.symbols() == b + a) {
+                cfg.add_production(B, c + a);
+            }
+
+            seen_A_ab = seen_A_ab || P.symbols() == a + b;
+            seen_B_ba = seen_B_ba || P.symbols() == b + a;
+            seen_A_cc = seen_A_cc || P.symbols() == c + c;
+            seen_B_ca = seen_B_ca || P.symbols() == c + a;
+        }
+
+        FLTL_TEST_EQUAL(num_pairs, 5U);
+        FLTL_TEST_ASSERT_TRUE(seen_A_ab);
+        FLTL_TEST_ASSERT_TRUE(seen_B_ba);
+        FLTL_TEST_ASSERT_FALSE(seen_A_cc);
+        FLTL_TEST_ASSERT_FALSE(seen_B_ca);
+
+        // all of them are seen after rewinding
+        num_pairs = 0;
+        for(pairs.rewind(); pairs.match_next(); ) {
+            ++num_pairs;
+        }
+        FLTL_TEST_EQUAL(num_pairs, 7U);
+        FLTL_TEST_EQUAL(cfg.num_productions(), 7U);
+    }
+
     void test_generate_search(void) throw() {
 
     }
@@ -47,6 +47,10 @@ namespace fltl { namespace test { namespace cfg {
         "Test that productions are correctly added to the grammar and that duplicates are ignored."
     );
 
+    FLTL_TEST_CATEGORY(test_many_productions,
+        "Test that duplicates are found among many productions of one variable, including removed productions."
+    );
+
     FLTL_TEST_CATEGORY(test_remove_productions,
         "Test that productions are correctly removed from the grammar."
     );
@@ -55,10 +59,18 @@ namespace fltl { namespace test { namespace cfg {
         "Test that symbols and symbol strings can be extracted from productions and symbol strings."
     );
 
+    FLTL_TEST_CATEGORY(test_find_terminals,
+        "Test that terminals are found by their alphabet values, and that unknown values are not."
+    );
+
     FLTL_TEST_CATEGORY(test_pattern_match,
         "Test the pattern-matching feature for productions."
     );
 
+    FLTL_TEST_CATEGORY(test_symbol_occurrences,
+        "Test that patterns with bound symbols find every production using those symbols exactly once."
+    );
+
     FLTL_TEST_CATEGORY(test_generate_terminals,
         "Test that generators give the right results for terminals."
     );
@@ -67,6 +79,46 @@ namespace fltl { namespace test { namespace cfg {
         "Test that generators give the right results for variables."
     );
 
+    FLTL_TEST_CATEGORY(test_many_variables,
+        "Test that a million variables stay ordered when their ids are removed and reused."
+    );
+
+    FLTL_TEST_CATEGORY(test_concurrent_grammars,
+        "Test that independent grammars can be built and searched on several threads at once."
+    );
+
+    FLTL_TEST_CATEGORY(test_freeze,
+        "Test that a frozen grammar has the productions and symbols of its CFG."
+    );
+
+    FLTL_TEST_CATEGORY(test_short_strings,
+        "Test that short symbol strings behave like long ones when copied, assigned, and sliced."
+    );
+
+    FLTL_TEST_CATEGORY(test_add_remove_search,
+        "Test that searches see productions as they are added and removed, including all of those of the first variable."
+    );
+
+    FLTL_TEST_CATEGORY(test_compact,
+        "Test that compacting a grammar renumbers its variables and keeps its productions."
+    );
+
+    FLTL_TEST_CATEGORY(test_modification_epoch,
+        "Test that the modification epoch of a grammar changes when, and only when, the grammar changes."
+    );
+
+    FLTL_TEST_CATEGORY(test_analysis_cache,
+        "Test that a grammar tells its analysis cache about added and removed productions, and deletes it."
+    );
+
+    FLTL_TEST_CATEGORY(test_incremental_analyses,
+        "Test that the NULL, FIRST, and FOLLOW sets brought up to date after adding and removing productions are those computed from scratch."
+    );
+
+    FLTL_TEST_CATEGORY(test_generate_added_productions,
+        "Test which productions added during a search that search goes on to find."
+    );
+
     FLTL_TEST_CATEGORY(test_generate_productions,
         "Test that generators give the right results for productions."
     );
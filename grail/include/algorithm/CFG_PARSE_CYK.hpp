@@ -0,0 +1,551 @@
+/*
+ * CFG_PARSE_CYK.hpp
+ *
+ *  Created on: May 25, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CFG_PARSE_CYK_HPP_
+#define FLTL_CFG_PARSE_CYK_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#include "fltl/include/CFG.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+#include "grail/include/cfg/DottedRuleTable.hpp"
+#include "grail/include/cfg/ParseForest.hpp"
+
+#include "grail/include/io/verbose.hpp"
+
+namespace grail { namespace algorithm {
+
+    /// recognize an input using the Cocke-Younger-Kasami algorithm, and
+    /// optionally build its parse forest. the grammar must be in Chomsky
+    /// normal form (see CFG_TO_CNF). each cell of the chart is a bitset of
+    /// variables, and binary productions are applied a machine word at a
+    /// time using one precomputed mask of variables A for each pair of
+    /// variables (B, C) such that A --> B C.
+    ///
+    /// the parser never changes the grammar, and keeps its chart between
+    /// inputs.
+    template <typename AlphaT>
+    class CFG_PARSE_CYK : private fltl::trait::Uncopyable {
+    public:
+
+        // take off the templates!
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef cfg::DottedRuleTable<AlphaT> rule_table_type;
+        typedef typename rule_table_type::dotted_rule_type dotted_rule_type;
+        typedef cfg::ParseForest<AlphaT> forest_type;
+        typedef typename forest_type::node_type forest_node_type;
+
+        typedef uint64_t word_type;
+
+    private:
+
+        enum {
+            WORD_BITS = 64U,
+            NO_MASK = ~0U
+        };
+
+        /// all variables A such that A --> B C, for one pair (B, C)
+        class pair_rule_type {
+        public:
+
+            // C
+            unsigned right;
+
+            // offset of the mask of each A in masks
+            unsigned mask;
+
+            pair_rule_type(const unsigned right_, const unsigned mask_)
+                : right(right_)
+                , mask(mask_)
+            { }
+        };
+
+        /// the grammar being parsed, which is never changed by the parser
+        const CFG &cfg;
+
+        /// dotted rules of the grammar; used to build the parse forest
+        rule_table_type rules;
+
+        /// is the grammar in Chomsky normal form?
+        bool is_cnf;
+
+        /// does the start variable derive epsilon?
+        bool accepts_empty;
+
+        unsigned start_var;
+
+        /// number of words in each bitset of variables
+        unsigned num_words;
+
+        /// all masks of variables, num_words words each
+        std::vector<word_type> masks;
+
+        /// the pair rules (B, C), grouped by B. the pairs of B are stored
+        /// in pairs[pairs_begin[B] ... pairs_begin[B + 1])
+        std::vector<pair_rule_type> pairs;
+        std::vector<unsigned> pairs_begin;
+
+        /// all variables B that are the first variable of some pair rule
+        unsigned has_pairs_mask;
+
+        /// for each variable B with pair rules, the mask of all variables C
+        /// such that some variable derives B C
+        std::vector<unsigned> right_mask;
+
+        /// for each terminal, the mask of variables A such that A --> a
+        std::vector<unsigned> terminal_mask;
+
+        /// the mask of all variables that derive a variable terminal
+        unsigned variable_terminal_mask;
+
+        /// the chart; the cell for the tokens [i, j) is at
+        /// cell(i, j) * num_words
+        std::vector<word_type> chart;
+        unsigned num_tokens;
+
+        /// the terminal of each token of the input; tokens that aren't
+        /// terminals of the grammar are stored as 0
+        std::vector<unsigned> tokens;
+
+        /// make a new, empty mask and return its offset
+        unsigned add_mask(void) throw() {
+            const unsigned offset(static_cast<unsigned>(masks.size()));
+            masks.resize(masks.size() + num_words, 0);
+            return offset;
+        }
+
+        void set_bit(const unsigned mask, const unsigned bit) throw() {
+            masks[mask + bit / WORD_BITS] |= (
+                static_cast<word_type>(1) << (bit % WORD_BITS)
+            );
+        }
+
+        static bool has_bit(const word_type *set, const unsigned bit) throw() {
+            return 0 != (
+                set[bit / WORD_BITS] &
+                (static_cast<word_type>(1) << (bit % WORD_BITS))
+            );
+        }
+
+        /// index of the lowest set bit of a non-zero word
+        static unsigned lowest_bit(word_type word) throw() {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+            unsigned bit(0);
+            for(; 0 == (word & 1U); word >>= 1U) {
+                ++bit;
+            }
+            return bit;
+#endif
+        }
+
+        /// offset of the cell for tokens [i, j) in the chart. cells are
+        /// stored by length, and then by start.
+        unsigned cell(const unsigned i, const unsigned j) const throw() {
+            const unsigned len(j - i - 1U);
+            return (len * num_tokens - (len * (len - 1U)) / 2U + i) * num_words;
+        }
+
+        /// add the variables of one mask to a set
+        void add_mask_to(word_type *set, const unsigned mask) const throw() {
+            const word_type *bits(&(masks[mask]));
+            for(unsigned w(0); w < num_words; ++w) {
+                set[w] |= bits[w];
+            }
+        }
+
+        /// does a set have any variable in a mask?
+        bool intersects(const word_type *set, const unsigned mask) const throw() {
+            const word_type *bits(&(masks[mask]));
+            word_type any(0);
+            for(unsigned w(0); w < num_words; ++w) {
+                any |= set[w] & bits[w];
+            }
+            return 0 != any;
+        }
+
+        /// add every A to the cell where A --> B C, B is in the left cell,
+        /// and C is in the right cell
+        void combine(
+            word_type *set,
+            const word_type *left,
+            const word_type *right
+        ) const throw() {
+            const word_type *has_pairs(&(masks[has_pairs_mask]));
+
+            for(unsigned w(0); w < num_words; ++w) {
+                for(word_type bits(left[w] & has_pairs[w]);
+                    0 != bits;
+                    bits &= bits - 1U) {
+
+                    const unsigned B(w * WORD_BITS + lowest_bit(bits));
+                    if(!intersects(right, right_mask[B])) {
+                        continue;
+                    }
+
+                    for(unsigned p(pairs_begin[B]); p < pairs_begin[B + 1U]; ++p) {
+                        if(has_bit(right, pairs[p].right)) {
+                            add_mask_to(set, pairs[p].mask);
+                        }
+                    }
+                }
+            }
+        }
+
+        /// build the parse forest from the chart
+        void build_forest(forest_type &forest) const throw() {
+            const variable_type S(cfg.get_start_variable());
+
+            if(0 == num_tokens) {
+                forest.set_root(forest.null_node(S, 0));
+                return;
+            }
+
+            std::vector<forest_node_type *> work;
+            std::set<forest_node_type *> seen;
+            unsigned serial(0);
+
+            forest_node_type *root(forest.symbol_node(S, 0, num_tokens));
+            forest.set_root(root);
+            work.push_back(root);
+
+            for(; !work.empty(); ) {
+                forest_node_type *node(work.back());
+                work.pop_back();
+
+                if(!seen.insert(node).second) {
+                    continue;
+                }
+
+                const unsigned A(node->symbol.number());
+                const unsigned i(node->start);
+                const unsigned j(node->end);
+
+                for(const unsigned *initial(rules.predictions_begin(A)),
+                                   *last(rules.predictions_end(A));
+                    initial != last;
+                    ++initial) {
+
+                    const unsigned r(*initial);
+                    const dotted_rule_type &first(rules[r]);
+
+                    // A --> a
+                    if(rule_table_type::SCAN == first.kind) {
+                        if(1U != j - i) {
+                            continue;
+                        }
+
+                        const terminal_type a(first.next_symbol);
+                        if(0 == tokens[i]
+                            ? !cfg.is_variable_terminal(a)
+                            : a.number() != tokens[i]) {
+                            continue;
+                        }
+
+                        forest.add_packed(
+                            node, r + 1U, i, 0,
+                            forest.terminal_node(a, i),
+                            serial++
+                        );
+                        continue;
+                    }
+
+                    // A --> B C
+                    if(rule_table_type::PREDICT != first.kind) {
+                        continue;
+                    }
+
+                    const symbol_type &B(first.next_symbol);
+                    const symbol_type &C(rules[r + 1U].next_symbol);
+
+                    for(unsigned k(i + 1U); k < j; ++k) {
+                        if(!has_bit(&(chart[cell(i, k)]), B.number())
+                        || !has_bit(&(chart[cell(k, j)]), C.number())) {
+                            continue;
+                        }
+
+                        forest_node_type *left(forest.symbol_node(B, i, k));
+                        forest_node_type *right(forest.symbol_node(C, k, j));
+                        forest_node_type *inter(
+                            forest.intermediate_node(r + 1U, i, k)
+                        );
+
+                        forest.add_packed(inter, r + 1U, i, 0, left, serial);
+                        forest.add_packed(node, r + 2U, k, inter, right, serial);
+                        ++serial;
+
+                        work.push_back(left);
+                        work.push_back(right);
+                    }
+                }
+            }
+        }
+
+    public:
+
+        /// make a parser for a grammar in Chomsky normal form
+        CFG_PARSE_CYK(const CFG &cfg_) throw()
+            : cfg(cfg_)
+            , rules()
+            , is_cnf(true)
+            , accepts_empty(false)
+            , start_var(0)
+            , num_words(0)
+            , masks()
+            , pairs()
+            , pairs_begin()
+            , has_pairs_mask(0)
+            , right_mask()
+            , terminal_mask()
+            , variable_terminal_mask(0)
+            , chart()
+            , num_tokens(0)
+            , tokens()
+        {
+            if(0 == cfg.num_productions() || !cfg.has_start_variable()) {
+                return;
+            }
+
+            rules.compile(cfg);
+            start_var = cfg.get_start_variable().number();
+
+            const unsigned num_vars(rules.num_variables());
+            num_words = (num_vars + WORD_BITS - 1U) / WORD_BITS;
+
+            has_pairs_mask = add_mask();
+            variable_terminal_mask = add_mask();
+            right_mask.assign(num_vars, NO_MASK);
+            pairs_begin.assign(num_vars + 1U, 0U);
+
+            // masks of the variables A for each pair (B, C), grouped by B
+            std::vector<std::vector<std::pair<unsigned, unsigned> > >
+                rules_of(num_vars);
+
+            for(unsigned A(1); A < num_vars; ++A) {
+                for(const unsigned *initial(rules.predictions_begin(A)),
+                                   *last(rules.predictions_end(A));
+                    initial != last;
+                    ++initial) {
+
+                    const dotted_rule_type &first(rules[*initial]);
+
+                    // A --> epsilon
+                    if(rule_table_type::COMPLETE == first.kind) {
+                        if(A == start_var) {
+                            accepts_empty = true;
+                        } else {
+                            is_cnf = false;
+                        }
+
+                    // A --> a
+                    } else if(rule_table_type::SCAN == first.kind) {
+                        if(rule_table_type::COMPLETE != rules[*initial + 1U].kind) {
+                            is_cnf = false;
+                            continue;
+                        }
+
+                        const terminal_type a(first.next_symbol);
+                        const unsigned t(a.number());
+                        if(terminal_mask.size() <= t) {
+                            terminal_mask.resize(t + 1U, NO_MASK);
+                        }
+                        if(NO_MASK == terminal_mask[t]) {
+                            terminal_mask[t] = add_mask();
+                        }
+                        set_bit(terminal_mask[t], A);
+
+                        if(cfg.is_variable_terminal(a)) {
+                            set_bit(variable_terminal_mask, A);
+                        }
+
+                    // A --> B C
+                    } else {
+                        const dotted_rule_type &second(rules[*initial + 1U]);
+                        if(rule_table_type::PREDICT != second.kind
+                        || rule_table_type::COMPLETE != rules[*initial + 2U].kind) {
+                            is_cnf = false;
+                            continue;
+                        }
+
+                        rules_of[first.next_symbol.number()].push_back(
+                            std::make_pair(second.next_symbol.number(), A)
+                        );
+                    }
+                }
+            }
+
+            // group the pair rules by (B, C)
+            for(unsigned B(1); B < num_vars; ++B) {
+                pairs_begin[B] = static_cast<unsigned>(pairs.size());
+                std::vector<std::pair<unsigned, unsigned> > &of_B(rules_of[B]);
+
+                if(of_B.empty()) {
+                    continue;
+                }
+
+                set_bit(has_pairs_mask, B);
+                right_mask[B] = add_mask();
+                std::sort(of_B.begin(), of_B.end());
+
+                for(unsigned p(0); p < of_B.size(); ++p) {
+                    if(0 == p || of_B[p].first != of_B[p - 1U].first) {
+                        pairs.push_back(pair_rule_type(of_B[p].first, add_mask()));
+                        set_bit(right_mask[B], of_B[p].first);
+                    }
+                    set_bit(pairs.back().mask, of_B[p].second);
+                }
+            }
+            pairs_begin[num_vars] = static_cast<unsigned>(pairs.size());
+        }
+
+        /// is the grammar in Chomsky normal form?
+        bool is_valid(void) const throw() {
+            return is_cnf;
+        }
+
+        /// parse the tokens of an input. the reader can be anything whose
+        /// read() returns the next token, or an empty token at the end of
+        /// the input. if forest is non-null then the parse forest of the
+        /// input is built into it.
+        template <typename ReaderT>
+        bool parse(ReaderT &reader, forest_type *forest) throw() {
+            assert(is_cnf);
+
+            if(0 != forest && 0 != num_words) {
+                forest->reset(rules);
+            }
+
+            tokens.clear();
+            alphabet_type lexeme;
+            bool recognized_all(true);
+
+            for(const char *token(reader.read());
+                0 != token && '\0' != *token;
+                token = reader.read()) {
+
+                traits_type::unserialize(token, lexeme);
+
+                unsigned term(0);
+                terminal_type found;
+                if(cfg.find_terminal(lexeme, found)) {
+                    term = found.number();
+                } else if(0 == cfg.num_variable_terminals()) {
+                    io::verbose("    Unrecognized terminal '%s'.\n", token);
+                    recognized_all = false;
+                }
+
+                tokens.push_back(term);
+
+                if(0 != forest) {
+                    forest->add_lexeme(lexeme);
+                }
+            }
+
+            num_tokens = static_cast<unsigned>(tokens.size());
+
+            if(!recognized_all || 0 == num_words) {
+                io::verbose("Failed to parse all input.\n");
+                return false;
+            }
+
+            if(0 == num_tokens) {
+                if(accepts_empty && 0 != forest) {
+                    build_forest(*forest);
+                }
+                return accepts_empty;
+            }
+
+            const unsigned num_cells((num_tokens * (num_tokens + 1U)) / 2U);
+            io::verbose(
+                "Filling %u CYK cells of %u words each...\n",
+                num_cells,
+                num_words
+            );
+
+            chart.assign(num_cells * num_words, 0);
+
+            // cells of single tokens
+            for(unsigned i(0); i < num_tokens; ++i) {
+                word_type *set(&(chart[cell(i, i + 1U)]));
+
+                if(0 == tokens[i]) {
+                    add_mask_to(set, variable_terminal_mask);
+                } else if(tokens[i] < terminal_mask.size()
+                       && NO_MASK != terminal_mask[tokens[i]]) {
+                    add_mask_to(set, terminal_mask[tokens[i]]);
+                }
+            }
+
+            // cells of longer runs of tokens
+            for(unsigned len(2U); len <= num_tokens; ++len) {
+                for(unsigned i(0), j(len); j <= num_tokens; ++i, ++j) {
+                    word_type *set(&(chart[cell(i, j)]));
+                    for(unsigned k(i + 1U); k < j; ++k) {
+                        combine(
+                            set,
+                            &(chart[cell(i, k)]),
+                            &(chart[cell(k, j)])
+                        );
+                    }
+                }
+            }
+
+            if(!has_bit(&(chart[cell(0, num_tokens)]), start_var)) {
+                io::verbose("Failed to parse all input.\n");
+                return false;
+            }
+
+            io::verbose("Successfully parsed.\n");
+
+            if(0 != forest) {
+                io::verbose("Building parse forest...\n");
+                build_forest(*forest);
+                io::verbose(
+                    "Parse forest has %u nodes.\n",
+                    forest->num_nodes()
+                );
+            }
+
+            return true;
+        }
+    };
+}}
+
+#endif /* FLTL_CFG_PARSE_CYK_HPP_ */
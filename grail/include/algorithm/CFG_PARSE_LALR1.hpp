@@ -0,0 +1,254 @@
+/*
+ * CFG_PARSE_LALR1.hpp
+ *
+ *  Created on: May 27, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CFG_PARSE_LALR1_HPP_
+#define FLTL_CFG_PARSE_LALR1_HPP_
+
+#include <cassert>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+#include "grail/include/cfg/DottedRuleTable.hpp"
+#include "grail/include/cfg/LALR1Table.hpp"
+#include "grail/include/cfg/ParseForest.hpp"
+
+#include "grail/include/io/verbose.hpp"
+
+namespace grail { namespace algorithm {
+
+    /// parse an input in linear time with a shift-reduce parser driven by
+    /// conflict-free LALR(1) tables.
+    ///
+    /// the parser never changes the grammar or the tables, so any number
+    /// of parsers can share them.
+    template <typename AlphaT>
+    class CFG_PARSE_LALR1 : private fltl::trait::Uncopyable {
+    public:
+
+        // take off the templates!
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef cfg::LALR1Table<AlphaT> table_type;
+        typedef cfg::DottedRuleTable<AlphaT> rule_table_type;
+        typedef typename rule_table_type::dotted_rule_type dotted_rule_type;
+        typedef cfg::ParseForest<AlphaT> forest_type;
+        typedef typename forest_type::node_type forest_node_type;
+
+    private:
+
+        /// an entry of the parse stack
+        class stack_entry_type {
+        public:
+
+            unsigned state;
+
+            // where the symbol that entered the state starts
+            unsigned start;
+
+            // the forest of that symbol; only used when building a forest
+            forest_node_type *node;
+
+            stack_entry_type(void)
+                : state(0)
+                , start(0)
+                , node(0)
+            { }
+        };
+
+        const CFG &cfg;
+
+        const table_type &table;
+
+        std::vector<stack_entry_type> stack;
+
+        /// get the table column of the next token
+        template <typename ReaderT>
+        unsigned read_column(
+            ReaderT &reader,
+            forest_type *forest,
+            alphabet_type &lexeme
+        ) throw() {
+            const char *token(reader.read());
+            if(0 == token || '\0' == *token) {
+                return table.end_column();
+            }
+
+            traits_type::unserialize(token, lexeme);
+
+            if(0 != forest) {
+                forest->add_lexeme(lexeme);
+            }
+
+            terminal_type term;
+            if(cfg.find_terminal(lexeme, term)) {
+                return term.number();
+            }
+
+            io::verbose("    Unrecognized terminal '%s'.\n", token);
+            return table_type::UNKNOWN_TOKEN;
+        }
+
+        /// build the forest of the production being reduced from the
+        /// nodes of the top entries of the stack
+        forest_node_type *reduce_forest(
+            forest_type &forest,
+            const unsigned id,
+            const unsigned pos
+        ) throw() {
+            const rule_table_type &rules(table.get_rules());
+            const dotted_rule_type &rule(rules[id]);
+            const symbol_type &var(table.variable_symbol(rule.lhs));
+            const unsigned len(rule.dot);
+
+            // A --> epsilon
+            if(0 == len) {
+                forest_node_type *node(forest.symbol_node(var, pos, pos));
+                forest.add_packed(node, id, pos, 0, 0, 0U);
+                return node;
+            }
+
+            const unsigned first(static_cast<unsigned>(stack.size()) - len);
+            const unsigned start(stack[first].start);
+            const unsigned initial(id - len);
+            forest_node_type *left(0);
+
+            for(unsigned dot(1); dot <= len; ++dot) {
+                const stack_entry_type &child(stack[first + dot - 1U]);
+                forest_node_type *node(0);
+
+                if(dot == len) {
+                    node = forest.symbol_node(var, start, pos);
+                } else {
+                    node = forest.intermediate_node(
+                        initial + dot,
+                        start,
+                        stack[first + dot].start
+                    );
+                }
+
+                forest.add_packed(node, initial + dot, child.start, left, child.node, 0U);
+                left = node;
+            }
+
+            return left;
+        }
+
+    public:
+
+        CFG_PARSE_LALR1(const CFG &cfg_, const table_type &table_) throw()
+            : cfg(cfg_)
+            , table(table_)
+            , stack()
+        { }
+
+        /// parse the tokens of an input. the reader can be anything whose
+        /// read() returns the next token, or an empty token at the end of
+        /// the input. if forest is non-null then the parse tree of the
+        /// input is built into it.
+        template <typename ReaderT>
+        bool parse(ReaderT &reader, forest_type *forest) throw() {
+            assert(table.get_conflicts().empty());
+
+            const rule_table_type &rules(table.get_rules());
+
+            if(0 != forest) {
+                forest->reset(rules);
+            }
+
+            stack.clear();
+            stack.push_back(stack_entry_type());
+
+            alphabet_type lexeme;
+            unsigned pos(0);
+            unsigned column(read_column(reader, forest, lexeme));
+
+            for(;;) {
+                const unsigned action(table.action(stack.back().state, column));
+                stack_entry_type entry;
+
+                switch(action & table_type::ACTION_MASK) {
+                case table_type::SHIFT_ACTION:
+                    entry.state = action >> table_type::ACTION_BITS;
+                    entry.start = pos;
+                    if(0 != forest) {
+                        entry.node = forest->terminal_node(
+                            table.accessing_symbol(entry.state),
+                            pos
+                        );
+                    }
+
+                    stack.push_back(entry);
+                    ++pos;
+                    column = read_column(reader, forest, lexeme);
+                    break;
+
+                case table_type::REDUCE_ACTION: {
+                    const unsigned id(action >> table_type::ACTION_BITS);
+                    const dotted_rule_type &rule(rules[id]);
+                    const unsigned len(rule.dot);
+
+                    entry.start = pos;
+                    if(0 != len) {
+                        entry.start = stack[stack.size() - len].start;
+                    }
+                    if(0 != forest) {
+                        entry.node = reduce_forest(*forest, id, pos);
+                    }
+
+                    stack.resize(stack.size() - len);
+                    entry.state = table.goto_state(stack.back().state, rule.lhs);
+                    assert(table_type::NO_STATE != entry.state);
+
+                    stack.push_back(entry);
+                    break;
+                }
+
+                case table_type::ACCEPT_ACTION:
+                    if(0 != forest) {
+                        forest->set_root(stack.back().node);
+                    }
+                    io::verbose("Successfully parsed.\n");
+                    return true;
+
+                default:
+                    io::verbose("Failed to parse all input.\n");
+                    return false;
+                }
+            }
+
+            return false;
+        }
+    };
+}}
+
+#endif /* FLTL_CFG_PARSE_LALR1_HPP_ */
@@ -0,0 +1,278 @@
+/*
+ * CFG_PARSE_LL1.hpp
+ *
+ *  Created on: May 26, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CFG_PARSE_LL1_HPP_
+#define FLTL_CFG_PARSE_LL1_HPP_
+
+#include <cassert>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+#include "grail/include/cfg/DottedRuleTable.hpp"
+#include "grail/include/cfg/LL1Table.hpp"
+#include "grail/include/cfg/ParseForest.hpp"
+
+#include "grail/include/io/verbose.hpp"
+
+namespace grail { namespace algorithm {
+
+    /// parse an input in linear time using a conflict-free LL(1) predict
+    /// table. the parse stack holds one dotted rule for each production
+    /// being expanded, so expanding a production pushes one entry, no
+    /// matter how long the production is.
+    ///
+    /// the parser never changes the grammar or the table, so any number of
+    /// parsers can share them.
+    template <typename AlphaT>
+    class CFG_PARSE_LL1 : private fltl::trait::Uncopyable {
+    public:
+
+        // take off the templates!
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef cfg::LL1Table<AlphaT> table_type;
+        typedef cfg::DottedRuleTable<AlphaT> rule_table_type;
+        typedef typename rule_table_type::dotted_rule_type dotted_rule_type;
+        typedef cfg::ParseForest<AlphaT> forest_type;
+        typedef typename forest_type::node_type forest_node_type;
+
+    private:
+
+        /// the forest being built for one entry of the parse stack
+        class frame_type {
+        public:
+
+            // the variable being expanded
+            symbol_type var;
+
+            // where the production's first symbol starts
+            unsigned start;
+
+            // where the next symbol of the production starts
+            unsigned pivot;
+
+            // node for the symbols of the production matched so far
+            forest_node_type *left;
+
+            frame_type(const symbol_type &var_, const unsigned start_)
+                : var(var_)
+                , start(start_)
+                , pivot(start_)
+                , left(0)
+            { }
+        };
+
+        const CFG &cfg;
+
+        const table_type &table;
+
+        /// the dotted rules being expanded
+        std::vector<unsigned> stack;
+
+        /// forest nodes of the entries of stack; only used when building a
+        /// forest
+        std::vector<frame_type> frames;
+
+        /// get the table column of the next token
+        template <typename ReaderT>
+        unsigned read_column(
+            ReaderT &reader,
+            forest_type *forest,
+            alphabet_type &lexeme
+        ) throw() {
+            const char *token(reader.read());
+            if(0 == token || '\0' == *token) {
+                return table.end_column();
+            }
+
+            traits_type::unserialize(token, lexeme);
+
+            if(0 != forest) {
+                forest->add_lexeme(lexeme);
+            }
+
+            terminal_type term;
+            if(cfg.find_terminal(lexeme, term)) {
+                return term.number();
+            }
+
+            io::verbose("    Unrecognized terminal '%s'.\n", token);
+            return table_type::UNKNOWN_TOKEN;
+        }
+
+        /// add the derivation of the symbol after the dot of a rule to the
+        /// forest of the rule's production
+        void add_child(
+            forest_type &forest,
+            const unsigned id,
+            forest_node_type *child,
+            const unsigned end
+        ) throw() {
+            const rule_table_type &rules(table.get_rules());
+            frame_type &frame(frames.back());
+
+            if(rule_table_type::START_RULE == id) {
+                forest.set_root(child);
+                return;
+            }
+
+            const unsigned next(rules[id].successor);
+            forest_node_type *node(0);
+
+            if(rule_table_type::COMPLETE == rules[next].kind) {
+                node = forest.symbol_node(frame.var, frame.start, end);
+            } else {
+                node = forest.intermediate_node(next, frame.start, end);
+            }
+
+            forest.add_packed(node, next, frame.pivot, frame.left, child, 0U);
+            frame.left = node;
+            frame.pivot = end;
+        }
+
+    public:
+
+        CFG_PARSE_LL1(const CFG &cfg_, const table_type &table_) throw()
+            : cfg(cfg_)
+            , table(table_)
+            , stack()
+            , frames()
+        { }
+
+        /// parse the tokens of an input. the reader can be anything whose
+        /// read() returns the next token, or an empty token at the end of
+        /// the input. if forest is non-null then the parse tree of the
+        /// input is built into it.
+        template <typename ReaderT>
+        bool parse(ReaderT &reader, forest_type *forest) throw() {
+            assert(0 == table.get_num_conflicts());
+
+            const rule_table_type &rules(table.get_rules());
+
+            if(0 != forest) {
+                forest->reset(rules);
+            }
+
+            stack.clear();
+            frames.clear();
+
+            stack.push_back(rule_table_type::START_RULE);
+            if(0 != forest) {
+                frames.push_back(frame_type(symbol_type(), 0));
+            }
+
+            alphabet_type lexeme;
+            unsigned pos(0);
+            unsigned column(read_column(reader, forest, lexeme));
+
+            for(;;) {
+                const unsigned id(stack.back());
+                const dotted_rule_type &rule(rules[id]);
+
+                // A --> alpha * B beta; expand B
+                if(rule_table_type::PREDICT == rule.kind) {
+                    const unsigned initial(table.predict(
+                        rule.next_symbol.number(),
+                        column
+                    ));
+
+                    if(table_type::NO_RULE == initial) {
+                        io::verbose("Failed to parse all input.\n");
+                        return false;
+                    }
+
+                    stack.push_back(initial);
+                    if(0 != forest) {
+                        frames.push_back(frame_type(rule.next_symbol, pos));
+                    }
+
+                // A --> alpha * a beta; match a
+                } else if(rule_table_type::SCAN == rule.kind) {
+                    const unsigned term(rule.next_symbol.number());
+
+                    if(term != column
+                    && (table_type::UNKNOWN_TOKEN != column
+                        || !table.is_variable_terminal_column(term))) {
+                        io::verbose("Failed to parse all input.\n");
+                        return false;
+                    }
+
+                    if(0 != forest) {
+                        add_child(
+                            *forest,
+                            id,
+                            forest->terminal_node(rule.next_symbol, pos),
+                            pos + 1U
+                        );
+                    }
+
+                    stack.back() = rule.successor;
+                    ++pos;
+                    column = read_column(reader, forest, lexeme);
+
+                // A --> alpha *; go back to the production that used A
+                } else {
+                    stack.pop_back();
+                    if(stack.empty()) {
+                        break;
+                    }
+
+                    if(0 != forest) {
+                        forest_node_type *node(frames.back().left);
+
+                        // A --> epsilon
+                        if(0 == rule.dot) {
+                            node = forest->symbol_node(frames.back().var, pos, pos);
+                            forest->add_packed(node, id, pos, 0, 0, 0U);
+                        }
+
+                        frames.pop_back();
+                        add_child(*forest, stack.back(), node, pos);
+                    }
+
+                    stack.back() = rules[stack.back()].successor;
+                }
+            }
+
+            if(table.end_column() != column) {
+                io::verbose("Failed to parse all input.\n");
+                return false;
+            }
+
+            io::verbose("Successfully parsed.\n");
+            return true;
+        }
+    };
+}}
+
+#endif /* FLTL_CFG_PARSE_LL1_HPP_ */
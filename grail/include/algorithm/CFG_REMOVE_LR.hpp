@@ -33,6 +33,7 @@
 #include <set>
 #include <map>
 #include <utility>
+#include <vector>
 
 #include "fltl/include/CFG.hpp"
 
@@ -73,26 +74,26 @@ namespace grail { namespace algorithm {
             variable_type tail(cfg.add_variable());
             cfg.add_production(tail, cfg.epsilon());
 
-            for(LR_productions.rewind();
-                LR_productions.match_next();
-                productions.rewind()) {
-
-                if(alpha.is_empty()) {
+            // collect the non-recursive productions before adding any new
+            // productions to A, so that the new productions aren't visited
+            std::vector<symbol_string_type> betas;
+            for(; productions.match_next(); ) {
+                if(beta.is_empty() || A == beta.at(0)) {
                     continue;
                 }
+                betas.push_back(beta);
+            }
 
-                cfg.add_production(tail, alpha + tail);
-
-                for(; productions.match_next(); ) {
-                    if(beta.is_empty() || A == beta.at(0)) {
-                        continue;
-                    }
-
-                    cfg.add_production(A, beta + tail);
+            for(LR_productions.rewind(); LR_productions.match_next(); ) {
+                if(!alpha.is_empty()) {
+                    cfg.add_production(tail, alpha + tail);
                 }
-
                 cfg.remove_production(LR_prod);
             }
+
+            for(unsigned i(0); i < betas.size(); ++i) {
+                cfg.add_production(A, betas[i] + tail);
+            }
         }
 
         /// turn all indirect left recursion into direct left recursion
@@ -70,6 +70,21 @@ namespace grail { namespace algorithm {
             }
         }
 
+        /// does every variable of a string generate some string of
+        /// terminals?
+        static bool is_generating(
+            const symbol_string_type &str,
+            const std::vector<bool> &generating
+        ) throw() {
+            for(unsigned i(0), len(str.length()); i < len; ++i) {
+                if(str.at(i).is_variable()
+                && !generating[variable_type(str.at(i)).number()]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
     public:
 
         static void run(CFG &cfg) throw() {
@@ -84,24 +99,54 @@ namespace grail { namespace algorithm {
                 return;
             }
 
-            // find all reachable variables
-            std::vector<bool> reachable(cfg.num_variables_capacity() + 2, false);
-            reach_variable(cfg, cfg.get_start_variable(), reachable);
+            const variable_type start_var(cfg.get_start_variable());
 
-            // get rid of unreachable variables
+            // find all generating variables; a variable is generating if
+            // it has a production whose variables are all generating
+            std::vector<bool> generating(cfg.num_variables_capacity() + 2, false);
+            production_type P;
+            symbol_string_type str;
+            generator_type productions(cfg.search(~P, (~V) --->* ~str));
+
+            for(bool updated(true); updated; ) {
+                updated = false;
+                for(productions.rewind(); productions.match_next(); ) {
+                    if(!generating[V.number()]
+                    && is_generating(str, generating)) {
+                        generating[V.number()] = true;
+                        updated = true;
+                    }
+                }
+            }
+
+            // get rid of the productions that use non-generating variables,
+            // which includes all productions of non-generating variables
+            for(productions.rewind(); productions.match_next(); ) {
+                if(!is_generating(str, generating)) {
+                    cfg.remove_production(P);
+                }
+            }
+
+            // get rid of non-generating variables. the start variable is
+            // kept, even if it generates nothing, so that the grammar
+            // doesn't lose its start variable
             for(variables.rewind();
                 variables.match_next(); ) {
 
-                if(!(reachable[V.number()])) {
-                    cfg.remove_variable(V);
+                if(!(generating[V.number()]) && start_var != V) {
+                    cfg.unsafe_remove_variable(V);
                 }
             }
 
-            // get rid of non-generating variables
+            // find all reachable variables
+            std::vector<bool> reachable(cfg.num_variables_capacity() + 2, false);
+            reach_variable(cfg, start_var, reachable);
+
+            // get rid of unreachable variables
             for(variables.rewind();
                 variables.match_next(); ) {
 
-                if(0 == cfg.num_productions(V)) {
+                if(!(reachable[V.number()])) {
                     cfg.remove_variable(V);
                 }
             }
@@ -33,11 +33,13 @@
 #include <set>
 #include <map>
 #include <utility>
+#include <vector>
 
 #include "fltl/include/CFG.hpp"
 
 #include "grail/include/algorithm/CFG_REMOVE_UNITS.hpp"
 #include "grail/include/algorithm/CFG_REMOVE_EPSILON.hpp"
+#include "grail/include/algorithm/CFG_REMOVE_USELESS.hpp"
 #include "grail/include/algorithm/CFG_TO_2CFG.hpp"
 
 #include "grail/include/io/verbose.hpp"
@@ -69,8 +71,18 @@ namespace grail { namespace algorithm {
             variable_type B;
             terminal_type T;
 
-            generator_type pairs(cfg.search(~P, cfg._ --->* cfg._ + cfg._));
-            for(; pairs.match_next(); ) {
+            // collect the pairs before changing any of them, so that the
+            // pairs added below aren't visited and rewritten a second time
+            std::vector<production_type> pairs;
+            generator_type pair_prods(
+                cfg.search(~P, cfg._ --->* cfg._ + cfg._)
+            );
+            for(; pair_prods.match_next(); ) {
+                pairs.push_back(P);
+            }
+
+            for(unsigned i(0); i < pairs.size(); ++i) {
+                P = pairs[i];
                 str = P.symbols();
 
                 const bool first_is_term(str.at(0).is_terminal());
@@ -120,6 +132,27 @@ namespace grail { namespace algorithm {
                         A = vars_to_replace[A];
                     }
                     cfg.add_production(P.variable(), A + B);
+
+                // two variables, either of which might have been replaced
+                } else {
+                    A = str.at(0);
+                    B = str.at(1);
+
+                    const bool replace_first(0 != vars_to_replace.count(A));
+                    const bool replace_second(0 != vars_to_replace.count(B));
+
+                    if(!replace_first && !replace_second) {
+                        continue;
+                    }
+
+                    cfg.remove_production(P);
+                    if(replace_first) {
+                        A = vars_to_replace[A];
+                    }
+                    if(replace_second) {
+                        B = vars_to_replace[B];
+                    }
+                    cfg.add_production(P.variable(), A + B);
                 }
             }
         }
@@ -129,6 +162,13 @@ namespace grail { namespace algorithm {
         /// convert a context-free grammar to chomsky normal form.
         static void run(CFG &cfg) throw() {
 
+            io::verbose("Removing useless variables...\n");
+
+            // drop the variables that generate no strings of terminals or
+            // can't be reached; if nothing is left then the grammar makes
+            // no strings, and there is nothing to convert
+            CFG_REMOVE_USELESS<AlphaT>::run(cfg);
+
             if(0 == cfg.num_productions()) {
                 return;
             }
@@ -163,13 +203,27 @@ namespace grail { namespace algorithm {
             production_type P;
             variable_type A;
 
+            // variables merged into others are only removed once their uses
+            // have been replaced; otherwise add_variable could hand out
+            // their ids while they are still keys of vars_to_replace
+            std::vector<variable_type> merged_vars;
+
             generator_type terminal_units(cfg.search(~P, (~A) --->* T));
 
+            // the start variable is never merged into (or replaced by)
+            // another variable, otherwise the grammar could lose its start
+            // variable or have it show up on the right-hand side of a
+            // production
+            const variable_type start_var(cfg.get_start_variable());
             for(; terminal_units.match_next(); ) {
+                if(A == start_var) {
+                    continue;
+                }
+
                 if(1 == cfg.num_productions(A)) {
                     if(1 == terminal_rules.count(T)) {
                         vars_to_replace[A] = terminal_rules[T];
-                        cfg.unsafe_remove_variable(A);
+                        merged_vars.push_back(A);
                     } else {
                         terminal_rules[T] = A;
                     }
@@ -180,6 +234,10 @@ namespace grail { namespace algorithm {
 
             clean_up_terminals(cfg, terminal_rules, vars_to_replace);
 
+            for(unsigned i(0); i < merged_vars.size(); ++i) {
+                cfg.unsafe_remove_variable(merged_vars[i]);
+            }
+
             io::verbose("Done.\n");
         }
     };
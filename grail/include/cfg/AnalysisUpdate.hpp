@@ -0,0 +1,677 @@
+/*
+ * AnalysisUpdate.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_ANALYSIS_UPDATE_HPP_
+#define FLTL_ANALYSIS_UPDATE_HPP_
+
+#include <map>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/cfg/DependencyGraph.hpp"
+#include "grail/include/cfg/TerminalSet.hpp"
+
+namespace grail { namespace cfg {
+
+    /// brings the NULL, FIRST, and FOLLOW sets of a grammar up to date
+    /// after some of its productions were added or removed, instead of
+    /// computing the sets again.
+    ///
+    /// added productions can only add to the sets, so what they add is
+    /// pushed along the dependencies between the sets until nothing
+    /// changes. removed productions use delete and rederive: every set
+    /// that might have depended on what was removed is emptied and derived
+    /// again from the sets that can't have changed, in the order of the
+    /// strongly connected components of their dependencies, and then the
+    /// additions are pushed as before. if too many sets would be derived
+    /// again then the update gives up, as it's cheaper to compute all of
+    /// the sets again.
+    ///
+    /// Note: - only productions may have changed; the variables, terminals,
+    ///         and start variable must be the same as when the sets were
+    ///         computed.
+    ///
+    ///       - the NULL set must be updated before the FIRST sets, and the
+    ///         FIRST sets before the FOLLOW sets.
+    template <typename AlphaT>
+    class AnalysisUpdate {
+    public:
+
+        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
+
+    private:
+
+        /// set of variables that remembers the order in which they were
+        /// added
+        class VariableSet {
+        private:
+
+            std::vector<bool> is_member;
+            std::vector<variable_type> members;
+
+        public:
+
+            explicit VariableSet(const unsigned capacity) throw()
+                : is_member(capacity, false)
+                , members()
+            { }
+
+            /// add a variable; returns true if it wasn't already a member
+            inline bool insert(const variable_type var) throw() {
+                if(is_member[var.number()]) {
+                    return false;
+                }
+                is_member[var.number()] = true;
+                members.push_back(var);
+                return true;
+            }
+
+            inline bool contains(const unsigned var) const throw() {
+                return is_member[var];
+            }
+
+            inline unsigned size(void) const throw() {
+                return static_cast<unsigned>(members.size());
+            }
+
+            inline const variable_type &operator[](const unsigned i) const throw() {
+                return members[i];
+            }
+        };
+
+        const cfg_type &cfg;
+
+        /// productions that were added and removed
+        std::vector<production_type> added;
+        std::vector<production_type> removed;
+
+        /// the most sets that are derived again before giving up
+        const unsigned max_rederived;
+
+        /// one more than the largest variable number of the grammar
+        const unsigned capacity;
+
+        /// the NULL set from before the update
+        std::vector<bool> old_nullable;
+
+        /// the variables that stopped or started being nullable, and whose
+        /// FIRST sets lost or gained terminals
+        VariableSet lost_nullable;
+        VariableSet gained_nullable;
+        VariableSet first_shrunk;
+        VariableSet first_grown;
+
+        /// FIRST set of the end of a production, see add_follow
+        TerminalSet suffix;
+
+        /// searches for the productions of X, and for the productions
+        /// that use X, where the variable of the production is V
+        production_type P;
+        variable_type V;
+        variable_type X;
+        generator_type productions_of_X;
+        generator_type productions_using_X;
+
+        /// is a variable nullable either before or after the update?
+        inline bool was_or_is_nullable(
+            const std::vector<bool> &nullable,
+            const unsigned var
+        ) const throw() {
+            return nullable[var] || old_nullable[var];
+        }
+
+        static bool all_nullable(
+            const symbol_string_type &syms,
+            const std::vector<bool> &nullable
+        ) throw() {
+            for(unsigned i(0); i < syms.length(); ++i) {
+                if(syms.at(i).is_terminal() || !nullable[syms.at(i).number()]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// add the terminals that can begin the symbols of a production to
+        /// the FIRST set of its variable; returns true if the set changed
+        static bool add_first(
+            const variable_type var,
+            const symbol_string_type &syms,
+            const std::vector<bool> &nullable,
+            std::vector<TerminalSet> &first
+        ) throw() {
+            TerminalSet &var_first(first[var.number()]);
+            bool changed(false);
+
+            for(unsigned i(0); i < syms.length(); ++i) {
+                const symbol_type sym(syms.at(i));
+
+                if(sym.is_terminal()) {
+                    changed = var_first.insert(sym.number()) || changed;
+                    break;
+                }
+
+                if(var.number() != sym.number()) {
+                    changed = var_first.insert_all(first[sym.number()])
+                           || changed;
+                }
+
+                if(!nullable[sym.number()]) {
+                    break;
+                }
+            }
+
+            return changed;
+        }
+
+        /// add what follows each variable in the symbols of a production of
+        /// var to the FOLLOW sets of those variables. if only is given,
+        /// then only the variables in it are changed, and where they
+        /// include the FOLLOW set of another variable in it, an edge is
+        /// added to graph. the variables whose sets changed are added to
+        /// changed, if given.
+        void add_follow(
+            const variable_type var,
+            const symbol_string_type &syms,
+            const std::vector<bool> &nullable,
+            const std::vector<TerminalSet> &first,
+            std::vector<TerminalSet> &follow,
+            const VariableSet *only,
+            DependencyGraph *graph,
+            std::vector<variable_type> *changed
+        ) throw() {
+            bool suffix_nullable(true);
+            suffix.reset(cfg.num_terminals() + 2U);
+
+            for(unsigned i(syms.length()); i-- > 0; ) {
+                const symbol_type sym(syms.at(i));
+
+                if(sym.is_terminal()) {
+                    suffix.reset(cfg.num_terminals() + 2U);
+                    suffix.insert(sym.number());
+                    suffix_nullable = false;
+                    continue;
+                }
+
+                const unsigned sym_var(sym.number());
+
+                if(0 == only || only->contains(sym_var)) {
+                    TerminalSet &sym_follow(follow[sym_var]);
+                    bool grew(sym_follow.insert_all(suffix));
+
+                    if(suffix_nullable && var.number() != sym_var) {
+                        if(0 != graph && only->contains(var.number())) {
+                            graph->add_edge(sym_var, var.number());
+                        } else {
+                            grew = sym_follow.insert_all(follow[var.number()])
+                                || grew;
+                        }
+                    }
+
+                    if(grew && 0 != changed) {
+                        changed->push_back(variable_type(sym));
+                    }
+                }
+
+                if(nullable[sym_var]) {
+                    suffix.insert_all(first[sym_var]);
+                } else {
+                    suffix = first[sym_var];
+                    suffix_nullable = false;
+                }
+            }
+        }
+
+    public:
+
+        /// the changes to the productions of a grammar, as the number of
+        /// times that each production was added, less the number of times
+        /// that it was removed. the sets that are updated must have been
+        /// computed before the first change, and more than max_rederived
+        /// of them are never derived again.
+        AnalysisUpdate(
+            const cfg_type &cfg_,
+            const std::map<production_type, int> &changes,
+            const unsigned max_rederived_
+        ) throw()
+            : cfg(cfg_)
+            , added()
+            , removed()
+            , max_rederived(max_rederived_)
+            , capacity(cfg_.num_variables_capacity() + 2U)
+            , old_nullable()
+            , lost_nullable(capacity)
+            , gained_nullable(capacity)
+            , first_shrunk(capacity)
+            , first_grown(capacity)
+            , suffix()
+            , P()
+            , V()
+            , X()
+            , productions_of_X(cfg_.search(~P, X --->* cfg_.__))
+            , productions_using_X(
+                cfg_.search(~P, (~V) --->* cfg_.__ + X + cfg_.__)
+            )
+        {
+            typename std::map<production_type, int>::const_iterator it(
+                changes.begin()
+            );
+            for(; it != changes.end(); ++it) {
+                if(0 < it->second) {
+                    added.push_back(it->first);
+                } else if(0 > it->second) {
+                    removed.push_back(it->first);
+                }
+            }
+        }
+
+        /// update the NULL set. returns false if the set must be computed
+        /// again.
+        bool update_null_set(std::vector<bool> &nullable) throw() {
+            old_nullable = nullable;
+
+            // the nullable variables that might have depended on the
+            // removed productions
+            VariableSet rederived(capacity);
+            for(unsigned i(0); i < removed.size(); ++i) {
+                if(nullable[removed[i].variable().number()]) {
+                    rederived.insert(removed[i].variable());
+                }
+            }
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                X = rederived[i];
+                for(productions_using_X.rewind();
+                    productions_using_X.match_next(); ) {
+
+                    if(nullable[V.number()] && rederived.insert(V)
+                    && rederived.size() > max_rederived) {
+                        return false;
+                    }
+                }
+            }
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                nullable[rederived[i].number()] = false;
+            }
+
+            // derive them again, and add in what the added productions
+            // make nullable
+            std::vector<variable_type> work_list;
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                X = rederived[i];
+                for(productions_of_X.rewind(); productions_of_X.match_next(); ) {
+                    if(all_nullable(P.symbols(), nullable)) {
+                        nullable[X.number()] = true;
+                        work_list.push_back(X);
+                        break;
+                    }
+                }
+            }
+
+            for(unsigned i(0); i < added.size(); ++i) {
+                const variable_type var(added[i].variable());
+                if(!nullable[var.number()]
+                && all_nullable(added[i].symbols(), nullable)) {
+                    nullable[var.number()] = true;
+                    work_list.push_back(var);
+                }
+            }
+
+            for(; !work_list.empty(); ) {
+                X = work_list.back();
+                work_list.pop_back();
+
+                if(!old_nullable[X.number()]) {
+                    gained_nullable.insert(X);
+                }
+
+                for(productions_using_X.rewind();
+                    productions_using_X.match_next(); ) {
+
+                    if(!nullable[V.number()]
+                    && all_nullable(P.symbols(), nullable)) {
+                        nullable[V.number()] = true;
+                        work_list.push_back(V);
+                    }
+                }
+            }
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                if(!nullable[rederived[i].number()]) {
+                    lost_nullable.insert(rederived[i]);
+                }
+            }
+
+            return true;
+        }
+
+        /// update the FIRST sets of terminals, after the NULL set. returns
+        /// false if the sets must be computed again.
+        bool update_first_set(
+            const std::vector<bool> &nullable,
+            std::vector<TerminalSet> &first
+        ) throw() {
+
+            // the variables whose FIRST sets might have depended on the
+            // removed productions, or on variables that stopped being
+            // nullable
+            VariableSet rederived(capacity);
+            for(unsigned i(0); i < removed.size(); ++i) {
+                rederived.insert(removed[i].variable());
+            }
+
+            for(unsigned i(0); i < lost_nullable.size(); ++i) {
+                X = lost_nullable[i];
+                for(productions_using_X.rewind();
+                    productions_using_X.match_next(); ) {
+                    rederived.insert(V);
+                }
+            }
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                if(rederived.size() > max_rederived) {
+                    return false;
+                }
+
+                X = rederived[i];
+                for(productions_using_X.rewind();
+                    productions_using_X.match_next(); ) {
+
+                    const symbol_string_type syms(P.symbols());
+                    for(unsigned j(0); j < syms.length(); ++j) {
+                        if(syms.at(j) == X) {
+                            rederived.insert(V);
+                            break;
+                        } else if(syms.at(j).is_terminal()
+                               || !was_or_is_nullable(
+                                   nullable, syms.at(j).number())) {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if(rederived.size() > max_rederived) {
+                return false;
+            }
+
+            // empty them and derive them again
+            std::vector<TerminalSet> old_first(rederived.size());
+            DependencyGraph graph;
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                TerminalSet &var_first(first[rederived[i].number()]);
+                old_first[i] = var_first;
+                var_first.reset(var_first.size());
+                graph.add_node(rederived[i].number());
+            }
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                X = rederived[i];
+                TerminalSet &var_first(first[X.number()]);
+
+                for(productions_of_X.rewind(); productions_of_X.match_next(); ) {
+                    const symbol_string_type syms(P.symbols());
+
+                    for(unsigned j(0); j < syms.length(); ++j) {
+                        const symbol_type sym(syms.at(j));
+
+                        if(sym.is_terminal()) {
+                            var_first.insert(sym.number());
+                            break;
+                        }
+
+                        if(rederived.contains(sym.number())) {
+                            if(X.number() != sym.number()) {
+                                graph.add_edge(X.number(), sym.number());
+                            }
+                        } else {
+                            var_first.insert_all(first[sym.number()]);
+                        }
+
+                        if(!nullable[sym.number()]) {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            graph.close(first);
+
+            // add in what the added productions and newly nullable
+            // variables add, and push it to the variables that depend on
+            // the sets that grew
+            std::vector<variable_type> work_list;
+
+            for(unsigned i(0); i < added.size(); ++i) {
+                if(add_first(added[i].variable(), added[i].symbols(),
+                             nullable, first)) {
+                    work_list.push_back(added[i].variable());
+                }
+            }
+
+            for(unsigned i(0); i < gained_nullable.size(); ++i) {
+                X = gained_nullable[i];
+                for(productions_using_X.rewind();
+                    productions_using_X.match_next(); ) {
+
+                    if(add_first(V, P.symbols(), nullable, first)) {
+                        work_list.push_back(V);
+                    }
+                }
+            }
+
+            for(; !work_list.empty(); ) {
+                X = work_list.back();
+                work_list.pop_back();
+
+                if(!rederived.contains(X.number())) {
+                    first_grown.insert(X);
+                }
+
+                for(productions_using_X.rewind();
+                    productions_using_X.match_next(); ) {
+
+                    if(add_first(V, P.symbols(), nullable, first)) {
+                        work_list.push_back(V);
+                    }
+                }
+            }
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                const TerminalSet &var_first(first[rederived[i].number()]);
+                if(!var_first.includes(old_first[i])) {
+                    first_shrunk.insert(rederived[i]);
+                }
+                if(!old_first[i].includes(var_first)) {
+                    first_grown.insert(rederived[i]);
+                }
+            }
+
+            return true;
+        }
+
+        /// update the FOLLOW sets, after the NULL and FIRST sets. returns
+        /// false if the sets must be computed again.
+        bool update_follow_set(
+            const std::vector<bool> &nullable,
+            const std::vector<TerminalSet> &first,
+            std::vector<TerminalSet> &follow
+        ) throw() {
+
+            // the variables whose FOLLOW sets might have depended on the
+            // removed productions, or on variables that stopped being
+            // nullable or whose FIRST sets shrank
+            VariableSet rederived(capacity);
+            for(unsigned i(0); i < removed.size(); ++i) {
+                const symbol_string_type syms(removed[i].symbols());
+                for(unsigned j(0); j < syms.length(); ++j) {
+                    if(syms.at(j).is_variable()) {
+                        rederived.insert(variable_type(syms.at(j)));
+                    }
+                }
+            }
+
+            for(unsigned k(0); k < 2U; ++k) {
+                const VariableSet &shrunk(0 == k ? lost_nullable : first_shrunk);
+                for(unsigned i(0); i < shrunk.size(); ++i) {
+                    X = shrunk[i];
+                    for(productions_using_X.rewind();
+                        productions_using_X.match_next(); ) {
+
+                        const symbol_string_type syms(P.symbols());
+                        for(unsigned j(0); j < syms.length(); ++j) {
+                            if(syms.at(j).is_variable()) {
+                                rederived.insert(variable_type(syms.at(j)));
+                            }
+                        }
+                    }
+                }
+            }
+
+            // a variable at the end of a production of X includes the
+            // FOLLOW set of X
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                if(rederived.size() > max_rederived) {
+                    return false;
+                }
+
+                X = rederived[i];
+                for(productions_of_X.rewind(); productions_of_X.match_next(); ) {
+                    const symbol_string_type syms(P.symbols());
+
+                    for(unsigned j(syms.length()); j-- > 0; ) {
+                        if(syms.at(j).is_terminal()) {
+                            break;
+                        }
+
+                        rederived.insert(variable_type(syms.at(j)));
+
+                        if(!was_or_is_nullable(nullable, syms.at(j).number())) {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if(rederived.size() > max_rederived) {
+                return false;
+            }
+
+            // empty them and derive them again
+            DependencyGraph graph;
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                TerminalSet &var_follow(follow[rederived[i].number()]);
+                var_follow.reset(var_follow.size());
+                graph.add_node(rederived[i].number());
+            }
+
+            if(cfg.has_start_variable()) {
+                const unsigned start(cfg.get_start_variable().number());
+                if(rederived.contains(start)) {
+                    follow[start].insert(cfg.num_terminals() + 1U);
+                }
+            }
+
+            for(unsigned i(0); i < rederived.size(); ++i) {
+                X = rederived[i];
+                for(productions_using_X.rewind();
+                    productions_using_X.match_next(); ) {
+                    add_follow(
+                        V, P.symbols(), nullable, first, follow,
+                        &rederived, &graph, 0
+                    );
+                }
+            }
+
+            graph.close(follow);
+
+            // add in what the added productions, newly nullable variables,
+            // and larger FIRST sets add, and push it to the variables that
+            // are at the ends of the productions of the sets that grew
+            std::vector<variable_type> work_list;
+
+            for(unsigned i(0); i < added.size(); ++i) {
+                add_follow(
+                    added[i].variable(), added[i].symbols(), nullable, first,
+                    follow, 0, 0, &work_list
+                );
+            }
+
+            for(unsigned k(0); k < 2U; ++k) {
+                const VariableSet &grown(0 == k ? gained_nullable : first_grown);
+                for(unsigned i(0); i < grown.size(); ++i) {
+                    X = grown[i];
+                    for(productions_using_X.rewind();
+                        productions_using_X.match_next(); ) {
+                        add_follow(
+                            V, P.symbols(), nullable, first, follow,
+                            0, 0, &work_list
+                        );
+                    }
+                }
+            }
+
+            for(; !work_list.empty(); ) {
+                X = work_list.back();
+                work_list.pop_back();
+
+                const TerminalSet &var_follow(follow[X.number()]);
+
+                for(productions_of_X.rewind(); productions_of_X.match_next(); ) {
+                    const symbol_string_type syms(P.symbols());
+
+                    for(unsigned j(syms.length()); j-- > 0; ) {
+                        if(syms.at(j).is_terminal()) {
+                            break;
+                        }
+
+                        const unsigned sym_var(syms.at(j).number());
+                        if(sym_var != X.number()
+                        && follow[sym_var].insert_all(var_follow)) {
+                            work_list.push_back(variable_type(syms.at(j)));
+                        }
+
+                        if(!nullable[sym_var]) {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            return true;
+        }
+    };
+
+}}
+
+#endif /* FLTL_ANALYSIS_UPDATE_HPP_ */
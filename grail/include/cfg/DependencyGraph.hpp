@@ -0,0 +1,326 @@
+/*
+ * DependencyGraph.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_DEPENDENCY_GRAPH_HPP_
+#define FLTL_DEPENDENCY_GRAPH_HPP_
+
+#include <vector>
+#include <utility>
+
+#include "grail/include/cfg/TerminalSet.hpp"
+
+namespace grail { namespace cfg {
+
+    /// graph of which sets of a set-valued analysis (e.g. the FIRST sets)
+    /// must include which other sets. an edge from A to B means that the
+    /// set of A includes the set of B.
+    ///
+    /// the sets are closed under the edges by going over the strongly
+    /// connected components of the graph in topological order, so that the
+    /// sets that a component depends on are final before the component is
+    /// visited. only the components with cycles need a worklist.
+    class DependencyGraph {
+    private:
+
+        enum {
+            UNVISITED = ~0U
+        };
+
+        /// nodes in the order that they were added
+        std::vector<unsigned> nodes;
+
+        /// edges as (from, to) pairs, until they are indexed
+        std::vector<std::pair<unsigned, unsigned> > edge_list;
+
+        /// the edges leaving each node are in
+        /// [edges[edge_offsets[n]], edges[edge_offsets[n + 1]]), and the
+        /// same for the edges entering each node
+        std::vector<unsigned> edge_offsets;
+        std::vector<unsigned> edges;
+        std::vector<unsigned> reverse_edge_offsets;
+        std::vector<unsigned> reverse_edges;
+
+        /// the component of each node, and the nodes of each component
+        /// in [component_offsets[c], component_offsets[c + 1]) of
+        /// component_nodes. components are numbered in topological
+        /// order, so a component only has edges to components with
+        /// smaller numbers.
+        std::vector<unsigned> component_of;
+        std::vector<unsigned> component_offsets;
+        std::vector<unsigned> component_nodes;
+
+        unsigned largest_component_;
+
+        /// index the edges leaving or entering each node
+        static void index_edges(
+            const unsigned num_nodes,
+            const std::vector<std::pair<unsigned, unsigned> > &edge_list,
+            const bool reverse,
+            std::vector<unsigned> &offsets,
+            std::vector<unsigned> &targets
+        ) throw() {
+            offsets.assign(num_nodes + 1U, 0U);
+            targets.resize(edge_list.size());
+
+            for(size_t i(0); i < edge_list.size(); ++i) {
+                ++(offsets[
+                    (reverse ? edge_list[i].second : edge_list[i].first) + 1U
+                ]);
+            }
+
+            for(unsigned n(0); n < num_nodes; ++n) {
+                offsets[n + 1U] += offsets[n];
+            }
+
+            std::vector<unsigned> next(offsets.begin(), offsets.end() - 1);
+            for(size_t i(0); i < edge_list.size(); ++i) {
+                const unsigned from(
+                    reverse ? edge_list[i].second : edge_list[i].first
+                );
+                targets[next[from]++] = (
+                    reverse ? edge_list[i].first : edge_list[i].second
+                );
+            }
+        }
+
+        /// find the strongly connected components with Tarjan's algorithm,
+        /// using an explicit stack so that long chains of dependencies
+        /// don't overflow the call stack
+        void find_components(const unsigned num_nodes) throw() {
+            std::vector<unsigned> index(num_nodes, UNVISITED);
+            std::vector<unsigned> low_link(num_nodes, 0U);
+            std::vector<bool> on_stack(num_nodes, false);
+            std::vector<unsigned> stack;
+
+            // (node, offset of its next edge to visit)
+            std::vector<std::pair<unsigned, unsigned> > calls;
+
+            unsigned next_index(0);
+
+            component_of.assign(num_nodes, UNVISITED);
+            component_offsets.assign(1U, 0U);
+            component_nodes.clear();
+            largest_component_ = 0;
+
+            for(size_t i(0); i < nodes.size(); ++i) {
+                if(UNVISITED != index[nodes[i]]) {
+                    continue;
+                }
+
+                const unsigned root(nodes[i]);
+                calls.push_back(std::make_pair(root, edge_offsets[root]));
+                index[root] = low_link[root] = next_index++;
+                stack.push_back(root);
+                on_stack[root] = true;
+
+                for(; !calls.empty(); ) {
+                    const unsigned node(calls.back().first);
+                    unsigned &edge(calls.back().second);
+
+                    // visit the next neighbour
+                    if(edge < edge_offsets[node + 1U]) {
+                        const unsigned next(edges[edge++]);
+
+                        if(UNVISITED == index[next]) {
+                            calls.push_back(
+                                std::make_pair(next, edge_offsets[next])
+                            );
+                            index[next] = low_link[next] = next_index++;
+                            stack.push_back(next);
+                            on_stack[next] = true;
+
+                        } else if(on_stack[next]
+                               && index[next] < low_link[node]) {
+                            low_link[node] = index[next];
+                        }
+
+                        continue;
+                    }
+
+                    // done with the node; it might be the root of a
+                    // component
+                    calls.pop_back();
+
+                    if(low_link[node] == index[node]) {
+                        const unsigned component(static_cast<unsigned>(
+                            component_offsets.size() - 1U
+                        ));
+
+                        for(unsigned member(UNVISITED); member != node; ) {
+                            member = stack.back();
+                            stack.pop_back();
+                            on_stack[member] = false;
+                            component_of[member] = component;
+                            component_nodes.push_back(member);
+                        }
+
+                        component_offsets.push_back(static_cast<unsigned>(
+                            component_nodes.size()
+                        ));
+
+                        const unsigned size(
+                            component_offsets[component + 1U]
+                            - component_offsets[component]
+                        );
+                        if(size > largest_component_) {
+                            largest_component_ = size;
+                        }
+                    }
+
+                    if(!calls.empty()) {
+                        const unsigned caller(calls.back().first);
+                        if(low_link[node] < low_link[caller]) {
+                            low_link[caller] = low_link[node];
+                        }
+                    }
+                }
+            }
+        }
+
+    public:
+
+        DependencyGraph(void) throw()
+            : nodes()
+            , edge_list()
+            , edge_offsets()
+            , edges()
+            , reverse_edge_offsets()
+            , reverse_edges()
+            , component_of()
+            , component_offsets(1U, 0U)
+            , component_nodes()
+            , largest_component_(0)
+        { }
+
+        inline void add_node(const unsigned node) throw() {
+            nodes.push_back(node);
+        }
+
+        /// the set of `from` includes the set of `to`; both must have
+        /// been added as nodes
+        inline void add_edge(const unsigned from, const unsigned to) throw() {
+            edge_list.push_back(std::make_pair(from, to));
+        }
+
+        /// make every set include the sets of the nodes that it has edges
+        /// to. sets is indexed by node.
+        void close(std::vector<TerminalSet> &sets) throw() {
+            const unsigned num_nodes(static_cast<unsigned>(sets.size()));
+
+            index_edges(num_nodes, edge_list, false, edge_offsets, edges);
+            index_edges(
+                num_nodes, edge_list, true,
+                reverse_edge_offsets, reverse_edges
+            );
+            edge_list.clear();
+
+            find_components(num_nodes);
+
+            std::vector<unsigned> work_list;
+            std::vector<bool> in_work_list(num_nodes, false);
+
+            for(unsigned c(0); c < num_components(); ++c) {
+                const unsigned *begin(&(component_nodes[component_offsets[c]]));
+                const unsigned *end(begin + (
+                    component_offsets[c + 1U] - component_offsets[c]
+                ));
+
+                // the sets of earlier components are final
+                for(const unsigned *node(begin); node != end; ++node) {
+                    for(unsigned e(edge_offsets[*node]);
+                        e < edge_offsets[*node + 1U];
+                        ++e) {
+
+                        if(c != component_of[edges[e]]) {
+                            sets[*node].insert_all(sets[edges[e]]);
+                        }
+                    }
+                }
+
+                // a single node is only its own dependency
+                if(1 == (end - begin)) {
+                    continue;
+                }
+
+                for(const unsigned *node(begin); node != end; ++node) {
+                    work_list.push_back(*node);
+                    in_work_list[*node] = true;
+                }
+
+                // propagate within the component until nothing changes
+                for(; !work_list.empty(); ) {
+                    const unsigned node(work_list.back());
+                    work_list.pop_back();
+                    in_work_list[node] = false;
+
+                    bool updated(false);
+                    for(unsigned e(edge_offsets[node]);
+                        e < edge_offsets[node + 1U];
+                        ++e) {
+
+                        if(c == component_of[edges[e]]) {
+                            updated = sets[node].insert_all(sets[edges[e]])
+                                   || updated;
+                        }
+                    }
+
+                    if(!updated) {
+                        continue;
+                    }
+
+                    // the nodes that depend on this one need another look
+                    for(unsigned e(reverse_edge_offsets[node]);
+                        e < reverse_edge_offsets[node + 1U];
+                        ++e) {
+
+                        const unsigned dependent(reverse_edges[e]);
+                        if(c == component_of[dependent]
+                        && !in_work_list[dependent]) {
+                            work_list.push_back(dependent);
+                            in_work_list[dependent] = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        /// the number of strongly connected components, after close
+        inline unsigned num_components(void) const throw() {
+            return static_cast<unsigned>(component_offsets.size() - 1U);
+        }
+
+        /// the number of nodes in the largest strongly connected
+        /// component, after close
+        inline unsigned largest_component(void) const throw() {
+            return largest_component_;
+        }
+    };
+
+}}
+
+#endif /* FLTL_DEPENDENCY_GRAPH_HPP_ */
@@ -0,0 +1,265 @@
+/*
+ * DottedRuleTable.hpp
+ *
+ *  Created on: May 21, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_DOTTED_RULE_TABLE_HPP_
+#define FLTL_DOTTED_RULE_TABLE_HPP_
+
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+namespace grail { namespace cfg {
+
+    /// a flat table of every dotted rule (A --> alpha * beta) of a grammar,
+    /// used by parsers so that they don't need to pattern match productions
+    /// to find out what to do with an item.
+    ///
+    /// the table is augmented with a start rule S' --> * S, where S is the
+    /// start variable, and so the grammar itself never needs to be changed.
+    template <typename AlphaT>
+    class DottedRuleTable {
+    public:
+
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        /// what a parser should do with an item using a dotted rule
+        enum {
+            PREDICT,    // A --> alpha * B beta
+            SCAN,       // A --> alpha * a beta
+            COMPLETE    // A --> alpha *
+        };
+
+        /// the start and accepting rules of the augmented grammar
+        enum {
+            START_RULE = 0U,
+            ACCEPT_RULE = 1U
+        };
+
+        /// a dotted rule A --> alpha * X beta
+        class dotted_rule_type {
+        public:
+
+            // X; meaningless if this rule is complete
+            symbol_type next_symbol;
+
+            // one of PREDICT, SCAN, or COMPLETE
+            unsigned kind;
+
+            // the number of the variable A, or 0 for the augmented start
+            // variable
+            unsigned lhs;
+
+            // the dotted rule A --> alpha X * beta, or this rule if it is
+            // complete
+            unsigned successor;
+
+            // position of the dot in the production
+            unsigned dot;
+
+            // offset of the production in the table's productions
+            unsigned production;
+
+            dotted_rule_type(void)
+                : next_symbol()
+                , kind(COMPLETE)
+                , lhs(0)
+                , successor(0)
+                , dot(0)
+                , production(0)
+            { }
+        };
+
+    private:
+
+        /// all dotted rules
+        std::vector<dotted_rule_type> rules;
+
+        /// the productions of the grammar. the production at offset 0 is
+        /// invalid as it stands in for the augmented start production
+        std::vector<production_type> productions;
+
+        /// the initial dotted rules of the productions of each variable.
+        /// the rules of variable V are stored in
+        /// predictions[prediction_begin[V] ... prediction_begin[V + 1]).
+        std::vector<unsigned> prediction_begin;
+        std::vector<unsigned> predictions;
+
+        void add_rules(
+            const unsigned lhs,
+            const unsigned production,
+            const symbol_string_type &syms
+        ) throw() {
+            const unsigned len(syms.length());
+            unsigned id(static_cast<unsigned>(rules.size()));
+
+            for(unsigned dot(0); dot <= len; ++dot, ++id) {
+                dotted_rule_type rule;
+
+                rule.lhs = lhs;
+                rule.dot = dot;
+                rule.production = production;
+
+                if(dot == len) {
+                    rule.kind = COMPLETE;
+                    rule.successor = id;
+                } else {
+                    rule.next_symbol = syms.at(dot);
+                    rule.kind = rule.next_symbol.is_variable() ? PREDICT : SCAN;
+                    rule.successor = id + 1U;
+                }
+
+                rules.push_back(rule);
+            }
+        }
+
+    public:
+
+        DottedRuleTable(void) throw()
+            : rules()
+            , productions()
+            , prediction_begin()
+            , predictions()
+        { }
+
+        /// build the table for a grammar. the grammar must have a start
+        /// variable.
+        void compile(const CFG &cfg) throw() {
+
+            const unsigned num_vars(cfg.num_variables_capacity() + 1U);
+
+            rules.clear();
+            productions.clear();
+            predictions.clear();
+            prediction_begin.assign(num_vars + 1U, 0U);
+
+            // S' --> * S and S' --> S *
+            dotted_rule_type start_rule;
+            start_rule.next_symbol = cfg.get_start_variable();
+            start_rule.kind = PREDICT;
+            start_rule.successor = ACCEPT_RULE;
+            rules.push_back(start_rule);
+
+            dotted_rule_type accept_rule;
+            accept_rule.dot = 1U;
+            accept_rule.successor = ACCEPT_RULE;
+            rules.push_back(accept_rule);
+
+            productions.push_back(production_type());
+
+            variable_type V;
+            production_type prod;
+            generator_type variables(cfg.search(~V));
+            generator_type related(cfg.search(~prod, V --->* cfg.__));
+
+            std::vector<unsigned> initial_rules;
+            std::vector<unsigned> initial_rules_begin(num_vars + 1U, 0U);
+
+            for(; variables.match_next(); ) {
+                initial_rules_begin[V.number()] = static_cast<unsigned>(
+                    initial_rules.size()
+                );
+
+                for(related.rewind(); related.match_next(); ) {
+                    initial_rules.push_back(
+                        static_cast<unsigned>(rules.size())
+                    );
+                    add_rules(
+                        V.number(),
+                        static_cast<unsigned>(productions.size()),
+                        prod.symbols()
+                    );
+                    productions.push_back(prod);
+                }
+
+                prediction_begin[V.number() + 1U] = static_cast<unsigned>(
+                    initial_rules.size() - initial_rules_begin[V.number()]
+                );
+            }
+
+            // turn the per-variable counts into offsets, keeping the
+            // variables in numeric order
+            predictions.reserve(initial_rules.size());
+            for(unsigned v(1); v < num_vars; ++v) {
+                const unsigned count(prediction_begin[v + 1U]);
+                prediction_begin[v + 1U] = prediction_begin[v] + count;
+
+                for(unsigned i(0); i < count; ++i) {
+                    predictions.push_back(
+                        initial_rules[initial_rules_begin[v] + i]
+                    );
+                }
+            }
+        }
+
+        /// the number of dotted rules in the table
+        inline unsigned size(void) const throw() {
+            return static_cast<unsigned>(rules.size());
+        }
+
+        /// one more than the highest variable number in the table
+        inline unsigned num_variables(void) const throw() {
+            if(prediction_begin.empty()) {
+                return 0;
+            }
+            return static_cast<unsigned>(prediction_begin.size() - 1U);
+        }
+
+        inline const dotted_rule_type &
+        operator[](const unsigned id) const throw() {
+            return rules[id];
+        }
+
+        /// get the production of a dotted rule; this is invalid for the
+        /// augmented start rules
+        inline const production_type &
+        production(const unsigned id) const throw() {
+            return productions[rules[id].production];
+        }
+
+        /// the initial dotted rules of the productions of a variable
+        inline const unsigned *
+        predictions_begin(const unsigned var) const throw() {
+            if(predictions.empty()) {
+                return 0;
+            }
+            return &(predictions[0]) + prediction_begin[var];
+        }
+
+        inline const unsigned *
+        predictions_end(const unsigned var) const throw() {
+            if(predictions.empty()) {
+                return 0;
+            }
+            return &(predictions[0]) + prediction_begin[var + 1U];
+        }
+    };
+}}
+
+#endif /* FLTL_DOTTED_RULE_TABLE_HPP_ */
@@ -0,0 +1,1074 @@
+/*
+ * EarleyParser.hpp
+ *
+ *  Created on: May 23, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_EARLEYPARSER_HPP_
+#define FLTL_EARLEYPARSER_HPP_
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "fltl/include/helper/BlockAllocator.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+#include "grail/include/cfg/DottedRuleTable.hpp"
+#include "grail/include/cfg/ParseForest.hpp"
+#include "grail/include/cfg/TerminalSet.hpp"
+
+#include "grail/include/io/verbose.hpp"
+
+namespace grail { namespace cfg {
+
+    /// an Earley parser for one grammar. the parser owns the memory for its
+    /// Earley sets and items and keeps it between inputs, so one parser can
+    /// parse many inputs. parsing never changes the grammar, so any number
+    /// of parsers (e.g. one per thread) can share the same grammar, so long
+    /// as nothing else changes the grammar while they use it.
+    template <typename AlphaT>
+    class EarleyParser : private fltl::trait::Uncopyable {
+    public:
+
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef cfg::DottedRuleTable<AlphaT> rule_table_type;
+        typedef typename rule_table_type::dotted_rule_type dotted_rule_type;
+
+        typedef cfg::ParseForest<AlphaT> forest_type;
+        typedef typename forest_type::node_type forest_node_type;
+
+        class earley_item_type;
+        class earley_set_type;
+
+        /// back-pointer from an item A --> alpha X * beta to the item
+        /// A --> alpha * X beta that it was made from, and to the reason
+        /// that the dot could be moved over X.
+        class earley_link_type {
+        public:
+
+            // A --> alpha * X beta
+            earley_item_type *predecessor;
+
+            // the completed item X --> gamma * if X is a variable that was
+            // completed, or null if X is a terminal that was scanned or a
+            // nullable variable that was skipped.
+            earley_item_type *cause;
+
+            // offset of the set containing the predecessor
+            unsigned pivot;
+
+            // order in which links were made
+            unsigned serial;
+
+            earley_link_type *next;
+
+            earley_link_type(void)
+                : predecessor(0)
+                , cause(0)
+                , pivot(0)
+                , serial(0)
+                , next(0)
+            { }
+        };
+
+        /// state of the computation of a Leo item
+        enum {
+            LEO_UNKNOWN,
+            LEO_VISITING,
+            LEO_DONE
+        };
+
+        /// list of all items in a set whose dot is in front of the same
+        /// variable
+        class waiting_list_type {
+        public:
+            unsigned variable;
+            earley_item_type *first;
+            earley_item_type *last;
+
+            // the Leo (transitive) item for this variable in this set. if
+            // leo_set is non-null then completing the variable in this set
+            // leads, through a deterministic chain of completions, to the
+            // item with dotted rule leo_rule and initial set leo_set.
+            unsigned leo_rule;
+            earley_set_type *leo_set;
+            unsigned leo_state;
+
+            waiting_list_type(unsigned var, earley_item_type *item)
+                : variable(var)
+                , first(item)
+                , last(item)
+                , leo_rule(0)
+                , leo_set(0)
+                , leo_state(LEO_UNKNOWN)
+            { }
+
+            bool operator<(const waiting_list_type &that) const throw() {
+                return variable < that.variable;
+            }
+        };
+
+        /// Earley set
+        class earley_set_type {
+        public:
+            // first item in the set
+            earley_item_type *first;
+            earley_item_type *last;
+
+            // next set
+            earley_set_type *next;
+            earley_set_type *prev;
+
+            // offset into the terminal stream
+            unsigned offset;
+
+            // number of items in this set
+            unsigned num_items;
+
+            // items of this set grouped by the variable that they are
+            // waiting on. this is sorted by variable once the set is frozen.
+            std::vector<waiting_list_type> waiting;
+
+            earley_set_type(void)
+                : first(0)
+                , last(0)
+                , next(0)
+                , prev(0)
+                , offset(0)
+                , num_items(0)
+                , waiting()
+            { }
+
+            void push(earley_item_type *item) throw() {
+                if(0 == item) {
+                    return;
+                }
+                if(0 == first) {
+                    first = item;
+                    last = item;
+                } else {
+                    last->next = item;
+                    last = item;
+                }
+
+                item->next = 0;
+                ++num_items;
+            }
+
+            /// find the list of items of a frozen set waiting on a variable
+            waiting_list_type *waiting_on(const unsigned var) throw() {
+                typename std::vector<waiting_list_type>::iterator it(
+                    std::lower_bound(
+                        waiting.begin(),
+                        waiting.end(),
+                        waiting_list_type(var, 0)
+                    )
+                );
+
+                if(it == waiting.end() || var != it->variable) {
+                    return 0;
+                }
+
+                return &*it;
+            }
+
+            void set_next(earley_set_type *set) throw() {
+                set->prev = this;
+                set->next = 0;
+                next = set;
+                set->offset = offset + 1;
+            }
+        };
+
+        /// Earley item
+        class earley_item_type {
+        public:
+            // id of the dotted rule in the rule table
+            unsigned rule;
+
+            // next item in the set
+            earley_item_type *next;
+
+            // the set that first introduced the production being used. that
+            // is, sliding the dot changes the set that owns an item, but not
+            // the set that initiated an item.
+            earley_set_type *initial_set;
+
+            // the next item in the same set that has the same initial
+            // set
+            earley_item_type *next_with_same_initial_set;
+
+            // the next item in the same set whose dot is in front of the
+            // same variable
+            earley_item_type *next_waiting_on_same_variable;
+
+            // back-pointers to the items that this item was made from; only
+            // recorded when building a parse forest
+            earley_link_type *links;
+
+            earley_item_type(void)
+                : rule(0)
+                , next(0)
+                , initial_set(0)
+                , next_with_same_initial_set(0)
+                , next_waiting_on_same_variable(0)
+                , links(0)
+            { }
+
+            void scanned_from(
+                earley_item_type *scan,
+                const dotted_rule_type &scan_rule
+            ) throw() {
+                rule = scan_rule.successor;
+                initial_set = scan->initial_set;
+            }
+
+            void predicted_from(
+                earley_set_type *set,
+                const unsigned initial_rule
+            ) throw() {
+                rule = initial_rule;
+                initial_set = set;
+            }
+        };
+
+    private:
+
+        enum {
+            NUM_BLOCKS = 1024U
+        };
+
+        static void
+        clear_index(std::vector<earley_item_type *> &index) throw() {
+            for(unsigned i(0); i < index.size(); ++i) {
+                index[i] = 0;
+            }
+        }
+
+        /// allocator type for Earley items
+        typedef fltl::helper::BlockAllocator<
+            earley_item_type, NUM_BLOCKS
+        > earley_item_allocator_type;
+
+        /// allocator type for Earley sets
+        typedef fltl::helper::BlockAllocator<
+            earley_set_type, NUM_BLOCKS
+        > earley_set_allocator_type;
+
+        /// allocator type for back-pointers between Earley items
+        typedef fltl::helper::BlockAllocator<
+            earley_link_type, NUM_BLOCKS
+        > earley_link_allocator_type;
+
+        /// the grammar being parsed, which is never changed by the parser
+        const CFG &cfg;
+
+        /// the NULLABLE set and (optionally) the FIRST sets of the grammar
+        const std::vector<bool> &is_nullable;
+        const std::vector<TerminalSet> *first_terminals;
+
+        /// dotted rules of the grammar, augmented with S' --> S
+        rule_table_type rules;
+
+        /// does the grammar have any productions for its start variable?
+        bool has_start_productions;
+
+        /// should Leo's transitive items be used?
+        bool use_leo;
+
+        /// memory for Earley sets, items, and back-pointers; this is kept
+        /// between inputs
+        earley_set_allocator_type set_allocator;
+        earley_item_allocator_type item_allocator;
+        earley_link_allocator_type link_allocator;
+
+        /// per-variable indexes of the waiting lists of the two sets being
+        /// built
+        std::vector<unsigned> waiting_indexes[2];
+
+        /// indexes for the two sets being built to test membership
+        std::vector<earley_item_type *> set_indexes[2];
+
+        /// record how an item was made
+        void add_link(
+            earley_item_type *item,
+            earley_item_type *predecessor,
+            earley_item_type *cause,
+            const unsigned pivot,
+            unsigned &serial
+        ) throw() {
+            earley_link_type *link(link_allocator.allocate());
+            link->predecessor = predecessor;
+            link->cause = cause;
+            link->pivot = pivot;
+            link->serial = serial++;
+            link->next = item->links;
+            item->links = link;
+        }
+
+        /// build the parse forest from the back-pointers of the items,
+        /// starting at the accepting item in the last set
+        void build_forest(
+            forest_type &forest,
+            earley_item_type *accept_item,
+            const unsigned num_tokens
+        ) throw() {
+
+            // items whose links still need to be added to the forest,
+            // along with the offset of their set and their forest node
+            typedef std::pair<earley_item_type *, unsigned> pending_item_type;
+            std::vector<std::pair<pending_item_type, forest_node_type *> >
+                work;
+            std::set<earley_item_type *> seen;
+
+            work.push_back(std::make_pair(
+                std::make_pair(accept_item, num_tokens),
+                static_cast<forest_node_type *>(0)
+            ));
+
+            for(; !work.empty(); ) {
+                earley_item_type *item(work.back().first.first);
+                const unsigned end(work.back().first.second);
+                forest_node_type *node(work.back().second);
+                work.pop_back();
+
+                if(!seen.insert(item).second) {
+                    continue;
+                }
+
+                // predicted epsilon production, i.e. A --> *
+                if(0 == item->links) {
+                    forest.add_packed(node, item->rule, end, 0, 0, 0U);
+                    continue;
+                }
+
+                for(earley_link_type *link(item->links);
+                    0 != link;
+                    link = link->next) {
+
+                    earley_item_type *pred(link->predecessor);
+                    const dotted_rule_type &pred_rule(rules[pred->rule]);
+                    const symbol_type &sym(pred_rule.next_symbol);
+                    forest_node_type *left(0);
+                    forest_node_type *right(0);
+
+                    if(0 != pred_rule.dot) {
+                        left = forest.intermediate_node(
+                            pred->rule,
+                            pred->initial_set->offset,
+                            link->pivot
+                        );
+                        work.push_back(std::make_pair(
+                            std::make_pair(pred, link->pivot),
+                            left
+                        ));
+                    }
+
+                    if(sym.is_terminal()) {
+                        right = forest.terminal_node(sym, link->pivot);
+
+                    // nullable variables only get one derivation of epsilon
+                    } else if(0 == link->cause || link->pivot == end) {
+                        right = forest.null_node(sym, end);
+
+                    } else {
+                        right = forest.symbol_node(sym, link->pivot, end);
+                        work.push_back(std::make_pair(
+                            std::make_pair(link->cause, end),
+                            right
+                        ));
+                    }
+
+                    // the accepting item; its derivation is the root
+                    if(0 == node) {
+                        forest.set_root(right);
+                        continue;
+                    }
+
+                    forest.add_packed(
+                        node,
+                        item->rule,
+                        link->pivot,
+                        left,
+                        right,
+                        link->serial
+                    );
+                }
+            }
+        }
+
+        /// add an item to the list of items of its set that are waiting on
+        /// the variable in front of the item's dot. the waiting index maps
+        /// variable numbers to (1 + the offset of the variable's list) in
+        /// the set being built.
+        void index_waiting(
+            earley_set_type *set,
+            std::vector<unsigned> &waiting_index,
+            earley_item_type *item
+        ) throw() {
+            const dotted_rule_type &rule(rules[item->rule]);
+            if(rule_table_type::PREDICT != rule.kind) {
+                return;
+            }
+
+            const unsigned var(rule.next_symbol.number());
+            const unsigned slot(waiting_index[var]);
+
+            if(0 == slot) {
+                set->waiting.push_back(waiting_list_type(var, item));
+                waiting_index[var] = static_cast<unsigned>(
+                    set->waiting.size()
+                );
+            } else {
+                waiting_list_type &list(set->waiting[slot - 1U]);
+                list.last->next_waiting_on_same_variable = item;
+                list.last = item;
+            }
+        }
+
+        /// find the first item in a set that is still being built that is
+        /// waiting on a variable
+        static earley_item_type *
+        live_waiting_on(
+            earley_set_type *set,
+            std::vector<unsigned> &waiting_index,
+            const unsigned var
+        ) throw() {
+            const unsigned slot(waiting_index[var]);
+            if(0 == slot) {
+                return 0;
+            }
+            return set->waiting[slot - 1U].first;
+        }
+
+        /// freeze a set once no more items will be added to it; this sorts
+        /// its waiting lists and clears out its waiting index
+        static void
+        freeze_waiting(
+            earley_set_type *set,
+            std::vector<unsigned> &waiting_index
+        ) throw() {
+            for(unsigned i(0); i < set->waiting.size(); ++i) {
+                waiting_index[set->waiting[i].variable] = 0;
+            }
+            std::sort(set->waiting.begin(), set->waiting.end());
+        }
+
+        /// compute the Leo item of a list of waiting items in a frozen set.
+        /// if the only item waiting on A in the set is B --> beta * A, then
+        /// completing A in this set completes B --> beta A. if B has a Leo
+        /// item in the initial set of B --> beta * A then that is the Leo
+        /// item of A, otherwise B --> beta A * is.
+        void compute_leo_item(
+            earley_set_type *set,
+            waiting_list_type &list
+        ) throw() {
+            if(LEO_UNKNOWN != list.leo_state) {
+                return;
+            }
+
+            list.leo_state = LEO_VISITING;
+
+            earley_item_type *item(list.first);
+            const unsigned rule_id(rules[item->rule].successor);
+            const dotted_rule_type &rule(rules[rule_id]);
+
+            if(item == list.last && rule_table_type::COMPLETE == rule.kind) {
+
+                list.leo_rule = rule_id;
+                list.leo_set = item->initial_set;
+
+                waiting_list_type *parent(
+                    item->initial_set->waiting_on(rule.lhs)
+                );
+
+                if(0 != parent) {
+
+                    // the parent is in the same set, e.g. B --> * A; make
+                    // sure it has been computed. if it is being computed
+                    // then we've found a cycle of unit productions and we
+                    // stop here.
+                    if(item->initial_set == set) {
+                        compute_leo_item(set, *parent);
+                    }
+
+                    if(LEO_DONE == parent->leo_state && 0 != parent->leo_set) {
+                        list.leo_rule = parent->leo_rule;
+                        list.leo_set = parent->leo_set;
+                    }
+                }
+            }
+
+            list.leo_state = LEO_DONE;
+        }
+
+        /// compute the Leo items of every list of waiting items in a frozen
+        /// set
+        void compute_leo_items(earley_set_type *set) throw() {
+            for(unsigned i(0); i < set->waiting.size(); ++i) {
+                compute_leo_item(set, set->waiting[i]);
+            }
+        }
+
+        /// check the index for the existence of item, if it's in, return 0,
+        /// otherwise return the item and add it to the index
+        earley_item_type *indexed_push(
+            earley_set_type *set,
+            std::vector<earley_item_type *> &index,
+            std::vector<unsigned> &waiting_index,
+            earley_item_type *item
+        ) throw() {
+
+            const unsigned offset(item->initial_set->offset);
+            earley_item_type *prev(0);
+
+            for(earley_item_type *curr(index[offset]);
+                0 != curr;
+                prev = curr, curr = curr->next_with_same_initial_set) {
+
+                // found an insertion point
+                if(item->rule < curr->rule) {
+                    item->next_with_same_initial_set = curr;
+
+                    if(0 == prev) {
+                        index[offset] = item;
+                    } else {
+                        prev->next_with_same_initial_set = item;
+                    }
+
+                    set->push(item);
+                    index_waiting(set, waiting_index, item);
+                    return item;
+
+                // skip
+                } else if(item->rule > curr->rule) {
+                    continue;
+
+                // same dotted rule
+                } else {
+                    item_allocator.deallocate(item);
+                    return curr;
+                }
+            }
+
+            // the set was empty
+            if(0 == prev) {
+                index[offset] = item;
+
+            // this item is going at the end
+            } else {
+                prev->next_with_same_initial_set = item;
+            }
+
+            set->push(item);
+            index_waiting(set, waiting_index, item);
+            return item;
+        }
+
+    public:
+
+        /// make a parser for a grammar. is_nullable must be the NULLABLE
+        /// set of the grammar. if first_terminals is non-null then it must
+        /// be the FIRST sets of the grammar, and they are used to skip
+        /// useless predictions.
+        EarleyParser(
+            const CFG &cfg_,
+            const std::vector<bool> &is_nullable_,
+            const std::vector<TerminalSet> *first_terminals_
+        ) throw()
+            : cfg(cfg_)
+            , is_nullable(is_nullable_)
+            , first_terminals(first_terminals_)
+            , rules()
+            , has_start_productions(false)
+            , use_leo(false)
+            , set_allocator()
+            , item_allocator()
+            , link_allocator()
+        {
+            if(0 == cfg.num_productions() || !cfg.has_start_variable()) {
+                return;
+            }
+
+            // compile the grammar into a table of dotted rules. the table
+            // is augmented with S' --> S, where S is the start variable, so
+            // the grammar itself doesn't need to be changed.
+            rules.compile(cfg);
+
+            const unsigned start(cfg.get_start_variable().number());
+            has_start_productions = (
+                rules.predictions_begin(start) != rules.predictions_end(start)
+            );
+        }
+
+        /// make sure that at least num_items Earley items can be made
+        /// without asking for more memory
+        void reserve(const unsigned num_items) throw() {
+            std::vector<earley_item_type *> items(num_items);
+            for(unsigned i(0); i < num_items; ++i) {
+                items[i] = item_allocator.allocate();
+            }
+            for(unsigned i(0); i < num_items; ++i) {
+                item_allocator.deallocate(items[i]);
+            }
+        }
+
+        /// use Leo's transitive items to complete right-recursive rules in
+        /// linear time
+        void set_use_leo(const bool use_leo_) throw() {
+            use_leo = use_leo_;
+        }
+
+        /// parse the tokens of an input. the reader can be anything whose
+        /// read() returns the next token, or an empty token at the end of
+        /// the input. if forest is non-null then the parse forest of the
+        /// input is built into it; Leo items are not used when building a
+        /// forest.
+        template <typename ReaderT>
+        bool parse(ReaderT &reader, forest_type *forest) throw() {
+
+            bool parse_result(false);
+            const char *token(reader.read());
+
+            // the grammar's tables are kept in locals so that they are not
+            // reloaded through this pointer after every change to an item
+            const rule_table_type &table(rules);
+            const std::vector<bool> &nullable(is_nullable);
+            const bool use_first_set(0 != first_terminals);
+
+            // is it worth parsing?
+            if(!has_start_productions) {
+                if(0 == token || '\0' == *token) {
+                    io::verbose("Parsed. Accepted empty language.\n");
+                    return true;
+                } else {
+                    io::verbose("Failed to parse. Language is empty.\n");
+                    return false;
+                }
+            }
+
+            const bool with_forest(0 != forest);
+            const bool use_leo_items(use_leo && !with_forest);
+            unsigned num_links(0);
+
+            if(with_forest) {
+                forest->reset(table);
+            }
+
+            // a failed parse can leave behind the waiting lists of an
+            // unfinished set
+            waiting_indexes[0].assign(table.num_variables(), 0U);
+            waiting_indexes[1].assign(table.num_variables(), 0U);
+
+            // set up the base case for the earley parser
+            earley_item_type *curr_item(item_allocator.allocate());
+            earley_set_type *curr_set(set_allocator.allocate());
+            earley_set_type *prev_set(0);
+
+            earley_item_type *first_item(curr_item);
+            earley_set_type *first_set(curr_set);
+
+            curr_set->next = 0;
+            curr_item->rule = rule_table_type::START_RULE;
+            curr_item->initial_set = curr_set;
+            curr_set->push(first_item);
+            index_waiting(curr_set, waiting_indexes[0], first_item);
+
+            terminal_type a;
+
+            // statistics on how much work the waiting lists save
+            unsigned num_completer_examined(0);
+            unsigned num_completer_skipped(0);
+            unsigned num_predictions_skipped(0);
+            unsigned num_leo_completions(0);
+            unsigned num_items(0);
+            unsigned num_sets(0);
+
+            // terminals
+            unsigned i(0);
+            alphabet_type lexeme;
+            bool solve_for_variable_terminal(false);
+
+            // indexes for the sets to test membership, +1 as there are n+1
+            // sets (S_0 ... S_n) for a string of length n.
+            set_indexes[0].assign(1U, static_cast<earley_item_type *>(0));
+            set_indexes[1].assign(1U, static_cast<earley_item_type *>(0));
+            unsigned curr_index(0U);
+
+            // for each set
+            bool not_at_end(true);
+            earley_set_type *next_set(0);
+            earley_item_type *next_item(0);
+
+            for(;
+                0 != curr_set && not_at_end;
+                prev_set = curr_set,
+                curr_set = curr_set->next,
+                curr_index = 1U - curr_index,
+                ++i, token = reader.read()) {
+
+                set_indexes[curr_index].push_back(0);
+
+                // done the tokens
+                if(0 == token || '\0' == *token) {
+                    not_at_end = false;
+                    io::verbose("    Looking at EOF\n");
+
+                } else {
+
+                    traits_type::unserialize(token, lexeme);
+
+                    // try to get the terminal
+                    solve_for_variable_terminal = !cfg.find_terminal(lexeme, a);
+
+                    // found a token but this grammar has no variable terminals
+                    // and so it can't be substituted for anything
+                    if(solve_for_variable_terminal
+                    && 0 == cfg.num_variable_terminals()) {
+
+                        io::verbose(
+                            "    Unrecognized terminal '%s'.\n",
+                            token
+                        );
+                        goto parse_error;
+                    }
+
+                    io::verbose("    Looking at '%s'...\n", token);
+
+                    if(with_forest) {
+                        forest->add_lexeme(lexeme);
+                    }
+                }
+
+                // for each item
+                curr_item = curr_set->first;
+                for(next_item = 0;
+                    0 != curr_item;
+                    curr_item = curr_item->next) {
+
+                    const dotted_rule_type &rule(table[curr_item->rule]);
+
+                    // the item has the form A --> ... * B ...
+                    if(rule_table_type::PREDICT == rule.kind) {
+
+                        const unsigned B(rule.next_symbol.number());
+
+                        // if B is nullable then add A --> ... B * ... to
+                        // the item set
+                        if(nullable[B]) {
+
+                            next_item = item_allocator.allocate();
+                            next_item->scanned_from(curr_item, rule);
+                            next_item = indexed_push(
+                                curr_set,
+                                set_indexes[curr_index],
+                                waiting_indexes[curr_index],
+                                next_item
+                            );
+
+                            if(with_forest) {
+                                add_link(
+                                    next_item, curr_item, 0,
+                                    curr_set->offset, num_links
+                                );
+                            }
+                        }
+
+                        // only the first item waiting on B needs to predict
+                        // B; every other item would re-add the same items
+                        if(curr_item != live_waiting_on(
+                            curr_set,
+                            waiting_indexes[curr_index],
+                            B
+                        )) {
+                            ++num_predictions_skipped;
+                            continue;
+                        }
+
+                        // if we're using FIRST sets then use them to skip
+                        // useless predictions
+                        if(use_first_set && not_at_end
+                        && !solve_for_variable_terminal
+                        && !((*first_terminals)[B].contains(a.number()))) {
+                            continue;
+                        }
+
+                        // for each B --> alpha, add B --> * alpha to the
+                        // item set
+                        for(const unsigned *initial_rule(table.predictions_begin(B)),
+                                           *last_rule(table.predictions_end(B));
+                            initial_rule != last_rule;
+                            ++initial_rule) {
+
+                            next_item = item_allocator.allocate();
+                            next_item->predicted_from(curr_set, *initial_rule);
+
+                            indexed_push(
+                                curr_set,
+                                set_indexes[curr_index],
+                                waiting_indexes[curr_index],
+                                next_item
+                            );
+                        }
+
+                    // the item has the form A --> ... *
+                    } else if(rule_table_type::COMPLETE == rule.kind) {
+
+                        const unsigned A(rule.lhs);
+                        earley_set_type *initial_set(curr_item->initial_set);
+                        earley_item_type *rel_item(0);
+                        unsigned num_related(0);
+
+                        if(initial_set == curr_set) {
+                            rel_item = live_waiting_on(
+                                curr_set,
+                                waiting_indexes[curr_index],
+                                A
+                            );
+                        } else {
+                            waiting_list_type *list(initial_set->waiting_on(A));
+
+                            // skip the chain of completions through the
+                            // Leo item of A
+                            if(0 != list && 0 != list->leo_set) {
+                                next_item = item_allocator.allocate();
+                                next_item->rule = list->leo_rule;
+                                next_item->initial_set = list->leo_set;
+                                indexed_push(
+                                    curr_set,
+                                    set_indexes[curr_index],
+                                    waiting_indexes[curr_index],
+                                    next_item
+                                );
+
+                                ++num_leo_completions;
+                                num_completer_skipped += initial_set->num_items;
+                                continue;
+
+                            } else if(0 != list) {
+                                rel_item = list->first;
+                            }
+                        }
+
+                        // only look at the items of the initial set of
+                        // this item that are of the form
+                        // C --> ... * A ...
+                        for(; 0 != rel_item;
+                            rel_item = rel_item->next_waiting_on_same_variable) {
+
+                            ++num_related;
+
+                            next_item = item_allocator.allocate();
+                            next_item->scanned_from(
+                                rel_item,
+                                table[rel_item->rule]
+                            );
+                            next_item = indexed_push(
+                                curr_set,
+                                set_indexes[curr_index],
+                                waiting_indexes[curr_index],
+                                next_item
+                            );
+
+                            if(with_forest) {
+                                add_link(
+                                    next_item, rel_item,
+                                    curr_item, initial_set->offset, num_links
+                                );
+                            }
+                        }
+
+                        num_completer_examined += num_related;
+                        num_completer_skipped += initial_set->num_items - num_related;
+
+                    // try to "solve" this terminal
+                    } else if(not_at_end) {
+
+                        // we don't know the terminal of this lexeme, lets
+                        // see if we can substitute a variable terminal
+                        if(solve_for_variable_terminal) {
+
+                            // the item has the form A --> ... * a ... for
+                            // some variable terminal a.
+                            a = rule.next_symbol;
+                            if(!cfg.is_variable_terminal(a)) {
+                                continue;
+                            }
+
+                            io::verbose(
+                                "        Substituting as %s...\n",
+                                cfg.get_name(a)
+                            );
+
+                        // we know the terminal of this lexeme; the item
+                        // has the form A --> ... * a ... where "a" is the
+                        // terminal of the current lexeme.
+                        } else if(a != rule.next_symbol) {
+                            continue;
+                        }
+
+                        next_set = curr_set->next;
+                        if(0 == next_set) {
+                            next_set = set_allocator.allocate();
+                            curr_set->set_next(next_set);
+                            set_indexes[1U - curr_index].push_back(0);
+                            clear_index(set_indexes[1U - curr_index]);
+                        }
+
+                        next_item = item_allocator.allocate();
+                        next_item->scanned_from(curr_item, rule);
+                        next_item = indexed_push(
+                            next_set,
+                            set_indexes[1U - curr_index],
+                            waiting_indexes[1U - curr_index],
+                            next_item
+                        );
+
+                        if(with_forest) {
+                            add_link(
+                                next_item, curr_item, 0,
+                                curr_set->offset, num_links
+                            );
+                        }
+                    }
+                }
+
+                // no more items will be added to this set
+                freeze_waiting(curr_set, waiting_indexes[curr_index]);
+                if(use_leo_items) {
+                    compute_leo_items(curr_set);
+                }
+            }
+
+            if(0 != token && '\0' == *token) {
+
+                // handle the case where we accept the empty string
+                if(0 == curr_set) {
+                    curr_set = prev_set;
+                }
+
+                if(0 == curr_set || not_at_end) {
+                    goto parse_error;
+                }
+
+                // go look for the final production
+                for(curr_item = curr_set->first;
+                    0 != curr_item;
+                    curr_item = curr_item->next) {
+
+                    if(rule_table_type::ACCEPT_RULE == curr_item->rule
+                    && first_set == curr_item->initial_set) {
+                        io::verbose("Successfully parsed.\n");
+                        parse_result = true;
+
+                        if(with_forest) {
+                            io::verbose("Building parse forest...\n");
+                            build_forest(*forest, curr_item, curr_set->offset);
+                            io::verbose(
+                                "Parse forest has %u nodes.\n",
+                                forest->num_nodes()
+                            );
+                        }
+
+                        goto done;
+                    }
+                }
+            }
+
+        parse_error:
+
+            parse_result = false;
+            io::verbose("Failed to parse all input.\n");
+
+        done:
+
+            io::verbose(
+                "Completer examined %u items and skipped %u candidate items.\n",
+                num_completer_examined,
+                num_completer_skipped
+            );
+            io::verbose(
+                "Predictor skipped %u redundant predictions.\n",
+                num_predictions_skipped
+            );
+
+            if(use_leo_items) {
+                io::verbose(
+                    "Leo items short-circuited %u completions.\n",
+                    num_leo_completions
+                );
+            }
+
+            io::verbose("Cleaning up Earley items/sets...\n");
+
+            next_set = 0;
+            num_items = 0;
+            num_sets = 0;
+            for(curr_set = first_set; 0 != curr_set; curr_set = next_set) {
+                next_set = curr_set->next;
+                num_items += curr_set->num_items;
+                ++num_sets;
+
+                for(curr_item = curr_set->first;
+                    0 != curr_item;
+                    curr_item = next_item) {
+
+                    next_item = curr_item->next;
+
+                    earley_link_type *next_link(0);
+                    for(earley_link_type *link(curr_item->links);
+                        0 != link;
+                        link = next_link) {
+                        next_link = link->next;
+                        link_allocator.deallocate(link);
+                    }
+
+                    item_allocator.deallocate(curr_item);
+                }
+
+                set_allocator.deallocate(curr_set);
+            }
+
+            io::verbose(
+                "Used %u Earley items in %u Earley sets.\n",
+                num_items,
+                num_sets
+            );
+
+            io::verbose("Done.\n");
+
+            return parse_result;
+        }
+    };
+}}
+
+#endif /* FLTL_EARLEYPARSER_HPP_ */
@@ -0,0 +1,297 @@
+/*
+ * GrammarAnalyses.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_GRAMMAR_ANALYSES_HPP_
+#define FLTL_GRAMMAR_ANALYSES_HPP_
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/cfg/AnalysisUpdate.hpp"
+#include "grail/include/cfg/TerminalSet.hpp"
+#include "grail/include/cfg/compute_first_set.hpp"
+#include "grail/include/cfg/compute_follow_set.hpp"
+#include "grail/include/cfg/compute_null_set.hpp"
+
+namespace grail { namespace cfg {
+
+    /// the NULL, FIRST, and FOLLOW sets of a grammar, kept as the analysis
+    /// cache of the grammar by nullable, first, and follow below. each
+    /// result remembers the modification epoch of the grammar that it was
+    /// computed at, and is only recomputed once the grammar has changed.
+    ///
+    /// if only productions were added or removed since the sets were
+    /// computed, then the sets are brought up to date (see AnalysisUpdate)
+    /// instead of being computed again.
+    ///
+    /// Note: - nothing else may set the analysis cache of a grammar that
+    ///         is used with these functions.
+    template <typename AlphaT>
+    class GrammarAnalyses : public fltl::cfg::AnalysisCache<AlphaT> {
+    private:
+
+        typedef typename fltl::CFG<AlphaT>::production_type production_type;
+
+        enum {
+
+            /// the most changes to productions that are remembered before
+            /// it's assumed to be cheaper to compute the sets again
+            MAX_CHANGES = 1024U
+        };
+
+        template <typename A>
+        friend GrammarAnalyses<A> &analyses_of(const fltl::CFG<A> &) throw();
+
+        template <typename A>
+        friend const std::vector<bool> &nullable(const fltl::CFG<A> &) throw();
+
+        template <typename A>
+        friend const std::vector<TerminalSet> &
+        first(const fltl::CFG<A> &) throw();
+
+        template <typename A>
+        friend const std::vector<TerminalSet> &
+        follow(const fltl::CFG<A> &) throw();
+
+        /// the grammar as of grammar_epoch
+        fltl::cfg::FrozenGrammar<AlphaT> grammar;
+
+        std::vector<bool> nullable_set;
+        std::vector<TerminalSet> first_set;
+        std::vector<TerminalSet> follow_set;
+
+        /// the modification epoch of the grammar when each of the above
+        /// was computed or last brought up to date
+        uint64_t grammar_epoch;
+        uint64_t nullable_epoch;
+        uint64_t first_epoch;
+        uint64_t follow_epoch;
+
+        /// whether each of the above has been computed at all
+        bool has_grammar;
+        bool has_nullable;
+        bool has_first;
+        bool has_follow;
+
+        /// the grammar that owns this cache
+        const fltl::CFG<AlphaT> &cfg;
+
+        /// the number of times that each production was added, less the
+        /// number of times that it was removed, since changes_epoch
+        std::map<production_type, int> changes;
+        unsigned num_changes;
+        uint64_t changes_epoch;
+
+        /// remember a change to a production, as long as the grammar
+        /// hasn't otherwise changed since changes_epoch
+        void change_production(const production_type &prod, int change) throw() {
+            if(MAX_CHANGES < num_changes) {
+                return;
+            }
+
+            // the epoch has already changed for this change
+            if(changes_epoch + num_changes + 1U != cfg.modification_epoch()
+            || MAX_CHANGES == num_changes) {
+                num_changes = MAX_CHANGES + 1U;
+                changes.clear();
+                return;
+            }
+
+            ++num_changes;
+            int &count(changes[prod]);
+            count += change;
+            if(0 == count) {
+                changes.erase(prod);
+            }
+        }
+
+        /// bring the sets that have been computed up to date with the
+        /// changes to the productions since changes_epoch. the sets that
+        /// can't be brought up to date are computed again when they are
+        /// next asked for.
+        void update(void) throw() {
+            const uint64_t epoch(cfg.modification_epoch());
+            if(changes_epoch == epoch) {
+                return;
+            }
+
+            if(num_changes <= MAX_CHANGES
+            && changes_epoch + num_changes == epoch
+            && has_nullable && nullable_epoch == changes_epoch) {
+
+                AnalysisUpdate<AlphaT> updater(
+                    cfg, changes, cfg.num_variables() / 4U
+                );
+
+                if(updater.update_null_set(nullable_set)) {
+                    nullable_epoch = epoch;
+
+                    if(has_first && first_epoch == changes_epoch
+                    && updater.update_first_set(nullable_set, first_set)) {
+                        first_epoch = epoch;
+
+                        if(has_follow && follow_epoch == changes_epoch
+                        && updater.update_follow_set(
+                            nullable_set, first_set, follow_set)) {
+                            follow_epoch = epoch;
+                        }
+                    }
+                }
+            }
+
+            changes.clear();
+            num_changes = 0;
+            changes_epoch = epoch;
+        }
+
+        /// get the frozen grammar as of the current epoch of the grammar
+        const fltl::cfg::FrozenGrammar<AlphaT> &frozen(void) throw() {
+            if(!has_grammar || grammar_epoch != cfg.modification_epoch()) {
+                cfg.freeze(grammar);
+                grammar_epoch = cfg.modification_epoch();
+                has_grammar = true;
+            }
+            return grammar;
+        }
+
+    public:
+
+        explicit GrammarAnalyses(const fltl::CFG<AlphaT> &cfg_) throw()
+            : fltl::cfg::AnalysisCache<AlphaT>()
+            , grammar()
+            , nullable_set()
+            , first_set()
+            , follow_set()
+            , grammar_epoch(0)
+            , nullable_epoch(0)
+            , first_epoch(0)
+            , follow_epoch(0)
+            , has_grammar(false)
+            , has_nullable(false)
+            , has_first(false)
+            , has_follow(false)
+            , cfg(cfg_)
+            , changes()
+            , num_changes(0)
+            , changes_epoch(cfg_.modification_epoch())
+        { }
+
+        virtual ~GrammarAnalyses(void) throw() { }
+
+        virtual void added_production(const production_type &prod) throw() {
+            change_production(prod, 1);
+        }
+
+        virtual void removed_production(const production_type &prod) throw() {
+            change_production(prod, -1);
+        }
+    };
+
+    /// get the analyses kept along with a grammar, adding them if they
+    /// aren't there yet, and bring them up to date with the grammar
+    template <typename AlphaT>
+    GrammarAnalyses<AlphaT> &analyses_of(const fltl::CFG<AlphaT> &cfg) throw() {
+        fltl::cfg::AnalysisCache<AlphaT> *cache(cfg.get_analysis_cache());
+        if(0 == cache) {
+            cache = new GrammarAnalyses<AlphaT>(cfg);
+            cfg.set_analysis_cache(cache);
+        }
+
+        GrammarAnalyses<AlphaT> &analyses(
+            *static_cast<GrammarAnalyses<AlphaT> *>(cache)
+        );
+        analyses.update();
+        return analyses;
+    }
+
+    /// the NULL set of a grammar, indexed by variable number. the set is
+    /// only recomputed or brought up to date if the grammar has changed
+    /// since it was last asked for. the returned reference is good for as
+    /// long as the grammar, but the set changes when it is next asked for
+    /// after the grammar changes.
+    template <typename AlphaT>
+    const std::vector<bool> &nullable(const fltl::CFG<AlphaT> &cfg) throw() {
+        GrammarAnalyses<AlphaT> &analyses(analyses_of(cfg));
+        const uint64_t epoch(cfg.modification_epoch());
+
+        if(!analyses.has_nullable || analyses.nullable_epoch != epoch) {
+            compute_null_set(analyses.frozen(), analyses.nullable_set);
+            analyses.nullable_epoch = epoch;
+            analyses.has_nullable = true;
+        }
+
+        return analyses.nullable_set;
+    }
+
+    /// the FIRST sets of terminals of a grammar, indexed by variable
+    /// number. see nullable for when they are recomputed.
+    template <typename AlphaT>
+    const std::vector<TerminalSet> &first(const fltl::CFG<AlphaT> &cfg) throw() {
+        const std::vector<bool> &null_set(nullable(cfg));
+        GrammarAnalyses<AlphaT> &analyses(analyses_of(cfg));
+        const uint64_t epoch(cfg.modification_epoch());
+
+        if(!analyses.has_first || analyses.first_epoch != epoch) {
+            compute_first_terminals(
+                analyses.frozen(), null_set, analyses.first_set
+            );
+            analyses.first_epoch = epoch;
+            analyses.has_first = true;
+        }
+
+        return analyses.first_set;
+    }
+
+    /// the FOLLOW sets of a grammar, indexed by variable number. the end
+    /// of the input is the terminal number one past the last terminal.
+    /// see nullable for when they are recomputed.
+    template <typename AlphaT>
+    const std::vector<TerminalSet> &follow(const fltl::CFG<AlphaT> &cfg) throw() {
+        const std::vector<bool> &null_set(nullable(cfg));
+        const std::vector<TerminalSet> &first_set(first(cfg));
+        GrammarAnalyses<AlphaT> &analyses(analyses_of(cfg));
+        const uint64_t epoch(cfg.modification_epoch());
+
+        if(!analyses.has_follow || analyses.follow_epoch != epoch) {
+            compute_follow_set(
+                analyses.frozen(), null_set, first_set,
+                analyses.follow_set
+            );
+            analyses.follow_epoch = epoch;
+            analyses.has_follow = true;
+        }
+
+        return analyses.follow_set;
+    }
+
+}}
+
+#endif /* FLTL_GRAMMAR_ANALYSES_HPP_ */
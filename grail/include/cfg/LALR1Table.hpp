@@ -0,0 +1,816 @@
+/*
+ * LALR1Table.hpp
+ *
+ *  Created on: May 27, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_LALR1_TABLE_HPP_
+#define FLTL_LALR1_TABLE_HPP_
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/cfg/DottedRuleTable.hpp"
+
+namespace grail { namespace cfg {
+
+    /// the LR(0) automaton of a grammar and its LALR(1) action and goto
+    /// tables. lookaheads are computed with DeRemer and Pennello's
+    /// relations (reads, includes, and lookback) over the nonterminal
+    /// transitions of the automaton.
+    ///
+    /// the tables are stored by row displacement, with one default
+    /// reduction per state, so that they stay small for grammars with
+    /// thousands of states. columns of the action table are like those of
+    /// LL1Table: column 0 is any token that isn't a terminal of the
+    /// grammar, columns 1 to T are the terminals of the grammar, and column
+    /// T + 1 is the end of the input.
+    ///
+    /// conflicts are resolved in favour of shifting, and then in favour of
+    /// the production that comes first, and are remembered for reporting.
+    template <typename AlphaT>
+    class LALR1Table {
+    public:
+
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef DottedRuleTable<AlphaT> rule_table_type;
+        typedef typename rule_table_type::dotted_rule_type dotted_rule_type;
+
+        /// actions are stored as (argument << ACTION_BITS) | kind, where the
+        /// argument of a shift is the next state, and the argument of a
+        /// reduction is the complete dotted rule of its production
+        enum {
+            ERROR_ACTION = 0U,
+            SHIFT_ACTION = 1U,
+            REDUCE_ACTION = 2U,
+            ACCEPT_ACTION = 3U,
+            ACTION_BITS = 2U,
+            ACTION_MASK = 3U
+        };
+
+        enum {
+            NO_STATE = ~0U,
+            UNKNOWN_TOKEN = 0U
+        };
+
+        /// two actions wanted by the same cell of the action table
+        class conflict_type {
+        public:
+
+            unsigned state;
+            unsigned column;
+
+            // the action that was kept
+            unsigned chosen;
+
+            // the action that was dropped
+            unsigned dropped;
+        };
+
+    private:
+
+        typedef uint64_t word_type;
+
+        enum {
+            WORD_BITS = 64U,
+            NO_ROW = ~0U
+        };
+
+        /// a sparse table stored by row displacement: the entry for
+        /// (row, column) is at entries[base[row] + column] if check says
+        /// that the entry belongs to the row.
+        class packed_table_type {
+        public:
+
+            typedef std::vector<std::pair<unsigned, unsigned> > row_type;
+
+            std::vector<unsigned> base;
+            std::vector<unsigned> entries;
+            std::vector<unsigned> check;
+
+            /// pack rows of (column, value) pairs, sorted by column
+            void pack(
+                const std::vector<row_type> &rows,
+                const unsigned num_columns
+            ) throw() {
+                const unsigned num_rows(static_cast<unsigned>(rows.size()));
+
+                base.assign(num_rows, 0U);
+                entries.clear();
+                check.clear();
+
+                // place the fullest rows first, as they are the hardest to
+                // fit
+                std::vector<std::pair<unsigned, unsigned> > order;
+                for(unsigned r(0); r < num_rows; ++r) {
+                    if(!rows[r].empty()) {
+                        order.push_back(std::make_pair(
+                            ~static_cast<unsigned>(rows[r].size()),
+                            r
+                        ));
+                    }
+                }
+                std::sort(order.begin(), order.end());
+
+                unsigned first_free(0);
+                unsigned max_base(0);
+
+                for(unsigned o(0); o < order.size(); ++o) {
+                    const unsigned r(order[o].second);
+                    const row_type &row(rows[r]);
+
+                    for(; first_free < check.size()
+                       && NO_ROW != check[first_free]; ++first_free) { }
+
+                    unsigned b(0);
+                    if(first_free > row[0].first) {
+                        b = first_free - row[0].first;
+                    }
+
+                    for(;; ++b) {
+                        bool fits(true);
+                        for(unsigned i(0); fits && i < row.size(); ++i) {
+                            const unsigned at(b + row[i].first);
+                            fits = at >= check.size() || NO_ROW == check[at];
+                        }
+                        if(fits) {
+                            break;
+                        }
+                    }
+
+                    base[r] = b;
+                    max_base = std::max(max_base, b);
+
+                    for(unsigned i(0); i < row.size(); ++i) {
+                        const unsigned at(b + row[i].first);
+                        if(at >= check.size()) {
+                            check.resize(at + 1U, NO_ROW);
+                            entries.resize(at + 1U, 0U);
+                        }
+                        check[at] = r;
+                        entries[at] = row[i].second;
+                    }
+                }
+
+                // pad the table so that every lookup is in bounds
+                check.resize(max_base + num_columns, NO_ROW);
+                entries.resize(max_base + num_columns, 0U);
+            }
+
+            inline unsigned get(
+                const unsigned row,
+                const unsigned column,
+                const unsigned default_value
+            ) const throw() {
+                const unsigned at(base[row] + column);
+                return row == check[at] ? entries[at] : default_value;
+            }
+        };
+
+        /// a node of the depth-first search of the digraph algorithm
+        class frame_type {
+        public:
+            unsigned node;
+            unsigned next_edge;
+            unsigned depth;
+
+            frame_type(const unsigned node_, const unsigned depth_)
+                : node(node_)
+                , next_edge(0)
+                , depth(depth_)
+            { }
+        };
+
+        typedef std::vector<std::vector<unsigned> > relation_type;
+
+        /// dotted rules of the grammar
+        rule_table_type rules;
+
+        unsigned num_columns;
+
+        /// is the terminal of a column a variable terminal?
+        std::vector<bool> is_variable_terminal;
+
+        /// the symbol of each variable, by number
+        std::vector<symbol_type> variable_symbols;
+
+        /// the symbol shifted or reduced to enter each state
+        std::vector<symbol_type> accessing_symbols;
+
+        /// the kernel items of each state are the dotted rules
+        /// kernels[kernel_begin[S] ... kernel_begin[S + 1])
+        std::vector<unsigned> kernels;
+        std::vector<unsigned> kernel_begin;
+
+        /// transitions of each state, sorted by symbol key (see key_of)
+        std::vector<int> transition_keys;
+        std::vector<unsigned> transition_targets;
+        std::vector<unsigned> transition_begin;
+
+        /// the default action of each state when a column has no entry
+        std::vector<unsigned> default_actions;
+
+        packed_table_type actions;
+        packed_table_type gotos;
+
+        std::vector<conflict_type> conflicts;
+
+        /// variables are keyed by their number, and terminals by the
+        /// negation of their number
+        static int key_of(const symbol_type &sym) throw() {
+            const int num(static_cast<int>(sym.number()));
+            return sym.is_variable() ? num : -num;
+        }
+
+        /// index of the transition of a state on a symbol, or NO_STATE
+        unsigned find_transition(const unsigned state, const int key) const throw() {
+            const std::vector<int>::const_iterator first(
+                transition_keys.begin() + transition_begin[state]
+            );
+            const std::vector<int>::const_iterator last(
+                transition_keys.begin() + transition_begin[state + 1U]
+            );
+            const std::vector<int>::const_iterator it(
+                std::lower_bound(first, last, key)
+            );
+
+            if(last == it || key != *it) {
+                return NO_STATE;
+            }
+            return static_cast<unsigned>(it - transition_keys.begin());
+        }
+
+        /// add the initial dotted rules of every variable predicted by a
+        /// set of items to the set
+        void close(
+            std::vector<unsigned> &items,
+            std::vector<unsigned> &stamps,
+            const unsigned stamp
+        ) const throw() {
+            for(unsigned i(0); i < items.size(); ++i) {
+                const dotted_rule_type &rule(rules[items[i]]);
+                if(rule_table_type::PREDICT != rule.kind) {
+                    continue;
+                }
+
+                const unsigned var(rule.next_symbol.number());
+                if(stamp == stamps[var]) {
+                    continue;
+                }
+
+                stamps[var] = stamp;
+                items.insert(
+                    items.end(),
+                    rules.predictions_begin(var),
+                    rules.predictions_end(var)
+                );
+            }
+        }
+
+        /// find or add the state with a kernel
+        unsigned add_state(
+            const std::vector<unsigned> &kernel,
+            const symbol_type &sym,
+            std::map<std::vector<unsigned>, unsigned> &states
+        ) throw() {
+            const unsigned next(static_cast<unsigned>(accessing_symbols.size()));
+            const std::pair<
+                typename std::map<std::vector<unsigned>, unsigned>::iterator,
+                bool
+            > found(states.insert(std::make_pair(kernel, next)));
+
+            if(found.second) {
+                accessing_symbols.push_back(sym);
+                kernels.insert(kernels.end(), kernel.begin(), kernel.end());
+                kernel_begin.push_back(static_cast<unsigned>(kernels.size()));
+            }
+
+            return found.first->second;
+        }
+
+        static void union_sets(
+            std::vector<word_type> &sets,
+            const unsigned into,
+            const unsigned from,
+            const unsigned num_words
+        ) throw() {
+            word_type *dest(&(sets[into * num_words]));
+            const word_type *src(&(sets[from * num_words]));
+            for(unsigned w(0); w < num_words; ++w) {
+                dest[w] |= src[w];
+            }
+        }
+
+        /// make the set of every node the union of the sets of every node
+        /// reachable from it (DeRemer and Pennello's digraph algorithm).
+        /// the search uses an explicit stack so that long chains of
+        /// transitions can't overflow the call stack.
+        static void digraph(
+            const relation_type &edges,
+            std::vector<word_type> &sets,
+            const unsigned num_words
+        ) throw() {
+            const unsigned num_nodes(static_cast<unsigned>(edges.size()));
+            const unsigned DONE(~0U);
+
+            std::vector<unsigned> depth(num_nodes, 0U);
+            std::vector<unsigned> stack;
+            std::vector<frame_type> frames;
+
+            for(unsigned x(0); x < num_nodes; ++x) {
+                if(0 != depth[x] || edges[x].empty()) {
+                    continue;
+                }
+
+                stack.push_back(x);
+                depth[x] = static_cast<unsigned>(stack.size());
+                frames.push_back(frame_type(x, depth[x]));
+
+                for(; !frames.empty(); ) {
+                    frame_type &frame(frames.back());
+                    const unsigned v(frame.node);
+
+                    if(frame.next_edge < edges[v].size()) {
+                        const unsigned y(edges[v][frame.next_edge++]);
+
+                        if(0 == depth[y]) {
+                            stack.push_back(y);
+                            depth[y] = static_cast<unsigned>(stack.size());
+                            frames.push_back(frame_type(y, depth[y]));
+                        } else {
+                            depth[v] = std::min(depth[v], depth[y]);
+                            union_sets(sets, v, y, num_words);
+                        }
+                        continue;
+                    }
+
+                    // v is the root of a strongly connected component, and
+                    // everything in the component has the same set
+                    if(depth[v] == frame.depth) {
+                        for(;;) {
+                            const unsigned t(stack.back());
+                            stack.pop_back();
+                            depth[t] = DONE;
+                            if(t == v) {
+                                break;
+                            }
+                            std::copy(
+                                sets.begin() + v * num_words,
+                                sets.begin() + (v + 1U) * num_words,
+                                sets.begin() + t * num_words
+                            );
+                        }
+                    }
+
+                    frames.pop_back();
+                    if(!frames.empty()) {
+                        const unsigned p(frames.back().node);
+                        depth[p] = std::min(depth[p], depth[v]);
+                        union_sets(sets, p, v, num_words);
+                    }
+                }
+            }
+        }
+
+        /// put an action into a row of the action table, resolving
+        /// conflicts
+        void set_action(
+            std::vector<unsigned> &row,
+            const unsigned state,
+            const unsigned column,
+            const unsigned action
+        ) throw() {
+            unsigned &cell(row[column]);
+            if(ERROR_ACTION == cell || action == cell) {
+                cell = action;
+                return;
+            }
+
+            conflict_type conflict;
+            conflict.state = state;
+            conflict.column = column;
+            conflict.chosen = cell;
+            conflict.dropped = action;
+
+            if(REDUCE_ACTION == (cell & ACTION_MASK)
+            && (REDUCE_ACTION != (action & ACTION_MASK) || action < cell)) {
+                conflict.chosen = action;
+                conflict.dropped = cell;
+            }
+
+            cell = conflict.chosen;
+            conflicts.push_back(conflict);
+        }
+
+        void set_actions(
+            std::vector<unsigned> &row,
+            const unsigned state,
+            const unsigned column,
+            const unsigned action
+        ) throw() {
+            set_action(row, state, column, action);
+            if(is_variable_terminal[column]) {
+                set_action(row, state, UNKNOWN_TOKEN, action);
+            }
+        }
+
+    public:
+
+        LALR1Table(void) throw()
+            : rules()
+            , num_columns(0)
+            , is_variable_terminal()
+            , variable_symbols()
+            , accessing_symbols()
+            , kernels()
+            , kernel_begin()
+            , transition_keys()
+            , transition_targets()
+            , transition_begin()
+            , default_actions()
+            , actions()
+            , gotos()
+            , conflicts()
+        { }
+
+        /// build the automaton and tables of a grammar with a start
+        /// variable
+        void compile(
+            const CFG &cfg,
+            const std::vector<bool> &nullable
+        ) throw() {
+            rules.compile(cfg);
+
+            const unsigned num_vars(rules.num_variables());
+            const unsigned num_rules(rules.size());
+
+            num_columns = cfg.num_terminals() + 2U;
+            const unsigned end(num_columns - 1U);
+
+            accessing_symbols.clear();
+            kernels.clear();
+            kernel_begin.assign(1U, 0U);
+            transition_keys.clear();
+            transition_targets.clear();
+            transition_begin.clear();
+            conflicts.clear();
+
+            is_variable_terminal.assign(num_columns, false);
+            terminal_type T;
+            generator_type terminals(cfg.search(~T));
+            for(; terminals.match_next(); ) {
+                is_variable_terminal[T.number()] = cfg.is_variable_terminal(T);
+            }
+
+            variable_symbols.assign(num_vars, symbol_type());
+            for(unsigned id(0); id < num_rules; ++id) {
+                if(rule_table_type::PREDICT == rules[id].kind) {
+                    const symbol_type &var(rules[id].next_symbol);
+                    variable_symbols[var.number()] = var;
+                }
+            }
+
+            // can everything after the dot of a rule derive epsilon?
+            std::vector<bool> nullable_rest(num_rules, false);
+            for(unsigned id(num_rules); id-- > 0; ) {
+                const dotted_rule_type &rule(rules[id]);
+                if(rule_table_type::COMPLETE == rule.kind) {
+                    nullable_rest[id] = true;
+                } else if(rule_table_type::PREDICT == rule.kind) {
+                    nullable_rest[id] = nullable[rule.next_symbol.number()]
+                                     && nullable_rest[id + 1U];
+                }
+            }
+
+            // build the LR(0) automaton, one state at a time
+            std::map<std::vector<unsigned>, unsigned> states;
+            std::vector<unsigned> kernel(1U, rule_table_type::START_RULE);
+            add_state(kernel, symbol_type(), states);
+
+            std::vector<unsigned> items;
+            std::vector<unsigned> stamps(num_vars, 0U);
+            std::vector<std::pair<int, unsigned> > moves;
+
+            // the state and complete dotted rule of each reduction
+            std::vector<std::pair<unsigned, unsigned> > reductions;
+
+            for(unsigned state(0); state < accessing_symbols.size(); ++state) {
+                items.assign(
+                    kernels.begin() + kernel_begin[state],
+                    kernels.begin() + kernel_begin[state + 1U]
+                );
+                close(items, stamps, state + 1U);
+
+                moves.clear();
+                for(unsigned i(0); i < items.size(); ++i) {
+                    const dotted_rule_type &rule(rules[items[i]]);
+                    if(rule_table_type::COMPLETE != rule.kind) {
+                        moves.push_back(std::make_pair(
+                            key_of(rule.next_symbol),
+                            rule.successor
+                        ));
+                    } else if(rule_table_type::ACCEPT_RULE != items[i]) {
+                        reductions.push_back(std::make_pair(state, items[i]));
+                    }
+                }
+
+                std::sort(moves.begin(), moves.end());
+                transition_begin.push_back(
+                    static_cast<unsigned>(transition_keys.size())
+                );
+
+                for(unsigned i(0); i < moves.size(); ) {
+                    const int key(moves[i].first);
+                    const symbol_type &sym(rules[moves[i].second - 1U].next_symbol);
+
+                    kernel.clear();
+                    for(; i < moves.size() && key == moves[i].first; ++i) {
+                        kernel.push_back(moves[i].second);
+                    }
+
+                    const unsigned target(add_state(kernel, sym, states));
+                    transition_keys.push_back(key);
+                    transition_targets.push_back(target);
+                }
+            }
+
+            const unsigned num_states(
+                static_cast<unsigned>(accessing_symbols.size())
+            );
+            const unsigned num_transitions(
+                static_cast<unsigned>(transition_keys.size())
+            );
+            transition_begin.push_back(num_transitions);
+
+            // the state entered by shifting the start variable accepts at
+            // the end of the input
+            const unsigned accept_state(transition_targets[find_transition(
+                0, key_of(rules[rule_table_type::START_RULE].next_symbol)
+            )]);
+
+            // direct reads of each nonterminal transition (p, A): the
+            // terminals shifted by the state that it goes to
+            const unsigned num_words((num_columns + WORD_BITS - 1U) / WORD_BITS);
+            std::vector<word_type> sets(num_transitions * num_words, 0U);
+            relation_type reads(num_transitions);
+            relation_type includes(num_transitions);
+
+            for(unsigned x(0); x < num_transitions; ++x) {
+                if(0 > transition_keys[x]) {
+                    continue;
+                }
+
+                const unsigned r(transition_targets[x]);
+                if(accept_state == r) {
+                    sets[x * num_words + end / WORD_BITS] |= (
+                        static_cast<word_type>(1U) << (end % WORD_BITS)
+                    );
+                }
+
+                for(unsigned y(transition_begin[r]); y < transition_begin[r + 1U]; ++y) {
+                    const int key(transition_keys[y]);
+                    if(0 > key) {
+                        const unsigned t(static_cast<unsigned>(-key));
+                        sets[x * num_words + t / WORD_BITS] |= (
+                            static_cast<word_type>(1U) << (t % WORD_BITS)
+                        );
+                    } else if(nullable[static_cast<unsigned>(key)]) {
+                        reads[x].push_back(y);
+                    }
+                }
+            }
+
+            // includes and lookback: walk every production of A from p
+            std::map<std::pair<unsigned, unsigned>, unsigned> reduction_ids;
+            for(unsigned i(0); i < reductions.size(); ++i) {
+                reduction_ids[reductions[i]] = i;
+            }
+
+            relation_type lookbacks(reductions.size());
+
+            for(unsigned p(0), x(0); x < num_transitions; ++x) {
+                for(; transition_begin[p + 1U] <= x; ++p) { }
+
+                if(0 > transition_keys[x]) {
+                    continue;
+                }
+
+                const unsigned A(static_cast<unsigned>(transition_keys[x]));
+
+                for(const unsigned *initial(rules.predictions_begin(A)),
+                                   *last(rules.predictions_end(A));
+                    initial != last;
+                    ++initial) {
+
+                    unsigned q(p);
+                    unsigned id(*initial);
+                    for(; rule_table_type::COMPLETE != rules[id].kind; ++id) {
+                        const symbol_type &sym(rules[id].next_symbol);
+                        const unsigned y(find_transition(q, key_of(sym)));
+
+                        if(sym.is_variable() && nullable_rest[id + 1U]) {
+                            includes[y].push_back(x);
+                        }
+
+                        q = transition_targets[y];
+                    }
+
+                    lookbacks[reduction_ids[std::make_pair(q, id)]].push_back(x);
+                }
+            }
+
+            digraph(reads, sets, num_words);
+            digraph(includes, sets, num_words);
+
+            // fill in the rows of the tables
+            std::vector<typename packed_table_type::row_type> action_rows(num_states);
+            std::vector<typename packed_table_type::row_type> goto_rows(num_states);
+            std::vector<unsigned> row;
+            std::vector<word_type> lookahead(num_words);
+            std::map<unsigned, unsigned> reduce_counts;
+
+            default_actions.assign(num_states, ERROR_ACTION);
+
+            for(unsigned state(0), r(0); state < num_states; ++state) {
+                row.assign(num_columns, ERROR_ACTION);
+
+                for(unsigned x(transition_begin[state]);
+                    x < transition_begin[state + 1U];
+                    ++x) {
+
+                    const int key(transition_keys[x]);
+                    if(0 > key) {
+                        set_actions(
+                            row,
+                            state,
+                            static_cast<unsigned>(-key),
+                            (transition_targets[x] << ACTION_BITS) | SHIFT_ACTION
+                        );
+                    } else {
+                        goto_rows[state].push_back(std::make_pair(
+                            static_cast<unsigned>(key),
+                            transition_targets[x]
+                        ));
+                    }
+                }
+
+                if(accept_state == state) {
+                    set_action(row, state, end, ACCEPT_ACTION);
+                }
+
+                for(; r < reductions.size() && state == reductions[r].first; ++r) {
+                    const unsigned action(
+                        (reductions[r].second << ACTION_BITS) | REDUCE_ACTION
+                    );
+
+                    lookahead.assign(num_words, 0U);
+                    for(unsigned i(0); i < lookbacks[r].size(); ++i) {
+                        const word_type *set(&(sets[lookbacks[r][i] * num_words]));
+                        for(unsigned w(0); w < num_words; ++w) {
+                            lookahead[w] |= set[w];
+                        }
+                    }
+
+                    for(unsigned t(1); t < num_columns; ++t) {
+                        if(0 != (lookahead[t / WORD_BITS] & (
+                            static_cast<word_type>(1U) << (t % WORD_BITS)
+                        ))) {
+                            set_actions(row, state, t, action);
+                        }
+                    }
+                }
+
+                // the most common reduction becomes the default action
+                reduce_counts.clear();
+                unsigned most(0);
+                for(unsigned t(0); t < num_columns; ++t) {
+                    if(REDUCE_ACTION == (row[t] & ACTION_MASK)
+                    && ++reduce_counts[row[t]] > most) {
+                        most = reduce_counts[row[t]];
+                        default_actions[state] = row[t];
+                    }
+                }
+
+                for(unsigned t(0); t < num_columns; ++t) {
+                    if(ERROR_ACTION != row[t] && default_actions[state] != row[t]) {
+                        action_rows[state].push_back(std::make_pair(t, row[t]));
+                    }
+                }
+            }
+
+            actions.pack(action_rows, num_columns);
+            gotos.pack(goto_rows, num_vars);
+        }
+
+        /// the dotted rules used by the table
+        inline const rule_table_type &get_rules(void) const throw() {
+            return rules;
+        }
+
+        inline unsigned num_states(void) const throw() {
+            return static_cast<unsigned>(accessing_symbols.size());
+        }
+
+        inline unsigned get_num_columns(void) const throw() {
+            return num_columns;
+        }
+
+        /// the column of the end of the input
+        inline unsigned end_column(void) const throw() {
+            return num_columns - 1U;
+        }
+
+        /// the action of a state given the column of the next token
+        inline unsigned action(
+            const unsigned state,
+            const unsigned column
+        ) const throw() {
+            return actions.get(state, column, default_actions[state]);
+        }
+
+        /// the action of a state for any column without its own entry
+        inline unsigned default_action(const unsigned state) const throw() {
+            return default_actions[state];
+        }
+
+        /// the state to go to after reducing to a variable, or NO_STATE
+        inline unsigned goto_state(
+            const unsigned state,
+            const unsigned var
+        ) const throw() {
+            return gotos.get(state, var, NO_STATE);
+        }
+
+        inline const symbol_type &
+        variable_symbol(const unsigned var) const throw() {
+            return variable_symbols[var];
+        }
+
+        inline const symbol_type &
+        accessing_symbol(const unsigned state) const throw() {
+            return accessing_symbols[state];
+        }
+
+        /// the kernel items of a state
+        inline const unsigned *kernel_items_begin(const unsigned state) const throw() {
+            return &(kernels[0]) + kernel_begin[state];
+        }
+
+        inline const unsigned *kernel_items_end(const unsigned state) const throw() {
+            return &(kernels[0]) + kernel_begin[state + 1U];
+        }
+
+        inline bool is_variable_terminal_column(const unsigned t) const throw() {
+            return is_variable_terminal[t];
+        }
+
+        inline const std::vector<conflict_type> &get_conflicts(void) const throw() {
+            return conflicts;
+        }
+
+        /// the number of cells in the packed tables, and in the tables
+        /// without packing
+        inline unsigned num_packed_cells(void) const throw() {
+            return static_cast<unsigned>(
+                actions.entries.size() + gotos.entries.size()
+            );
+        }
+
+        inline unsigned num_unpacked_cells(void) const throw() {
+            return num_states() * (num_columns + rules.num_variables());
+        }
+    };
+}}
+
+#endif /* FLTL_LALR1_TABLE_HPP_ */
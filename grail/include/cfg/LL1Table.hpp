@@ -0,0 +1,231 @@
+/*
+ * LL1Table.hpp
+ *
+ *  Created on: May 26, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_LL1_TABLE_HPP_
+#define FLTL_LL1_TABLE_HPP_
+
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/cfg/DottedRuleTable.hpp"
+#include "grail/include/cfg/TerminalSet.hpp"
+
+namespace grail { namespace cfg {
+
+    /// a dense LL(1) predict table of a grammar. each row is a variable
+    /// and each column is a lookahead token; the entry is the initial
+    /// dotted rule of the production to expand, or NO_RULE.
+    ///
+    /// column 0 is any token that isn't a terminal of the grammar (i.e. one
+    /// that can only be matched by a variable terminal), columns 1 to T are
+    /// the terminals of the grammar, and column T + 1 is the end of the
+    /// input.
+    template <typename AlphaT>
+    class LL1Table {
+    public:
+
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef DottedRuleTable<AlphaT> rule_table_type;
+        typedef typename rule_table_type::dotted_rule_type dotted_rule_type;
+
+        enum {
+            NO_RULE = ~0U,
+            UNKNOWN_TOKEN = 0U
+        };
+
+    private:
+
+        /// dotted rules of the grammar
+        rule_table_type rules;
+
+        /// the table, stored row by row
+        std::vector<unsigned> table;
+
+        /// the number of columns in each row
+        unsigned num_columns;
+
+        /// the number of cells with more than one production
+        unsigned num_conflicts;
+
+        /// the first conflict found, for reporting
+        unsigned conflict_variable;
+        unsigned conflict_column;
+
+        /// is a terminal a variable terminal?
+        std::vector<bool> is_variable_terminal;
+
+        void add(
+            const unsigned var,
+            const unsigned column,
+            const unsigned rule
+        ) throw() {
+            unsigned &entry(table[var * num_columns + column]);
+
+            if(NO_RULE == entry || rule == entry) {
+                entry = rule;
+                return;
+            }
+
+            if(0 == num_conflicts) {
+                conflict_variable = var;
+                conflict_column = column;
+            }
+
+            ++num_conflicts;
+        }
+
+        /// add a production to every column of a set of terminals. tokens
+        /// that aren't terminals of the grammar are predicted by sets with
+        /// variable terminals.
+        void add_all(
+            const unsigned var,
+            const TerminalSet &terminals,
+            const unsigned rule
+        ) throw() {
+            for(unsigned t(terminals.find_next(0));
+                t < num_columns;
+                t = terminals.find_next(t)) {
+
+                add(var, t, rule);
+                if(is_variable_terminal[t]) {
+                    add(var, UNKNOWN_TOKEN, rule);
+                }
+            }
+        }
+
+    public:
+
+        LL1Table(void) throw()
+            : rules()
+            , table()
+            , num_columns(0)
+            , num_conflicts(0)
+            , conflict_variable(0)
+            , conflict_column(0)
+            , is_variable_terminal()
+        { }
+
+        /// build the table of a grammar with a start variable. the FOLLOW
+        /// set of the start variable must contain the end of the input (see
+        /// compute_follow_set).
+        void compile(
+            const CFG &cfg,
+            const std::vector<bool> &nullable,
+            const std::vector<TerminalSet> &first,
+            const std::vector<TerminalSet> &follow
+        ) throw() {
+            rules.compile(cfg);
+
+            const unsigned num_vars(rules.num_variables());
+
+            num_columns = cfg.num_terminals() + 2U;
+            num_conflicts = 0;
+            table.assign(num_vars * num_columns, NO_RULE);
+
+            is_variable_terminal.assign(num_columns, false);
+            terminal_type T;
+            generator_type terminals(cfg.search(~T));
+            for(; terminals.match_next(); ) {
+                is_variable_terminal[T.number()] = cfg.is_variable_terminal(T);
+            }
+
+            for(unsigned var(1); var < num_vars; ++var) {
+                for(const unsigned *initial(rules.predictions_begin(var)),
+                                   *last(rules.predictions_end(var));
+                    initial != last;
+                    ++initial) {
+
+                    // add the FIRST set of the production, and its
+                    // variable's FOLLOW set if the production is nullable
+                    unsigned id(*initial);
+                    for(; rule_table_type::COMPLETE != rules[id].kind; ++id) {
+                        const symbol_type &sym(rules[id].next_symbol);
+
+                        if(sym.is_terminal()) {
+                            const unsigned t(sym.number());
+                            add(var, t, *initial);
+                            if(is_variable_terminal[t]) {
+                                add(var, UNKNOWN_TOKEN, *initial);
+                            }
+                            break;
+                        }
+
+                        add_all(var, first[sym.number()], *initial);
+                        if(!nullable[sym.number()]) {
+                            break;
+                        }
+                    }
+
+                    if(rule_table_type::COMPLETE == rules[id].kind) {
+                        add_all(var, follow[var], *initial);
+                    }
+                }
+            }
+        }
+
+        /// the dotted rules used by the table
+        inline const rule_table_type &get_rules(void) const throw() {
+            return rules;
+        }
+
+        /// the column of the end of the input
+        inline unsigned end_column(void) const throw() {
+            return num_columns - 1U;
+        }
+
+        /// the initial dotted rule of the production to expand a variable
+        /// with given the next token, or NO_RULE
+        inline unsigned
+        predict(const unsigned var, const unsigned column) const throw() {
+            return table[var * num_columns + column];
+        }
+
+        /// the number of cells that more than one production wants
+        inline unsigned get_num_conflicts(void) const throw() {
+            return num_conflicts;
+        }
+
+        inline unsigned get_conflict_variable(void) const throw() {
+            return conflict_variable;
+        }
+
+        inline unsigned get_conflict_column(void) const throw() {
+            return conflict_column;
+        }
+
+        inline bool is_variable_terminal_column(const unsigned t) const throw() {
+            return is_variable_terminal[t];
+        }
+    };
+}}
+
+#endif /* FLTL_LL1_TABLE_HPP_ */
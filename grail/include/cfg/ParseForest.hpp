@@ -0,0 +1,518 @@
+/*
+ * ParseForest.hpp
+ *
+ *  Created on: May 22, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_PARSEFOREST_HPP_
+#define FLTL_PARSEFOREST_HPP_
+
+#include <cassert>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "fltl/include/helper/BlockAllocator.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+#include "grail/include/cfg/DottedRuleTable.hpp"
+#include "grail/include/cfg/ParseTree.hpp"
+
+namespace grail { namespace cfg {
+
+    /// a shared packed parse forest (SPPF). the forest is binarized: a
+    /// symbol node (X, i, j) represents all derivations of X from the
+    /// tokens [i, j), and an intermediate node (A --> alpha * beta, i, j)
+    /// represents all derivations of alpha from the tokens [i, j). each
+    /// alternative derivation of a node is a packed node whose left child
+    /// derives everything up to the last symbol before the dot and whose
+    /// right child derives that last symbol.
+    template <typename AlphaT>
+    class ParseForest : private fltl::trait::Uncopyable {
+    public:
+
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef DottedRuleTable<AlphaT> rule_table_type;
+        typedef typename rule_table_type::dotted_rule_type dotted_rule_type;
+        typedef ParseTree<AlphaT> tree_type;
+
+        class packed_node_type;
+
+        enum {
+            SYMBOL_NODE,
+            INTERMEDIATE_NODE
+        };
+
+        /// symbol or intermediate node of the forest
+        class node_type {
+        public:
+
+            // one of SYMBOL_NODE or INTERMEDIATE_NODE
+            unsigned kind;
+
+            // the symbol of a symbol node
+            symbol_type symbol;
+
+            // the dotted rule of an intermediate node
+            unsigned rule;
+
+            // the tokens [start, end) derived by this node
+            unsigned start;
+            unsigned end;
+
+            // alternative derivations of this node; terminal symbol nodes
+            // have none.
+            packed_node_type *first_packed;
+
+            node_type(void)
+                : kind(SYMBOL_NODE)
+                , symbol()
+                , rule(0)
+                , start(0)
+                , end(0)
+                , first_packed(0)
+            { }
+        };
+
+        /// one derivation of a symbol or intermediate node
+        class packed_node_type {
+        public:
+
+            // the dotted rule A --> alpha X * beta that this derivation
+            // derives
+            unsigned rule;
+
+            // where X starts
+            unsigned pivot;
+
+            // derivation of alpha, or null if alpha is empty
+            node_type *left;
+
+            // derivation of X, or null if alpha X is empty
+            node_type *right;
+
+            // the order in which this derivation was found. every
+            // derivation found by the parser only uses derivations that
+            // were found before it, so always following the lowest serial
+            // numbers gives a finite tree, even for cyclic grammars.
+            unsigned serial;
+
+            // next alternative derivation of the same node
+            packed_node_type *next;
+
+            packed_node_type(void)
+                : rule(0)
+                , pivot(0)
+                , left(0)
+                , right(0)
+                , serial(0)
+                , next(0)
+            { }
+        };
+
+    private:
+
+        enum {
+            NUM_BLOCKS = 1024U,
+            NO_RULE = ~0U
+        };
+
+        typedef fltl::helper::BlockAllocator<
+            node_type, NUM_BLOCKS
+        > node_allocator_type;
+
+        typedef fltl::helper::BlockAllocator<
+            packed_node_type, NUM_BLOCKS
+        > packed_node_allocator_type;
+
+        /// key used for sharing nodes: (kind, label, start, end)
+        typedef std::pair<
+            std::pair<unsigned, int>,
+            std::pair<unsigned, unsigned>
+        > node_key_type;
+
+        typedef std::map<node_key_type, node_type *> node_map_type;
+
+        node_allocator_type node_allocator;
+        packed_node_allocator_type packed_node_allocator;
+
+        /// all nodes of the forest, in the order they were made
+        std::vector<node_type *> nodes;
+        node_map_type shared_nodes;
+
+        /// lexemes of the tokens of the input
+        std::vector<alphabet_type> lexemes;
+
+        /// dotted rules of the grammar being parsed
+        rule_table_type rules;
+
+        /// for each nullable variable, the initial dotted rule of the
+        /// production used to derive epsilon from it
+        std::vector<unsigned> null_rules;
+
+        node_type *root;
+
+        /// find or make a node
+        node_type *share_node(
+            const unsigned kind,
+            const int label,
+            const unsigned start,
+            const unsigned end
+        ) throw() {
+            const node_key_type key(
+                std::make_pair(kind, label),
+                std::make_pair(start, end)
+            );
+
+            typename node_map_type::iterator pos(shared_nodes.find(key));
+            if(shared_nodes.end() != pos) {
+                return pos->second;
+            }
+
+            node_type *node(node_allocator.allocate());
+            node->kind = kind;
+            node->start = start;
+            node->end = end;
+            shared_nodes.insert(pos, std::make_pair(key, node));
+            nodes.push_back(node);
+            return node;
+        }
+
+        /// choose the productions used to derive epsilon from each nullable
+        /// variable. only productions whose variables all have already
+        /// chosen productions are used, so the derivations are finite.
+        void choose_null_rules(void) throw() {
+            const unsigned num_vars(rules.num_variables());
+            null_rules.assign(num_vars, NO_RULE);
+
+            for(bool updated(true); updated; ) {
+                updated = false;
+
+                for(unsigned var(1); var < num_vars; ++var) {
+                    if(NO_RULE != null_rules[var]) {
+                        continue;
+                    }
+
+                    for(const unsigned *initial(rules.predictions_begin(var)),
+                                       *last(rules.predictions_end(var));
+                        initial != last;
+                        ++initial) {
+
+                        unsigned id(*initial);
+                        for(; rule_table_type::COMPLETE != rules[id].kind;
+                            ++id) {
+
+                            const symbol_type &sym(rules[id].next_symbol);
+                            if(!sym.is_variable()
+                            || NO_RULE == null_rules[sym.number()]) {
+                                break;
+                            }
+                        }
+
+                        if(rule_table_type::COMPLETE == rules[id].kind) {
+                            null_rules[var] = *initial;
+                            updated = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        /// choose the lowest-serial derivation of a node
+        static const packed_node_type *
+        first_derivation(const node_type *node) throw() {
+            const packed_node_type *best(node->first_packed);
+            for(const packed_node_type *packed(best);
+                0 != packed;
+                packed = packed->next) {
+
+                if(packed->serial < best->serial) {
+                    best = packed;
+                }
+            }
+            return best;
+        }
+
+        /// make the tree for a symbol node; children are filled in later
+        tree_type *make_tree(
+            const node_type *node,
+            const packed_node_type *&packed
+        ) const throw() {
+            packed = 0;
+            if(node->symbol.is_terminal()) {
+                return new tree_type(
+                    terminal_type(node->symbol),
+                    &(lexemes[node->start])
+                );
+            }
+
+            packed = first_derivation(node);
+            assert(0 != packed);
+
+            production_type prod(rules.production(packed->rule));
+            return new tree_type(prod);
+        }
+
+    public:
+
+        ParseForest(void) throw()
+            : node_allocator()
+            , packed_node_allocator()
+            , nodes()
+            , shared_nodes()
+            , lexemes()
+            , rules()
+            , null_rules()
+            , root(0)
+        { }
+
+        ~ParseForest(void) throw() {
+            clear();
+        }
+
+        /// release every node of the forest
+        void clear(void) throw() {
+            for(unsigned i(0); i < nodes.size(); ++i) {
+                packed_node_type *next(0);
+                for(packed_node_type *packed(nodes[i]->first_packed);
+                    0 != packed;
+                    packed = next) {
+                    next = packed->next;
+                    packed_node_allocator.deallocate(packed);
+                }
+                node_allocator.deallocate(nodes[i]);
+            }
+
+            for(unsigned i(0); i < lexemes.size(); ++i) {
+                traits_type::destroy(lexemes[i]);
+            }
+
+            nodes.clear();
+            shared_nodes.clear();
+            lexemes.clear();
+            root = 0;
+        }
+
+        /// prepare the forest for parsing with a set of dotted rules
+        void reset(const rule_table_type &rules_) throw() {
+            clear();
+            rules = rules_;
+            choose_null_rules();
+        }
+
+        /// remember the lexeme of the next token
+        void add_lexeme(const alphabet_type &lexeme) throw() {
+            lexemes.push_back(traits_type::copy(lexeme));
+        }
+
+        /// find or make the symbol node of a terminal
+        node_type *terminal_node(
+            const symbol_type &term,
+            const unsigned start
+        ) throw() {
+            node_type *node(share_node(
+                SYMBOL_NODE, -static_cast<int>(term.number()), start, start + 1U
+            ));
+            node->symbol = term;
+            return node;
+        }
+
+        /// find or make the symbol node of a variable
+        node_type *symbol_node(
+            const symbol_type &var,
+            const unsigned start,
+            const unsigned end
+        ) throw() {
+            node_type *node(share_node(
+                SYMBOL_NODE, static_cast<int>(var.number()), start, end
+            ));
+            node->symbol = var;
+            return node;
+        }
+
+        /// find or make an intermediate node
+        node_type *intermediate_node(
+            const unsigned rule,
+            const unsigned start,
+            const unsigned end
+        ) throw() {
+            node_type *node(share_node(
+                INTERMEDIATE_NODE, static_cast<int>(rule), start, end
+            ));
+            node->rule = rule;
+            return node;
+        }
+
+        /// find or make the symbol node for deriving epsilon from a
+        /// nullable variable. only one such derivation is kept.
+        node_type *null_node(
+            const symbol_type &var,
+            const unsigned pos
+        ) throw() {
+            node_type *node(symbol_node(var, pos, pos));
+            if(0 != node->first_packed) {
+                return node;
+            }
+
+            const unsigned initial(null_rules[var.number()]);
+            assert(NO_RULE != initial);
+
+            node_type *left(0);
+            unsigned id(initial);
+
+            for(; rule_table_type::COMPLETE != rules[id].kind; ++id) {
+                node_type *right(null_node(rules[id].next_symbol, pos));
+                node_type *inter(node);
+
+                if(rule_table_type::COMPLETE != rules[id + 1U].kind) {
+                    inter = intermediate_node(id + 1U, pos, pos);
+                }
+
+                add_packed(inter, id + 1U, pos, left, right, 0U);
+                left = inter;
+            }
+
+            // epsilon production
+            if(id == initial) {
+                add_packed(node, id, pos, 0, 0, 0U);
+            }
+
+            return node;
+        }
+
+        /// add a derivation to a node, unless it is already there
+        void add_packed(
+            node_type *node,
+            const unsigned rule,
+            const unsigned pivot,
+            node_type *left,
+            node_type *right,
+            const unsigned serial
+        ) throw() {
+            for(packed_node_type *packed(node->first_packed);
+                0 != packed;
+                packed = packed->next) {
+
+                if(packed->rule == rule
+                && packed->pivot == pivot
+                && packed->left == left
+                && packed->right == right) {
+                    if(serial < packed->serial) {
+                        packed->serial = serial;
+                    }
+                    return;
+                }
+            }
+
+            packed_node_type *packed(packed_node_allocator.allocate());
+            packed->rule = rule;
+            packed->pivot = pivot;
+            packed->left = left;
+            packed->right = right;
+            packed->serial = serial;
+            packed->next = node->first_packed;
+            node->first_packed = packed;
+        }
+
+        void set_root(node_type *node) throw() {
+            root = node;
+        }
+
+        const node_type *get_root(void) const throw() {
+            return root;
+        }
+
+        const rule_table_type &get_rules(void) const throw() {
+            return rules;
+        }
+
+        const alphabet_type &get_lexeme(const unsigned i) const throw() {
+            return lexemes[i];
+        }
+
+        /// the number of symbol and intermediate nodes in the forest
+        unsigned num_nodes(void) const throw() {
+            return static_cast<unsigned>(nodes.size());
+        }
+
+        const node_type *get_node(const unsigned i) const throw() {
+            return nodes[i];
+        }
+
+        /// extract one parse tree from the forest. only the nodes of the
+        /// extracted derivation are visited, so this is linear in the size
+        /// of the tree no matter how ambiguous the forest is. the caller
+        /// owns the returned tree.
+        tree_type *extract_tree(void) const throw() {
+            if(0 == root) {
+                return 0;
+            }
+
+            // pending trees whose children need to be filled in
+            std::vector<std::pair<tree_type *, const packed_node_type *> >
+                work;
+
+            const packed_node_type *packed(0);
+            tree_type *tree(make_tree(root, packed));
+            work.push_back(std::make_pair(tree, packed));
+
+            for(; !work.empty(); ) {
+                tree_type *parent(work.back().first);
+                packed = work.back().second;
+                work.pop_back();
+
+                // walk the binarized derivation from right to left, which
+                // is the order that children are added to trees
+                for(; 0 != packed; ) {
+                    if(0 != packed->right) {
+                        const packed_node_type *child_packed(0);
+                        tree_type *child(make_tree(packed->right, child_packed));
+                        parent->add_child(child);
+                        if(0 != child_packed) {
+                            work.push_back(std::make_pair(child, child_packed));
+                        }
+                    }
+
+                    if(0 == packed->left) {
+                        break;
+                    }
+
+                    packed = first_derivation(packed->left);
+                }
+            }
+
+            return tree;
+        }
+    };
+}}
+
+#endif /* FLTL_PARSEFOREST_HPP_ */
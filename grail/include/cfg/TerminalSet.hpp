@@ -0,0 +1,209 @@
+/*
+ * TerminalSet.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_TERMINAL_SET_HPP_
+#define FLTL_TERMINAL_SET_HPP_
+
+#include <cassert>
+#include <vector>
+#include <stdint.h>
+
+namespace grail { namespace cfg {
+
+    /// set of terminal numbers (or of any other small unsigned integers),
+    /// as used by the FIRST and FOLLOW sets. the set is a bitmap of 64-bit
+    /// words, so that two sets can be combined a word at a time.
+    class TerminalSet {
+    public:
+
+        enum {
+            NOT_FOUND = ~0U
+        };
+
+    private:
+
+        typedef uint64_t word_type;
+
+        enum {
+            WORD_BITS = 64U
+        };
+
+        std::vector<word_type> words;
+
+        /// one more than the largest number that can be in the set
+        unsigned size_;
+
+        static word_type bit(const unsigned i) throw() {
+            return static_cast<word_type>(1) << (i % WORD_BITS);
+        }
+
+        /// index of the lowest set bit of a non-zero word
+        static unsigned lowest_bit(word_type word) throw() {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+            unsigned i(0);
+            for(; 0 == (word & 1U); word >>= 1U) {
+                ++i;
+            }
+            return i;
+#endif
+        }
+
+        static unsigned count_bits(word_type word) throw() {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+            unsigned count(0);
+            for(; 0 != word; word &= word - 1U) {
+                ++count;
+            }
+            return count;
+#endif
+        }
+
+    public:
+
+        TerminalSet(void) throw()
+            : words()
+            , size_(0)
+        { }
+
+        explicit TerminalSet(const unsigned size) throw()
+            : words((size + WORD_BITS - 1U) / WORD_BITS, 0)
+            , size_(size)
+        { }
+
+        /// make this the empty set of numbers less than size
+        void reset(const unsigned size) throw() {
+            words.assign((size + WORD_BITS - 1U) / WORD_BITS, 0);
+            size_ = size;
+        }
+
+        /// one more than the largest number that can be in the set
+        inline unsigned size(void) const throw() {
+            return size_;
+        }
+
+        inline bool contains(const unsigned i) const throw() {
+            assert(i < size_);
+            return 0 != (words[i / WORD_BITS] & bit(i));
+        }
+
+        /// add a number to the set; returns true if it wasn't already in
+        /// the set
+        inline bool insert(const unsigned i) throw() {
+            assert(i < size_);
+            word_type &word(words[i / WORD_BITS]);
+            const word_type old_word(word);
+            word |= bit(i);
+            return old_word != word;
+        }
+
+        /// add every number of another set to this set; returns true if
+        /// this set changed. the other set can't hold larger numbers than
+        /// this set.
+        bool insert_all(const TerminalSet &that) throw() {
+            assert(that.words.size() <= words.size());
+
+            const size_t num_words(that.words.size());
+            word_type *dest(num_words ? &(words[0]) : 0);
+            const word_type *source(num_words ? &(that.words[0]) : 0);
+
+            // no early exit, so that the loop can be vectorized
+            word_type changed(0);
+            for(size_t i(0); i < num_words; ++i) {
+                const word_type word(dest[i] | source[i]);
+                changed |= word ^ dest[i];
+                dest[i] = word;
+            }
+
+            return 0 != changed;
+        }
+
+        /// is every number of another set in this set? the other set can't
+        /// hold larger numbers than this set.
+        bool includes(const TerminalSet &that) const throw() {
+            assert(that.words.size() <= words.size());
+
+            for(size_t i(0); i < that.words.size(); ++i) {
+                if(0 != (that.words[i] & ~(words[i]))) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// the number of numbers in the set
+        unsigned count(void) const throw() {
+            unsigned num(0);
+            for(size_t i(0); i < words.size(); ++i) {
+                num += count_bits(words[i]);
+            }
+            return num;
+        }
+
+        /// find the smallest member, or NOT_FOUND
+        inline unsigned find_first(void) const throw() {
+            return find_from(0);
+        }
+
+        /// find the smallest member greater than i, or NOT_FOUND
+        inline unsigned find_next(const unsigned i) const throw() {
+            return find_from(i + 1U);
+        }
+
+        /// find the smallest member greater than or equal to i, or
+        /// NOT_FOUND
+        unsigned find_from(const unsigned i) const throw() {
+            size_t w(i / WORD_BITS);
+            if(w >= words.size()) {
+                return NOT_FOUND;
+            }
+
+            word_type word(
+                words[w] & (~static_cast<word_type>(0) << (i % WORD_BITS))
+            );
+            for(;;) {
+                if(0 != word) {
+                    return static_cast<unsigned>(w * WORD_BITS) + lowest_bit(word);
+                }
+
+                if(++w >= words.size()) {
+                    return NOT_FOUND;
+                }
+
+                word = words[w];
+            }
+        }
+    };
+
+}}
+
+#endif /* FLTL_TERMINAL_SET_HPP_ */
@@ -34,196 +34,170 @@
 
 #include "fltl/include/CFG.hpp"
 
-namespace grail { namespace cfg {
-
-    namespace detail {
+#include "grail/include/cfg/DependencyGraph.hpp"
+#include "grail/include/cfg/TerminalSet.hpp"
 
-        template <typename T>
-        inline bool insert(std::vector<bool> *vec, T term) throw() {
-            std::vector<bool>::reference bit(vec->operator[](term.number()));
-            if(!bit) {
-                bit = true;
-                return true;
-            } else {
-                return false;
-            }
-        }
-
-        bool union_into(std::vector<bool> *dest, const std::vector<bool> *sub) throw() {
-            if(0 == dest || 0 == sub) {
-                return false;
-            }
+#include "grail/include/io/verbose.hpp"
 
-            assert(dest->size() == sub->size());
-
-            bool updated(false);
+namespace grail { namespace cfg {
 
-            for(size_t i(0), len(dest->size()); i < len; ++i) {
-                std::vector<bool>::reference ith(dest->operator[](i));
-                if(sub->operator[](i) && !ith) {
-                    ith = true;
-                    updated = true;
-                }
-            }
+    namespace detail {
 
-            return updated;
+        /// report the shape of the graph that a set-valued analysis was
+        /// solved over
+        inline void verbose_components(const DependencyGraph &graph) throw() {
+            io::verbose(
+                "    %u strongly connected components, the largest of "
+                "size %u.\n",
+                graph.num_components(),
+                graph.largest_component()
+            );
         }
-
     }
 
-    /// compute the first sets of termianls for the variables of a CFG.
+    /// compute the first sets of terminals for the variables of a frozen
+    /// grammar.
     template <typename AlphaT>
     void compute_first_terminals(
-        const fltl::CFG<AlphaT> &cfg,
+        const fltl::cfg::FrozenGrammar<AlphaT> &grammar,
         const std::vector<bool> &nullable,
-        std::vector<std::vector<bool> *> &first
+        std::vector<TerminalSet> &first
     ) throw() {
 
-        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
-
-        typedef std::vector<bool> terminal_set_type;
+        typedef typename fltl::cfg::FrozenGrammar<AlphaT>::symbol_type
+                symbol_type;
 
-        first.assign(cfg.num_variables_capacity() + 2, 0);
+        first.assign(grammar.num_variables_capacity() + 2, TerminalSet());
 
         // allocate the sets
-        variable_type V;
-        generator_type variables(cfg.search(~V));
-        for(; variables.match_next(); ) {
-            first[V.number()] = new std::vector<bool>(
-                cfg.num_terminals() + 2, false
-            );
+        for(unsigned i(0), num_vars(grammar.num_variables());
+            i < num_vars;
+            ++i) {
+            first[grammar.variable(i)].reset(grammar.num_terminals() + 2);
         }
 
-        // base case, all productions with a terminal as the first symbol on
-        // their RHS
-        terminal_type T;
-        generator_type first_subsets(cfg.search((~V) --->* ~T + cfg.__));
-        bool updated(false);
-        for(; first_subsets.match_next(); ) {
-            detail::insert(first[V.number()], T);
-            updated = true;
+        // add in the terminals that can begin each production, and
+        // record which FIRST sets each FIRST set includes
+        DependencyGraph graph;
+        for(unsigned i(0), num_vars(grammar.num_variables());
+            i < num_vars;
+            ++i) {
+            graph.add_node(grammar.variable(i));
         }
 
-        // induction step. note: base case won't necessarily yield anything
-        // if every production has a form like "A -> alpha t beta" where
-        // alpha is a sequence of one or more nullable variables and t is a
-        // terminal.
-        variable_type A;
-        variable_type reached;
-        production_type prod;
-        generator_type next_subsets(cfg.search(~prod, V --->* ~A + cfg.__));
-        terminal_set_type *curr_set(0);
-        terminal_set_type *reached_set(0);
-
-        updated = true;
-        for(; updated; ) {
-            updated = false;
-
-            for(variables.rewind(); variables.match_next(); ) {
+        for(unsigned prod(0), num_prods(grammar.num_productions());
+            prod < num_prods;
+            ++prod) {
 
-                curr_set = first[V.number()];
+            const unsigned var(grammar.production_variable(prod));
+            const symbol_type *sym(grammar.symbols_begin(prod));
+            const symbol_type *end(grammar.symbols_end(prod));
 
-                for(next_subsets.rewind(); next_subsets.match_next(); ) {
+            for(; sym != end; ++sym) {
 
-                    for(unsigned i(0), len(prod.symbols().length());
-                        i < len;
-                        ++i) {
-
-                        // found a terminal, add it in; can't move past it
-                        if(prod.symbol_at(i).is_terminal()) {
-
-                            updated = detail::insert(
-                                curr_set,
-                                terminal_type(prod.symbol_at(i))
-                            ) || updated;
-
-                            break;
-
-                        // found a variable, union in, try to move past
-                        } else {
-                            reached = prod.symbol_at(i);
-                            reached_set = first[reached.number()];
+                // found a terminal, add it in; can't move past it
+                if(sym->is_terminal()) {
+                    first[var].insert(sym->number());
+                    break;
+                }
 
-                            assert(0 != reached_set);
+                // found a variable, union in, try to move past
+                assert(0 != first[sym->number()].size());
 
-                            updated = detail::union_into(
-                                curr_set,
-                                reached_set
-                            ) || updated;
+                if(var != sym->number()) {
+                    graph.add_edge(var, sym->number());
+                }
 
-                            // can't move past
-                            if(!nullable[reached.number()]) {
-                                break;
-                            }
-                        }
-                    }
+                // can't move past
+                if(!nullable[sym->number()]) {
+                    break;
                 }
             }
         }
+
+        graph.close(first);
+        detail::verbose_components(graph);
     }
 
+    /// compute the first sets of termianls for the variables of a CFG.
+    template <typename AlphaT>
+    void compute_first_terminals(
+        const fltl::CFG<AlphaT> &cfg,
+        const std::vector<bool> &nullable,
+        std::vector<TerminalSet> &first
+    ) throw() {
+        fltl::cfg::FrozenGrammar<AlphaT> grammar;
+        cfg.freeze(grammar);
+        compute_first_terminals(grammar, nullable, first);
+    }
 
-    /// compute the first sets of variables for the variables of a CFG.
+    /// compute the first sets of variables for the variables of a frozen
+    /// grammar.
     template <typename AlphaT>
     void compute_first_variables(
-        fltl::CFG<AlphaT> &cfg,
+        const fltl::cfg::FrozenGrammar<AlphaT> &grammar,
         const std::vector<bool> &nullable,
-        std::vector<std::vector<bool> *> &first
+        std::vector<TerminalSet> &first
     ) throw() {
 
-        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
-
-        typedef std::vector<bool> terminal_set_type;
+        typedef typename fltl::cfg::FrozenGrammar<AlphaT>::symbol_type
+                symbol_type;
 
-        const unsigned num_vars(cfg.num_variables_capacity() + 2);
+        const unsigned num_vars(grammar.num_variables_capacity() + 2);
 
-        first.assign(num_vars, 0);
+        first.assign(num_vars, TerminalSet());
 
         // allocate the sets
-        variable_type V, W;
-        generator_type variables(cfg.search(~V));
-        for(; variables.match_next(); ) {
-            first[V.number()] = new std::vector<bool>(num_vars, false);
+        for(unsigned i(0); i < grammar.num_variables(); ++i) {
+            first[grammar.variable(i)].reset(num_vars);
         }
 
-        production_type production;
-        generator_type productions(cfg.search(~production));
-
-        terminal_set_type *source_set(0);
-        terminal_set_type *reached_set(0);
-
-        symbol_string_type str;
-
-        bool updated(true);
-        for(; updated; ) {
-            updated = false;
-
-            for(productions.rewind(); productions.match_next(); ) {
+        DependencyGraph graph;
+        for(unsigned i(0); i < grammar.num_variables(); ++i) {
+            graph.add_node(grammar.variable(i));
+        }
 
-                str = production.symbols();
-                V = production.variable();
-                source_set = first[V.number()];
+        for(unsigned prod(0), num_prods(grammar.num_productions());
+            prod < num_prods;
+            ++prod) {
 
-                for(unsigned i(0); i < str.length(); ++i) {
+            const unsigned var(grammar.production_variable(prod));
+            const symbol_type *sym(grammar.symbols_begin(prod));
+            const symbol_type *end(grammar.symbols_end(prod));
 
-                    // can't walk past a terminal
-                    if(str.at(i).is_terminal()) {
-                        break;
-                    }
+            for(; sym != end; ++sym) {
 
-                    W = str.at(i);
-                    reached_set = first[W.number()];
+                // can't walk past a terminal
+                if(sym->is_terminal()) {
+                    break;
+                }
 
-                    updated = detail::insert(source_set, W) || updated;
-                    updated = detail::union_into(source_set, reached_set) || updated;
+                first[var].insert(sym->number());
+                if(var != sym->number()) {
+                    graph.add_edge(var, sym->number());
+                }
 
-                    // can't walk past a non-nullable non-terminal
-                    if(!(nullable[W.number()])) {
-                        break;
-                    }
+                // can't walk past a non-nullable non-terminal
+                if(!(nullable[sym->number()])) {
+                    break;
                 }
             }
         }
+
+        graph.close(first);
+        detail::verbose_components(graph);
+    }
+
+    /// compute the first sets of variables for the variables of a CFG.
+    template <typename AlphaT>
+    void compute_first_variables(
+        const fltl::CFG<AlphaT> &cfg,
+        const std::vector<bool> &nullable,
+        std::vector<TerminalSet> &first
+    ) throw() {
+        fltl::cfg::FrozenGrammar<AlphaT> grammar;
+        cfg.freeze(grammar);
+        compute_first_variables(grammar, nullable, first);
     }
 
 }}
@@ -14,67 +14,105 @@
 
 #include "fltl/include/CFG.hpp"
 
+#include "grail/include/cfg/DependencyGraph.hpp"
+#include "grail/include/cfg/TerminalSet.hpp"
+#include "grail/include/cfg/compute_first_set.hpp"
+
 namespace grail { namespace cfg {
 
-    /// compute the follow sets for a CFG.
+    /// compute the follow sets for a frozen grammar. the end of the input
+    /// is represented by the terminal number one past the last terminal.
     template <typename AlphaT>
     void compute_follow_set(
-        const fltl::CFG<AlphaT> &cfg,
+        const fltl::cfg::FrozenGrammar<AlphaT> &grammar,
         const std::vector<bool> &nullable,
-        const std::vector<std::vector<bool> *> &first,
-        std::vector<std::vector<bool> *> &follow
+        const std::vector<TerminalSet> &first,
+        std::vector<TerminalSet> &follow
     ) throw() {
-        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
-
-        follow.assign(cfg.num_variables_capacity() + 2, 0);
 
-        variable_type V;
-        variable_type A;
-        symbol_string_type s;
+        typedef typename fltl::cfg::FrozenGrammar<AlphaT>::symbol_type
+                symbol_type;
 
-        generator_type variables(cfg.search(~V));
-        generator_type syms_following_V(cfg.search((~A) --->* cfg.__ + V + ~s));
+        follow.assign(grammar.num_variables_capacity() + 2, TerminalSet());
 
         // initialize each follow bitset as the empty set of the appropriate
         // size.
-        for(; variables.match_next(); ) {
-            follow[V.number()] = new std::vector<bool>(cfg.num_terminals() + 2U, false);
+        for(unsigned i(0); i < grammar.num_variables(); ++i) {
+            follow[grammar.variable(i)].reset(grammar.num_terminals() + 2U);
         }
 
-        for(bool updated(true); updated; ) {
-            updated = false;
+        // the end of the input follows the start variable
+        if(grammar.has_start_variable()) {
+            const unsigned start(grammar.start_variable());
+            if(0 != follow[start].size()) {
+                follow[start].insert(grammar.num_terminals() + 1U);
+            }
+        }
 
-            for(variables.rewind(); variables.match_next(); ) {
+        // add in what follows each variable within the productions, and
+        // record which FOLLOW sets each FOLLOW set includes
+        DependencyGraph graph;
+        for(unsigned i(0); i < grammar.num_variables(); ++i) {
+            graph.add_node(grammar.variable(i));
+        }
 
-                for(syms_following_V.rewind(); syms_following_V.match_next(); ) {
-                    for(unsigned i(0); i < s.length(); ++i) {
-                        if(s.at(i).is_terminal()) {
-                            terminal_type u(s.at(i));
-                            (*(follow[V.number()]))[u.number()] = true;
-                            goto next_production;
-                        }
+        for(unsigned prod(0), num_prods(grammar.num_productions());
+            prod < num_prods;
+            ++prod) {
 
-                        variable_type U(s.at(i));
+            const unsigned prod_var(grammar.production_variable(prod));
 
-                        if(U == V) {
-                            continue;
-                        }
+            const symbol_type *end(grammar.symbols_end(prod));
 
-                        updated = detail::union_into(follow[V.number()], first[U.number()]) || updated;
+            // every occurrence of a variable in the production, not
+            // just the first one, is followed by what comes after it
+            for(const symbol_type *V(grammar.symbols_begin(prod));
+                V != end;
+                ++V) {
 
-                        if(!nullable[U.number()]) {
-                            goto next_production;
-                        }
+                if(V->is_terminal()) {
+                    continue;
+                }
+
+                TerminalSet &V_follow(follow[V->number()]);
+                const symbol_type *sym(V + 1);
+
+                for(; sym != end; ++sym) {
+                    if(sym->is_terminal()) {
+                        V_follow.insert(sym->number());
+                        break;
                     }
 
-                    // reached the end of the production
-                    updated = detail::union_into(follow[V.number()], first[A.number()]) || updated;
+                    V_follow.insert_all(first[sym->number()]);
 
-                next_production:
-                    continue;
+                    if(!nullable[sym->number()]) {
+                        break;
+                    }
+                }
+
+                // reached the end of the production
+                if(sym == end && prod_var != V->number()) {
+                    graph.add_edge(V->number(), prod_var);
                 }
             }
         }
+
+        graph.close(follow);
+        detail::verbose_components(graph);
+    }
+
+    /// compute the follow sets for a CFG. the end of the input is
+    /// represented by the terminal number one past the last terminal.
+    template <typename AlphaT>
+    void compute_follow_set(
+        const fltl::CFG<AlphaT> &cfg,
+        const std::vector<bool> &nullable,
+        const std::vector<TerminalSet> &first,
+        std::vector<TerminalSet> &follow
+    ) throw() {
+        fltl::cfg::FrozenGrammar<AlphaT> grammar;
+        cfg.freeze(grammar);
+        compute_follow_set(grammar, nullable, first, follow);
     }
 
 }}
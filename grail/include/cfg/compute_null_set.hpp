@@ -35,66 +35,126 @@
 
 namespace grail { namespace cfg {
 
-    /// compute all nullable variables
+    /// compute all nullable variables of a frozen grammar, in time linear
+    /// in the size of the grammar
     template <typename AlphaT>
     void compute_null_set(
-        const fltl::CFG<AlphaT> &cfg,
+        const fltl::cfg::FrozenGrammar<AlphaT> &grammar,
         std::vector<bool> &nullable
     ) throw() {
 
-        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
+        typedef typename fltl::cfg::FrozenGrammar<AlphaT>::symbol_type
+                symbol_type;
+
+        enum {
+            NEVER_NULLABLE = ~0U
+        };
+
+        const unsigned num_vars(grammar.num_variables_capacity() + 2);
+        const unsigned num_prods(grammar.num_productions());
+
+        nullable.assign(num_vars, false);
 
-        variable_type V;
-        variable_type Q;
+        // the number of variables in each production that aren't yet known
+        // to be nullable; productions with terminals are never nullable
+        std::vector<unsigned> num_unknown(num_prods, 0U);
 
-        nullable.assign(cfg.num_variables_capacity() + 2, false);
+        // the productions that each variable occurs in, once for each
+        // occurrence, are in [occurrence_offsets[V], occurrence_offsets[V + 1])
+        // of occurrences
+        std::vector<unsigned> occurrence_offsets(num_vars + 1U, 0U);
+        std::vector<unsigned> occurrences;
 
-        // base case: directly nullable productions
-        generator_type null_prods(cfg.search((~V) --->* cfg.epsilon()));
-        for(; null_prods.match_next(); ) {
-            nullable[V.number()] = true;
+        // a variable is nullable if one of its productions is made up only
+        // of nullable variables; start from the epsilon productions
+        std::vector<unsigned> work_list;
+
+        for(unsigned prod(0); prod < num_prods; ++prod) {
+            const symbol_type *sym(grammar.symbols_begin(prod));
+            const symbol_type *end(grammar.symbols_end(prod));
+
+            for(; sym != end; ++sym) {
+                if(sym->is_terminal()) {
+                    num_unknown[prod] = NEVER_NULLABLE;
+                    break;
+                }
+                ++(num_unknown[prod]);
+            }
+
+            if(NEVER_NULLABLE == num_unknown[prod]) {
+                continue;
+            }
+
+            if(0 == num_unknown[prod]) {
+                const unsigned var(grammar.production_variable(prod));
+                if(!nullable[var]) {
+                    nullable[var] = true;
+                    work_list.push_back(var);
+                }
+                continue;
+            }
+
+            for(sym = grammar.symbols_begin(prod); sym != end; ++sym) {
+                ++(occurrence_offsets[sym->number() + 1U]);
+            }
         }
 
-        if(nullable.empty()) {
-            return;
+        for(unsigned var(0); var < num_vars; ++var) {
+            occurrence_offsets[var + 1U] += occurrence_offsets[var];
         }
 
-        bool found_nullable(true);
-        symbol_string_type str;
-        variable_type S;
-        generator_type productions(cfg.search((~V) --->* ~Q + ~str));
-        unsigned i(0);
-
-        // inductive step, build up the set of nullable variables
-        // incrementally
-        for(; found_nullable; productions.rewind()) {
-            found_nullable = false;
-            for(; productions.match_next(); ) {
-
-                // either this isn't a nullable production, or we know
-                // that this variable is nullable
-                if(nullable[V.number()] || !nullable[Q.number()]) {
-                    continue;
-                }
+        occurrences.resize(occurrence_offsets[num_vars]);
+        std::vector<unsigned> next_occurrence(
+            occurrence_offsets.begin(),
+            occurrence_offsets.end() - 1
+        );
+
+        for(unsigned prod(0); prod < num_prods; ++prod) {
+            if(NEVER_NULLABLE == num_unknown[prod]) {
+                continue;
+            }
+
+            const symbol_type *end(grammar.symbols_end(prod));
+            for(const symbol_type *sym(grammar.symbols_begin(prod));
+                sym != end;
+                ++sym) {
+                occurrences[next_occurrence[sym->number()]++] = prod;
+            }
+        }
 
-                for(i = 0; i < str.length(); ++i) {
-                    if(str.at(i).is_terminal()) {
-                        break;
-                    }
+        // each occurrence of a nullable variable is looked at once
+        for(; !work_list.empty(); ) {
+            const unsigned var(work_list.back());
+            work_list.pop_back();
 
-                    S = str.at(i);
-                    if(!nullable[S.number()]) {
-                        break;
-                    }
+            for(unsigned i(occurrence_offsets[var]);
+                i < occurrence_offsets[var + 1U];
+                ++i) {
+
+                const unsigned prod(occurrences[i]);
+                if(0 != --(num_unknown[prod])) {
+                    continue;
                 }
 
-                if(str.length() == i) {
-                    nullable[V.number()] = true;
-                    found_nullable = true;
+                const unsigned prod_var(grammar.production_variable(prod));
+                if(!nullable[prod_var]) {
+                    nullable[prod_var] = true;
+                    work_list.push_back(prod_var);
                 }
             }
         }
     }
+
+    /// compute all nullable variables
+    template <typename AlphaT>
+    void compute_null_set(
+        const fltl::CFG<AlphaT> &cfg,
+        std::vector<bool> &nullable
+    ) throw() {
+        fltl::cfg::FrozenGrammar<AlphaT> grammar;
+        cfg.freeze(grammar);
+        compute_null_set(grammar, nullable);
+    }
 }}
 
 #endif /* FLTL_FIND_NULLABLE_VARIABLES_HPP_ */
@@ -0,0 +1,125 @@
+/*
+ * CFG_COMPILE.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CLI_CFG_COMPILE_HPP_
+#define FLTL_CLI_CFG_COMPILE_HPP_
+
+#include <cstdio>
+
+#include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/fread_cfg.hpp"
+#include "grail/include/io/fwrite_cfg.hpp"
+
+namespace grail { namespace cli {
+
+    template <typename AlphaT>
+    class CFG_COMPILE {
+    public:
+
+        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
+
+        static const char * const TOOL_NAME;
+
+        static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
+            io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
+            if(!in_help) {
+                if(in.is_valid()) {
+                    opt.declare_max_num_positional(0);
+                } else {
+                    opt.declare_min_num_positional(1);
+                    opt.declare_max_num_positional(1);
+                }
+            }
+        }
+
+        static void help(void) throw() {
+            //  "  | |                              |                                             |"
+            printf(
+                "  %s:\n"
+                "    Compiles a context-free grammar (CFG) into a binary form and prints it\n"
+                "    out. Every tool that reads a CFG also reads the compiled form, which\n"
+                "    loads much faster than the text form for large grammars.\n\n"
+                "  basic use options for %s:\n"
+                "    --stdin                        Read a CFG from stdin. Typing a new\n"
+                "                                   line followed by Ctrl-D or Ctrl-Z will\n"
+                "                                   close stdin.\n"
+                "    <file>                         read in a CFG from <file>.\n\n",
+                TOOL_NAME, TOOL_NAME
+            );
+        }
+
+        static int main(io::CommandLineOptions &options) throw() {
+
+            // run the tool
+            io::option_type file;
+            const char *file_name(0);
+
+            FILE *fp(0);
+
+            if(options["stdin"].is_valid()) {
+                file = options["stdin"];
+                fp = stdin;
+                file_name = "<stdin>";
+            } else {
+                file = options[0U];
+                file_name = file.value();
+                fp = fopen(file_name, "r");
+            }
+
+            if(0 == fp) {
+                options.error(
+                    "Unable to open file containing context-free "
+                    "grammar for reading."
+                );
+                options.note("File specified here:", file);
+                return 1;
+            }
+
+            cfg_type cfg;
+            int ret(0);
+
+            if(io::fread(fp, cfg, file_name)) {
+                if(!io::fwrite(stdout, cfg) || 0 != fflush(stdout)) {
+                    options.error("Unable to write out the compiled grammar.");
+                    ret = 1;
+                }
+            } else {
+                ret = 1;
+            }
+
+            fclose(fp);
+
+            return ret;
+        }
+    };
+
+    template <typename AlphaT>
+    const char * const CFG_COMPILE<AlphaT>::TOOL_NAME("cfg-compile");
+}}
+
+#endif /* FLTL_CLI_CFG_COMPILE_HPP_ */
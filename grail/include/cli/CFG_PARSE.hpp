@@ -31,8 +31,13 @@
 
 #include <set>
 #include <vector>
+#include <cstdlib>
 #include <cstring>
 
+#ifndef GRAIL_USE_JS
+#include <pthread.h>
+#endif
+
 #include "fltl/include/CFG.hpp"
 
 #include "fltl/include/helper/Array.hpp"
@@ -41,12 +46,22 @@
 #include "grail/include/io/fread_cfg.hpp"
 #include "grail/include/io/verbose.hpp"
 #include "grail/include/io/UTF8FileTokBuffer.hpp"
+#include "grail/include/io/TokenRecord.hpp"
+#include "grail/include/io/fprint_parse_tree.hpp"
+#include "grail/include/io/fprint_parse_forest.hpp"
 
-#include "grail/include/cfg/compute_null_set.hpp"
-#include "grail/include/cfg/compute_first_set.hpp"
+#include "grail/include/cfg/GrammarAnalyses.hpp"
 #include "grail/include/cfg/ParseTree.hpp"
+#include "grail/include/cfg/ParseForest.hpp"
+#include "grail/include/cfg/EarleyParser.hpp"
+#include "grail/include/cfg/LL1Table.hpp"
+#include "grail/include/cfg/LALR1Table.hpp"
 
 #include "grail/include/algorithm/CFG_PARSE_EARLEY.hpp"
+#include "grail/include/algorithm/CFG_PARSE_CYK.hpp"
+#include "grail/include/algorithm/CFG_PARSE_LL1.hpp"
+#include "grail/include/algorithm/CFG_PARSE_LALR1.hpp"
+#include "grail/include/algorithm/CFG_TO_CNF.hpp"
 
 namespace grail { namespace cli {
 
@@ -57,12 +72,389 @@ namespace grail { namespace cli {
         typedef fltl::CFG<AlphaT> CFG;
         typedef typename CFG::terminal_type terminal_type;
 
+        typedef cfg::EarleyParser<AlphaT> parser_type;
+        typedef algorithm::CFG_PARSE_CYK<AlphaT> cyk_parser_type;
+        typedef algorithm::CFG_PARSE_LL1<AlphaT> ll1_parser_type;
+        typedef cfg::LL1Table<AlphaT> ll1_table_type;
+        typedef algorithm::CFG_PARSE_LALR1<AlphaT> lalr1_parser_type;
+        typedef cfg::LALR1Table<AlphaT> lalr1_table_type;
+        typedef cfg::ParseForest<AlphaT> forest_type;
+        typedef io::UTF8FileTokBuffer<1024U> reader_type;
+
         static const char * const TOOL_NAME;
 
+    private:
+
+        enum {
+            // how many records each job gets in a batch
+            RECORDS_PER_JOB = 256U
+        };
+
+        /// the parsing engines; by default, the LL(1) engine is used if the
+        /// grammar is LL(1), then the LALR(1) engine if the grammar is
+        /// LALR(1), and the Earley engine otherwise
+        enum {
+            ENGINE_DEFAULT,
+            ENGINE_EARLEY,
+            ENGINE_CYK,
+            ENGINE_LL1,
+            ENGINE_LALR1
+        };
+
+        /// records that are read in together and then parsed, possibly by
+        /// several jobs at once
+        class batch_type {
+        public:
+
+            std::vector<io::TokenRecord> records;
+
+            // the name of the input that each record came from
+            std::vector<const char *> names;
+
+            // verdict of each record; these are chars and not bools so that
+            // jobs can store them at the same time
+            std::vector<char> verdicts;
+
+            unsigned num_records;
+
+            // next record to be taken by a job
+            unsigned next_record;
+
+#ifndef GRAIL_USE_JS
+            pthread_mutex_t lock;
+#endif
+
+            batch_type(void) throw()
+                : records()
+                , names()
+                , verdicts()
+                , num_records(0)
+                , next_record(0)
+            {
+#ifndef GRAIL_USE_JS
+                pthread_mutex_init(&lock, 0);
+#endif
+            }
+
+            ~batch_type(void) throw() {
+#ifndef GRAIL_USE_JS
+                pthread_mutex_destroy(&lock);
+#endif
+            }
+        };
+
+#ifndef GRAIL_USE_JS
+
+        /// a job parsing records of a batch with its own parser
+        template <typename ParserT>
+        class job_type {
+        public:
+            ParserT *parser;
+            batch_type *batch;
+            pthread_t thread;
+        };
+
+        /// parse records of a batch until there are none left
+        template <typename ParserT>
+        static void *run_job(void *job_) throw() {
+            job_type<ParserT> *job(static_cast<job_type<ParserT> *>(job_));
+            batch_type *batch(job->batch);
+
+            for(;;) {
+                pthread_mutex_lock(&(batch->lock));
+                const unsigned i(batch->next_record++);
+                pthread_mutex_unlock(&(batch->lock));
+
+                if(i >= batch->num_records) {
+                    break;
+                }
+
+                batch->verdicts[i] = job->parser->parse(
+                    batch->records[i],
+                    0
+                ) ? 1 : 0;
+            }
+
+            return 0;
+        }
+#endif
+
+        /// print out the verdict of one record
+        static void print_verdict(const char *name, const bool verdict) throw() {
+            if(0 != name) {
+                printf("%s: ", name);
+            }
+            printf("%s\n", verdict ? "Yes." : "No.");
+        }
+
+        /// print out the forest or one parse tree of an accepted input
+        static void print_derivations(
+            const CFG &cfg,
+            forest_type &forest,
+            const bool print_forest,
+            const bool print_tree
+        ) throw() {
+            if(print_forest) {
+                io::fprint(stdout, cfg, forest);
+            }
+
+            if(print_tree) {
+                cfg::ParseTree<AlphaT> *tree(forest.extract_tree());
+                io::fprint(stdout, cfg, tree, io::tree_language());
+                delete tree;
+            }
+        }
+
+        /// parse and print out the verdicts of all records of a batch.
+        /// each parser is used by one job.
+        template <typename ParserT>
+        static void parse_batch(
+            const CFG &cfg,
+            std::vector<ParserT *> &parsers,
+            batch_type &batch,
+            const bool print_names,
+            forest_type *forest,
+            const bool print_forest,
+            const bool print_tree
+        ) throw() {
+
+            // parse the records one after the other, printing out their
+            // derivations if asked for
+            if(1U == parsers.size()) {
+                for(unsigned i(0); i < batch.num_records; ++i) {
+                    const bool verdict(parsers[0]->parse(
+                        batch.records[i],
+                        forest
+                    ));
+
+                    print_verdict(print_names ? batch.names[i] : 0, verdict);
+                    if(verdict && 0 != forest) {
+                        print_derivations(cfg, *forest, print_forest, print_tree);
+                    }
+                }
+                return;
+            }
+
+#ifndef GRAIL_USE_JS
+            std::vector<job_type<ParserT> > jobs(parsers.size());
+            batch.next_record = 0;
+
+            for(unsigned i(0); i < jobs.size(); ++i) {
+                jobs[i].parser = parsers[i];
+                jobs[i].batch = &batch;
+                pthread_create(
+                    &(jobs[i].thread),
+                    0,
+                    &run_job<ParserT>,
+                    &(jobs[i])
+                );
+            }
+
+            for(unsigned i(0); i < jobs.size(); ++i) {
+                pthread_join(jobs[i].thread, 0);
+            }
+
+            for(unsigned i(0); i < batch.num_records; ++i) {
+                print_verdict(
+                    print_names ? batch.names[i] : 0,
+                    0 != batch.verdicts[i]
+                );
+            }
+#endif
+        }
+
+        /// parse every record of every input, a batch at a time. returns
+        /// false if an input couldn't be opened.
+        template <typename ParserT>
+        static bool parse_records(
+            io::CommandLineOptions &options,
+            const CFG &cfg,
+            std::vector<ParserT *> &parsers,
+            std::vector<io::option_type> &inputs,
+            const char *delim_chars,
+            const char *separator,
+            forest_type *forest,
+            const bool print_forest,
+            const bool print_tree
+        ) throw() {
+
+            const unsigned batch_size(static_cast<unsigned>(
+                RECORDS_PER_JOB * parsers.size()
+            ));
+            const bool print_names(1U < inputs.size());
+
+            batch_type batch;
+            batch.records.resize(batch_size);
+            batch.names.resize(batch_size);
+            batch.verdicts.resize(batch_size);
+
+            FILE *fp(0);
+            const char *file_name(0);
+            reader_type *reader(0);
+            unsigned next_input(0);
+            bool opened_all(true);
+
+            for(;;) {
+
+                // read in the next batch of records
+                for(batch.num_records = 0;
+                    batch.num_records < batch_size; ) {
+
+                    if(0 == reader) {
+                        if(next_input >= inputs.size() || !opened_all) {
+                            break;
+                        }
+
+                        io::option_type &input(inputs[next_input++]);
+                        if(options["stdin"].is_valid()) {
+                            fp = stdin;
+                            file_name = "<stdin>";
+                        } else {
+                            file_name = input.value();
+                            fp = fopen(file_name, "r");
+                        }
+
+                        if(0 == fp) {
+                            options.error(
+                                "Unable to open file containing tokens to "
+                                "be parsed."
+                            );
+                            options.note("File specified here:", input);
+                            opened_all = false;
+                            break;
+                        }
+
+                        reader = new reader_type(fp, delim_chars);
+                        reader->reset();
+                    }
+
+                    io::TokenRecord &record(batch.records[batch.num_records]);
+                    const bool has_record(record.fill(*reader, separator));
+
+                    // without a separator, each input is one record, even
+                    // if it is empty
+                    if(has_record || 0 == separator) {
+                        batch.names[batch.num_records++] = file_name;
+                    }
+
+                    if(!has_record || 0 == separator) {
+                        delete reader;
+                        reader = 0;
+                        if(stdin != fp) {
+                            fclose(fp);
+                        }
+                    }
+                }
+
+                if(0 == batch.num_records) {
+                    break;
+                }
+
+                parse_batch(
+                    cfg,
+                    parsers,
+                    batch,
+                    print_names,
+                    forest,
+                    print_forest,
+                    print_tree
+                );
+            }
+
+            if(0 != reader) {
+                delete reader;
+                if(stdin != fp) {
+                    fclose(fp);
+                }
+            }
+
+            return opened_all;
+        }
+
+        template <typename ParserT>
+        static void delete_parsers(std::vector<ParserT *> &parsers) throw() {
+            for(unsigned i(0); i < parsers.size(); ++i) {
+                delete parsers[i];
+                parsers[i] = 0;
+            }
+        }
+
+        /// parse the inputs with one parser per job. a single input is
+        /// parsed as it is read; otherwise, records are parsed in batches.
+        /// returns false if an input couldn't be opened.
+        template <typename ParserT>
+        static bool parse_inputs(
+            io::CommandLineOptions &options,
+            const CFG &cfg,
+            std::vector<ParserT *> &parsers,
+            std::vector<io::option_type> &inputs,
+            const char *delim_chars,
+            const char *separator,
+            const bool use_batch,
+            forest_type *forest,
+            const bool print_forest,
+            const bool print_tree
+        ) throw() {
+
+            if(use_batch) {
+                return parse_records(
+                    options,
+                    cfg,
+                    parsers,
+                    inputs,
+                    delim_chars,
+                    separator,
+                    forest,
+                    print_forest,
+                    print_tree
+                );
+            }
+
+            FILE *fp(stdin);
+            if(!options["stdin"].is_valid()) {
+                fp = fopen(inputs[0].value(), "r");
+            }
+
+            if(0 == fp) {
+                options.error(
+                    "Unable to open file containing tokens to be parsed."
+                );
+                options.note("File specified here:", inputs[0]);
+                return false;
+            }
+
+            reader_type reader(fp, delim_chars);
+            reader.reset();
+
+            if(parsers[0]->parse(reader, forest)) {
+                printf("Yes.\n");
+                if(0 != forest) {
+                    print_derivations(cfg, *forest, print_forest, print_tree);
+                }
+            } else {
+                printf("No.\n");
+            }
+
+            if(stdin != fp) {
+                fclose(fp);
+            }
+
+            return true;
+        }
+
+    public:
+
         static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
 
             opt.declare("predict", io::opt::OPTIONAL, io::opt::NO_VAL);
+            opt.declare("leo", io::opt::OPTIONAL, io::opt::NO_VAL);
+            opt.declare("engine", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("forest", io::opt::OPTIONAL, io::opt::NO_VAL);
+            opt.declare("tree", io::opt::OPTIONAL, io::opt::NO_VAL);
             opt.declare("delim", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("records", io::opt::OPTIONAL, io::opt::NO_VAL);
+            opt.declare("record-sep", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("jobs", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
 
             io::option_type in(opt.declare(
                 "stdin",
@@ -76,7 +468,6 @@ namespace grail { namespace cli {
                     opt.declare_max_num_positional(1);
                 } else {
                     opt.declare_min_num_positional(2);
-                    opt.declare_max_num_positional(2);
                 }
             }
         }
@@ -87,20 +478,53 @@ namespace grail { namespace cli {
                 "  %s:\n"
                 "    Parses a token stream according to a context-free grammar (CFG).\n\n"
                 "  basic use options for %s:\n"
-                "    --predict                      compute the FIRST sets of all\n"
-                "                                   variables. This computation can\n"
-                "                                   take a long time for larger\n"
-                "                                   grammars, but can also speed up\n"
-                "                                   parsing.\n"
+                "    --predict                      make the Earley engine use the FIRST\n"
+                "                                   sets of the variables to predict\n"
+                "                                   fewer items. No other engine is\n"
+                "                                   changed by this option. When no\n"
+                "                                   engine is given, the FIRST and\n"
+                "                                   FOLLOW sets and the LL(1) table are\n"
+                "                                   always computed, and so are the\n"
+                "                                   LALR(1) tables if the grammar isn't\n"
+                "                                   LL(1).\n"
+                "    --leo                          use Leo's transitive items to parse\n"
+                "                                   right-recursive rules in linear\n"
+                "                                   time and space.\n"
+                "    --engine=<name>                parse using the engine <name>, which is\n"
+                "                                   one of earley, cyk, ll1, or lalr1. By\n"
+                "                                   default, ll1 is used if the grammar is\n"
+                "                                   LL(1), lalr1 is used if the grammar is\n"
+                "                                   LALR(1), and earley is used otherwise.\n"
+                "                                   The cyk engine first converts the grammar\n"
+                "                                   to Chomsky normal form; parse trees are\n"
+                "                                   of the converted grammar.\n"
+                "    --forest                       print out the shared packed parse\n"
+                "                                   forest of all derivations of the\n"
+                "                                   input if it is accepted.\n"
+                "    --tree                         print out one parse tree of the input\n"
+                "                                   if it is accepted. Only the nodes of\n"
+                "                                   that tree are visited, no matter how\n"
+                "                                   ambiguous the grammar is.\n"
                 "    --stdin                        Take the input tokens from standard input.\n"
                 "                                   Each token should be separated by a new\n"
                 "                                   line. Typing a new line followed by Ctrl-D\n"
                 "                                   or Ctrl-Z will close stdin.\n"
                 "    --delim                        Change the delimiter of tokens from newlines\n"
                 "                                   to any character present in delim.\n"
+                "    --records                      Each input holds many records, each ended\n"
+                "                                   by a separator token. One verdict is\n"
+                "                                   printed per record.\n"
+                "    --record-sep=<sep>             Change the separator token of records from\n"
+                "                                   %%%% to <sep>.\n"
+                "    --jobs=<n>                     Parse the records of the inputs using <n>\n"
+                "                                   threads. Verdicts are still printed in\n"
+                "                                   the order of the records.\n"
                 "    <file0>                        read in a CFG from <file>.\n"
-                "    <file1>                        read in a newline-separated list of tokens\n"
-                "                                   from <file1> if --stdin is not used.\n\n",
+                "    <file1> ...                    read in a newline-separated list of tokens\n"
+                "                                   from each of <file1> ... if --stdin is\n"
+                "                                   not used. If there is more than one\n"
+                "                                   input then each verdict is prefixed by\n"
+                "                                   the name of its input.\n\n",
                 TOOL_NAME, TOOL_NAME
             );
         }
@@ -147,64 +571,209 @@ namespace grail { namespace cli {
         static int main(io::CommandLineOptions &options) throw() {
 
             // run the tool
-            io::option_type file[2];
-            const char *file_name[2] = {0};
-            FILE *fp[2] = {0};
+            io::option_type file;
+            const char *file_name(0);
+            FILE *fp(0);
 
-            file[0] = options[0U];
-            file_name[0] = file[0].value();
-            fp[0] = fopen(file_name[0], "r");
+            file = options[0U];
+            file_name = file.value();
+            fp = fopen(file_name, "r");
 
-            if(0 == fp[0]) {
+            if(0 == fp) {
                 options.error(
                     "Unable to open file containing context-free "
                     "grammar for reading."
                 );
-                options.note("File specified here:", file[0]);
+                options.note("File specified here:", file);
 
                 return 1;
             }
 
-            file[1] = options["stdin"];
-            if(file[1].is_valid()) {
-                fp[1] = stdin;
-                file_name[1] = "<stdin>";
+            // collect the inputs to be parsed
+            std::vector<io::option_type> inputs;
+            if(options["stdin"].is_valid()) {
+                inputs.push_back(options["stdin"]);
             } else {
-                file[1] = options[1U];
-                file_name[1] = file[1].value();
-                fp[1] = fopen(file_name[1], "r");
+                for(unsigned i(1U); options[i].is_valid(); ++i) {
+                    inputs.push_back(options[i]);
+                }
             }
 
-            if(0 == fp[1]) {
-                options.error(
-                    "Unable to open file containing tokens to be parsed."
-                );
-                options.note("File specified here:", file[1]);
+            unsigned num_jobs(1U);
+            io::option_type jobs(options["jobs"]);
+            if(jobs.is_valid()) {
+                char *end(0);
+                const unsigned long val(strtoul(jobs.value(), &end, 10));
+
+                if(0 == val || '\0' != *end) {
+                    options.error(
+                        "The number of jobs must be a positive integer."
+                    );
+                    options.note("Error was caused by this option:", jobs);
+                } else {
+                    num_jobs = static_cast<unsigned>(val);
+                }
 
-                if(0 != fp[0]) {
-                    fclose(fp[0]);
+#ifdef GRAIL_USE_JS
+                if(1U < num_jobs) {
+                    io::verbose("Ignoring --jobs; threads are not supported.\n");
+                    num_jobs = 1U;
                 }
+#endif
+            }
 
-                return 1;
+            unsigned engine_kind(ENGINE_DEFAULT);
+            io::option_type engine(options["engine"]);
+            if(engine.is_valid()) {
+                if(0 == strcmp("earley", engine.value())) {
+                    engine_kind = ENGINE_EARLEY;
+                } else if(0 == strcmp("cyk", engine.value())) {
+                    engine_kind = ENGINE_CYK;
+                } else if(0 == strcmp("ll1", engine.value())) {
+                    engine_kind = ENGINE_LL1;
+                } else if(0 == strcmp("lalr1", engine.value())) {
+                    engine_kind = ENGINE_LALR1;
+                } else {
+                    options.error(
+                        "Unknown parsing engine '%s'. The supported engines "
+                        "are earley, cyk, ll1, and lalr1.",
+                        engine.value()
+                    );
+                    options.note("Engine specified here:", engine);
+                }
             }
 
+            const bool use_cyk(ENGINE_CYK == engine_kind);
+
+            const bool print_forest(options["forest"].is_valid());
+            const bool print_tree(options["tree"].is_valid());
+
+            if((print_forest || print_tree) && 1U < num_jobs) {
+                options.error(
+                    "Parse forests and trees can only be printed when "
+                    "using one job."
+                );
+                options.note("Jobs specified here:", jobs);
+            }
+
+            io::option_type record_sep(options["record-sep"]);
+            const bool use_records(
+                options["records"].is_valid() || record_sep.is_valid()
+            );
+            const bool use_batch(
+                use_records || 1U < inputs.size() || 1U < num_jobs
+            );
+
             CFG cfg;
             int ret(0);
 
-            if(io::fread(fp[0], cfg, file_name[0])) {
+            if(!options.has_error() && io::fread(fp, cfg, file_name)) {
 
-                std::vector<bool> is_nullable;
-                std::vector<std::vector<bool> *> first_terminals;
+                // the NULL and FIRST sets are kept along with the grammar
+                const std::vector<bool> *is_nullable(0);
+                const std::vector<cfg::TerminalSet> *first_terminals(0);
 
-                // fill the first and nullable sets
-                io::verbose("Computing NULL set of variables...\n");
-                cfg::compute_null_set(cfg, is_nullable);
+                // the CYK engine only works on grammars in Chomsky normal
+                // form, and doesn't need the NULL or FIRST sets
+                if(use_cyk) {
+                    io::verbose("Converting grammar to Chomsky normal form...\n");
+                    algorithm::CFG_TO_CNF<AlphaT>::run(cfg);
 
-                bool use_first_sets(false);
-                if(options["predict"].is_valid()) {
+                    // the conversion removes variables, and the CYK chart
+                    // has a bit per variable number
+                    cfg.compact();
+                }
+
+                if(!use_cyk) {
+                    io::verbose("Computing NULL set of variables...\n");
+                    is_nullable = &(cfg::nullable(cfg));
+                }
+
+                // the LL(1) and LALR(1) engines can only be used on
+                // grammars with a start variable
+                const bool has_start(
+                    0 != cfg.num_productions() && cfg.has_start_variable()
+                );
+
+                bool try_ll1(
+                    (ENGINE_DEFAULT == engine_kind || ENGINE_LL1 == engine_kind)
+                    && has_start
+                );
+
+                const bool use_first_sets(
+                    !use_cyk && options["predict"].is_valid()
+                );
+                if(use_first_sets || try_ll1) {
                     io::verbose("Computing FIRST set of variables...\n");
-                    use_first_sets = true;
-                    cfg::compute_first_terminals(cfg, is_nullable, first_terminals);
+                    first_terminals = &(cfg::first(cfg));
+                }
+
+                // build the LL(1) table, and fall back to the Earley engine
+                // if the grammar isn't LL(1)
+                ll1_table_type ll1_table;
+                if(try_ll1) {
+                    io::verbose("Computing FOLLOW set of variables...\n");
+                    const std::vector<cfg::TerminalSet> &follow_terminals(
+                        cfg::follow(cfg)
+                    );
+
+                    io::verbose("Building LL(1) table...\n");
+                    ll1_table.compile(
+                        cfg, *is_nullable, *first_terminals, follow_terminals
+                    );
+
+                    if(0 != ll1_table.get_num_conflicts()) {
+                        try_ll1 = false;
+                        io::verbose(
+                            "Grammar is not LL(1); %u cells of the LL(1) "
+                            "table have conflicts.\n",
+                            ll1_table.get_num_conflicts()
+                        );
+                    }
+                }
+
+                if(ENGINE_LL1 == engine_kind && !try_ll1) {
+                    options.error(
+                        "The LL(1) engine can't be used because the grammar "
+                        "is not LL(1). Use the cfg-to-ll1 tool to see the "
+                        "conflicts."
+                    );
+                    options.note("Engine specified here:", engine);
+                }
+
+                // build the LALR(1) tables if the grammar isn't LL(1), and
+                // fall back to the Earley engine if the grammar isn't
+                // LALR(1)
+                bool try_lalr1(
+                    (ENGINE_DEFAULT == engine_kind || ENGINE_LALR1 == engine_kind)
+                    && has_start
+                    && !try_ll1
+                );
+
+                lalr1_table_type lalr1_table;
+                if(try_lalr1) {
+                    io::verbose("Building LALR(1) tables...\n");
+                    lalr1_table.compile(cfg, *is_nullable);
+
+                    if(!lalr1_table.get_conflicts().empty()) {
+                        try_lalr1 = false;
+                        io::verbose(
+                            "Grammar is not LALR(1); the LALR(1) tables have "
+                            "%u conflicts.\n",
+                            static_cast<unsigned>(
+                                lalr1_table.get_conflicts().size()
+                            )
+                        );
+                    }
+                }
+
+                if(ENGINE_LALR1 == engine_kind && !try_lalr1) {
+                    options.error(
+                        "The LALR(1) engine can't be used because the grammar "
+                        "is not LALR(1). Use the cfg-to-lalr1 tool to see the "
+                        "conflicts."
+                    );
+                    options.note("Engine specified here:", engine);
                 }
 
                 io::verbose("Parsing...\n");
@@ -216,22 +785,96 @@ namespace grail { namespace cli {
                     delim_chars = interpret_delim(options, delim);
                 }
 
-                if(!options.has_error()) {
-
-                    io::UTF8FileTokBuffer<1024U> reader(fp[1], delim_chars);
-                    reader.reset();
-
-                    if(algorithm::CFG_PARSE_EARLEY<AlphaT, 1024U>::run(
-                        cfg,
-                        is_nullable,
-                        use_first_sets,
-                        first_terminals,
-                        reader
-                    )) {
-                        printf("Yes.\n");
-                    } else {
-                        printf("No.\n");
+                const bool use_leo(options["leo"].is_valid());
+                forest_type forest;
+                forest_type *derivations(
+                    (print_forest || print_tree) ? &forest : 0
+                );
+
+                if((print_forest || print_tree) && use_leo) {
+                    io::verbose(
+                        "Ignoring --leo because a parse forest is being "
+                        "built.\n"
+                    );
+                }
+
+                const char *separator(0);
+                if(record_sep.is_valid()) {
+                    separator = record_sep.value();
+                } else if(use_records) {
+                    separator = "%%";
+                }
+
+                // each job has its own parser, but they all share the
+                // grammar
+                bool parsed(true);
+                if(options.has_error()) {
+                    parsed = false;
+
+                } else if(try_ll1) {
+                    io::verbose("Using the LL(1) engine.\n");
+
+                    std::vector<ll1_parser_type *> parsers(num_jobs);
+                    for(unsigned i(0); i < num_jobs; ++i) {
+                        parsers[i] = new ll1_parser_type(cfg, ll1_table);
                     }
+
+                    parsed = parse_inputs(
+                        options, cfg, parsers, inputs, delim_chars, separator,
+                        use_batch, derivations, print_forest, print_tree
+                    );
+
+                    delete_parsers(parsers);
+
+                } else if(try_lalr1) {
+                    io::verbose("Using the LALR(1) engine.\n");
+
+                    std::vector<lalr1_parser_type *> parsers(num_jobs);
+                    for(unsigned i(0); i < num_jobs; ++i) {
+                        parsers[i] = new lalr1_parser_type(cfg, lalr1_table);
+                    }
+
+                    parsed = parse_inputs(
+                        options, cfg, parsers, inputs, delim_chars, separator,
+                        use_batch, derivations, print_forest, print_tree
+                    );
+
+                    delete_parsers(parsers);
+
+                } else if(use_cyk) {
+                    std::vector<cyk_parser_type *> parsers(num_jobs);
+                    for(unsigned i(0); i < num_jobs; ++i) {
+                        parsers[i] = new cyk_parser_type(cfg);
+                    }
+
+                    parsed = parse_inputs(
+                        options, cfg, parsers, inputs, delim_chars, separator,
+                        use_batch, derivations, print_forest, print_tree
+                    );
+
+                    delete_parsers(parsers);
+
+                } else {
+                    std::vector<parser_type *> parsers(num_jobs);
+                    for(unsigned i(0); i < num_jobs; ++i) {
+                        parsers[i] = new parser_type(
+                            cfg,
+                            *is_nullable,
+                            use_first_sets ? first_terminals : 0
+                        );
+                        parsers[i]->set_use_leo(use_leo);
+                    }
+
+                    parsed = parse_inputs(
+                        options, cfg, parsers, inputs, delim_chars, separator,
+                        use_batch, derivations, print_forest, print_tree
+                    );
+
+                    delete_parsers(parsers);
+                }
+
+                if(!parsed) {
+                    ret = 1;
                 }
 
                 // clean up the custom delimiter string
@@ -239,20 +882,11 @@ namespace grail { namespace cli {
                     delete [] delim_chars;
                 }
 
-                // clean out the first set
-                for(unsigned i(0); i < first_terminals.size(); ++i) {
-                    if(0 != first_terminals[i]) {
-                        delete (first_terminals[i]);
-                        first_terminals[i] = 0;
-                    }
-                }
-
             } else {
                 ret = 1;
             }
 
-            fclose(fp[0]);
-            fclose(fp[1]);
+            fclose(fp);
 
             return ret;
         }
@@ -0,0 +1,330 @@
+/*
+ * CFG_TO_LALR1.hpp
+ *
+ *  Created on: May 27, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef Grail_Plus_CFG_TO_LALR1_HPP_
+#define Grail_Plus_CFG_TO_LALR1_HPP_
+
+#include <cstdio>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/cfg/compute_null_set.hpp"
+#include "grail/include/cfg/LALR1Table.hpp"
+
+#include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/fread_cfg.hpp"
+#include "grail/include/io/fprint_cfg.hpp"
+#include "grail/include/io/error.hpp"
+
+namespace grail { namespace cli {
+
+    template <typename AlphaT>
+    class CFG_TO_LALR1 {
+    public:
+
+        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
+
+        typedef grail::cfg::LALR1Table<AlphaT> table_type;
+        typedef typename table_type::rule_table_type rule_table_type;
+        typedef typename table_type::conflict_type conflict_type;
+
+        static const char * const TOOL_NAME;
+
+        static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
+            if(!in_help) {
+                opt.declare_min_num_positional(1);
+                opt.declare_max_num_positional(1);
+            }
+        }
+
+        static void help(void) throw() {
+            //  "  | |                              |                                             |"
+            printf(
+                "  %s:\n"
+                "    Builds the LALR(1) parser automaton of a Context-free Grammar (CFG) and\n"
+                "    outputs its states, actions, and gotos. Shift/reduce and reduce/reduce\n"
+                "    conflicts are reported as warnings and resolved in favour of shifting,\n"
+                "    and then in favour of the production that comes first.\n\n"
+                "  basic use options for %s:\n"
+                "    <file>                         read in a CFG from <file>.\n\n",
+                TOOL_NAME, TOOL_NAME
+            );
+        }
+
+        /// print out the terminal of a column of the action table
+        static void print_column(
+            FILE *ff,
+            const cfg_type &cfg,
+            const table_type &table,
+            const std::vector<terminal_type> &terminals,
+            const unsigned column
+        ) throw() {
+            if(table_type::UNKNOWN_TOKEN == column) {
+                fprintf(ff, "<unknown>");
+            } else if(table.end_column() == column) {
+                fprintf(ff, "$end");
+            } else {
+                io::fprint(ff, cfg, terminals[column]);
+            }
+        }
+
+        /// print out a dotted rule
+        static void print_item(
+            FILE *ff,
+            const cfg_type &cfg,
+            const rule_table_type &rules,
+            const unsigned id
+        ) throw() {
+            if(id <= rule_table_type::ACCEPT_RULE) {
+                fprintf(ff, "    $accept ->%s %s%s\n",
+                    rule_table_type::START_RULE == id ? " ." : "",
+                    cfg.get_name(cfg.get_start_variable()),
+                    rule_table_type::ACCEPT_RULE == id ? " ." : ""
+                );
+                return;
+            }
+
+            const production_type &prod(rules.production(id));
+            const symbol_string_type syms(prod.symbols());
+            const unsigned dot(rules[id].dot);
+
+            fprintf(ff, "    %s ->", cfg.get_name(prod.variable()));
+            for(unsigned i(0); i < syms.length(); ++i) {
+                if(i == dot) {
+                    fprintf(ff, " .");
+                }
+                fprintf(ff, " ");
+                io::fprint(ff, cfg, syms.at(i));
+            }
+            if(dot == syms.length()) {
+                fprintf(ff, " .");
+            }
+            fprintf(ff, "\n");
+        }
+
+        /// print out what an action does
+        static void print_action(
+            FILE *ff,
+            const cfg_type &cfg,
+            const rule_table_type &rules,
+            const unsigned action
+        ) throw() {
+            const unsigned arg(action >> table_type::ACTION_BITS);
+
+            switch(action & table_type::ACTION_MASK) {
+            case table_type::SHIFT_ACTION:
+                fprintf(ff, "shift, and go to state %u\n", arg);
+                break;
+            case table_type::REDUCE_ACTION:
+                fprintf(ff, "reduce using ");
+                io::fprint(ff, cfg, rules.production(arg));
+                break;
+            case table_type::ACCEPT_ACTION:
+                fprintf(ff, "accept\n");
+                break;
+            default:
+                fprintf(ff, "error\n");
+                break;
+            }
+        }
+
+        /// shifts only conflict with each other on unknown tokens, which
+        /// can be any variable terminal
+        static const char *conflict_kind(const conflict_type &conflict) throw() {
+            if(table_type::SHIFT_ACTION
+                != (conflict.chosen & table_type::ACTION_MASK)) {
+                return "Reduce/reduce";
+            } else if(table_type::SHIFT_ACTION
+                == (conflict.dropped & table_type::ACTION_MASK)) {
+                return "Shift/shift";
+            }
+            return "Shift/reduce";
+        }
+
+        static void report_conflict(
+            const cfg_type &cfg,
+            const table_type &table,
+            const std::vector<terminal_type> &terminals,
+            const conflict_type &conflict
+        ) throw() {
+            io::warning(
+                "%s conflict in state %u.",
+                conflict_kind(conflict),
+                conflict.state
+            );
+
+            fprintf(stderr, "         on input ");
+            print_column(stderr, cfg, table, terminals, conflict.column);
+            fprintf(stderr, "\n         chosen: ");
+            print_action(stderr, cfg, table.get_rules(), conflict.chosen);
+            fprintf(stderr, "         dropped: ");
+            print_action(stderr, cfg, table.get_rules(), conflict.dropped);
+            fprintf(stderr, "\n");
+        }
+
+        static int main(io::CommandLineOptions &options) throw() {
+
+            FILE *fp(0);
+            FILE *outfile(stdout);
+
+            io::option_type file(options[0U]);
+            const char *file_name(file.value());
+            fp = fopen(file_name, "r");
+
+            if(0 == fp) {
+
+                options.error(
+                    "Unable to open file containing context-free "
+                    "grammar for reading."
+                );
+                options.note("File specified here:", file);
+
+                return 1;
+            }
+
+            int ret(0);
+            cfg_type cfg;
+            table_type table;
+            std::vector<bool> nullable;
+            std::vector<terminal_type> terminals;
+
+            terminal_type a;
+            generator_type as(cfg.search(~a));
+
+            unsigned num_vars(0);
+            unsigned num_sr(0);
+            unsigned num_rr(0);
+            unsigned num_ss(0);
+
+            if(!io::fread(fp, cfg, file_name)) {
+                ret = 1;
+                goto done;
+            }
+
+            if(0 == cfg.num_productions() || !cfg.has_start_variable()) {
+                options.error(
+                    "The context-free grammar has no start variable, and so "
+                    "no parser can be built for it."
+                );
+                ret = 1;
+                goto done;
+            }
+
+            grail::cfg::compute_null_set(cfg, nullable);
+            table.compile(cfg, nullable);
+
+            terminals.assign(cfg.num_terminals() + 2U, terminal_type());
+            for(; as.match_next(); ) {
+                terminals[a.number()] = a;
+            }
+
+            num_vars = table.get_rules().num_variables();
+
+            for(unsigned state(0); state < table.num_states(); ++state) {
+                fprintf(outfile, "state %u\n\n", state);
+
+                for(const unsigned *item(table.kernel_items_begin(state)),
+                                   *end(table.kernel_items_end(state));
+                    item != end;
+                    ++item) {
+                    print_item(outfile, cfg, table.get_rules(), *item);
+                }
+
+                fprintf(outfile, "\n");
+
+                const unsigned default_action(table.default_action(state));
+                for(unsigned t(0); t < table.get_num_columns(); ++t) {
+                    const unsigned action(table.action(state, t));
+                    if(table_type::ERROR_ACTION == action
+                    || default_action == action) {
+                        continue;
+                    }
+
+                    fprintf(outfile, "    ");
+                    print_column(outfile, cfg, table, terminals, t);
+                    fprintf(outfile, "  ");
+                    print_action(outfile, cfg, table.get_rules(), action);
+                }
+
+                if(table_type::ERROR_ACTION != default_action) {
+                    fprintf(outfile, "    $default  ");
+                    print_action(
+                        outfile, cfg, table.get_rules(), default_action
+                    );
+                }
+
+                for(unsigned v(1); v < num_vars; ++v) {
+                    const unsigned next(table.goto_state(state, v));
+                    if(table_type::NO_STATE == next) {
+                        continue;
+                    }
+
+                    fprintf(outfile, "    ");
+                    io::fprint(outfile, cfg, table.variable_symbol(v));
+                    fprintf(outfile, "  go to state %u\n", next);
+                }
+
+                fprintf(outfile, "\n\n");
+            }
+
+            for(unsigned i(0); i < table.get_conflicts().size(); ++i) {
+                const conflict_type &conflict(table.get_conflicts()[i]);
+                report_conflict(cfg, table, terminals, conflict);
+
+                if(table_type::SHIFT_ACTION
+                    != (conflict.chosen & table_type::ACTION_MASK)) {
+                    ++num_rr;
+                } else if(table_type::SHIFT_ACTION
+                    == (conflict.dropped & table_type::ACTION_MASK)) {
+                    ++num_ss;
+                } else {
+                    ++num_sr;
+                }
+            }
+
+            fprintf(outfile,
+                "%u states, %u shift/reduce conflicts, "
+                "%u reduce/reduce conflicts, %u shift/shift conflicts.\n"
+                "%u table cells after packing, %u before packing.\n",
+                table.num_states(), num_sr, num_rr, num_ss,
+                table.num_packed_cells(), table.num_unpacked_cells()
+            );
+
+        done:
+            fclose(fp);
+
+            return ret;
+        }
+    };
+
+    template <typename AlphaT>
+    const char * const CFG_TO_LALR1<AlphaT>::TOOL_NAME("cfg-to-lalr1");
+}}
+
+#endif /* Grail_Plus_CFG_TO_LALR1_HPP_ */
@@ -38,9 +38,7 @@
 
 #include "fltl/include/CFG.hpp"
 
-#include "grail/include/cfg/compute_null_set.hpp"
-#include "grail/include/cfg/compute_first_set.hpp"
-#include "grail/include/cfg/compute_follow_set.hpp"
+#include "grail/include/cfg/GrammarAnalyses.hpp"
 
 #include "grail/include/io/CommandLineOptions.hpp"
 #include "grail/include/io/fread_cfg.hpp"
@@ -64,6 +62,16 @@ namespace grail { namespace cli {
 
         static const char * const TOOL_NAME;
 
+        /// a production along with the terminals that predict it
+        struct prediction_type {
+            production_type production;
+
+            /// the set of terminals that predict the production, or null if
+            /// only `terminal` predicts it
+            const grail::cfg::TerminalSet *terminals;
+            unsigned terminal;
+        };
+
         static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
             //io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
             if(!in_help) {
@@ -86,13 +94,6 @@ namespace grail { namespace cli {
             );
         }
 
-        static bool in_follow(
-            std::vector<std::vector<bool> *> &follow,
-            variable_type V, terminal_type a
-        ) throw() {
-            return (follow[V.number()])->at(a.number());
-        }
-
         static const char *terminal_rep(cfg_type &cfg, terminal_type a) throw() {
             if(cfg.is_variable_terminal(a)) {
                 return cfg.get_name(a);
@@ -107,8 +108,8 @@ namespace grail { namespace cli {
             production_type prod,
             terminal_type term,
             const std::vector<bool> &nullable,
-            const std::vector<std::vector<bool> *> &first,
-            const std::vector<std::vector<bool> *> &follow
+            const std::vector<grail::cfg::TerminalSet> &first,
+            const std::vector<grail::cfg::TerminalSet> &follow
         ) throw() {
 
             const char *prefix(0);
@@ -119,7 +120,7 @@ namespace grail { namespace cli {
                 if(w.at(i).is_variable()) {
                     variable_type v(w.at(i));
 
-                    if(first[v.number()]->at(term.number())) {
+                    if(first[v.number()].contains(term.number())) {
                         fprintf(stderr,
                             "'%s' is in the first set of the variable '%s'.",
                             terminal_rep(cfg, term),
@@ -173,8 +174,8 @@ namespace grail { namespace cli {
             std::map<std::pair<unsigned, unsigned>, production_type> &table,
             variable_type V, terminal_type a, production_type p,
             const std::vector<bool> &nullable,
-            const std::vector<std::vector<bool> *> &first,
-            const std::vector<std::vector<bool> *> &follow
+            const std::vector<grail::cfg::TerminalSet> &first,
+            const std::vector<grail::cfg::TerminalSet> &follow
         ) throw() {
             std::pair<unsigned, unsigned> cell(V.number(), a.number());
 
@@ -214,7 +215,7 @@ namespace grail { namespace cli {
         }
 
         static bool all_nullable(
-            std::vector<bool> &nullable,
+            const std::vector<bool> &nullable,
             symbol_string_type ss
         ) throw() {
             for(unsigned i(0); i < ss.length(); ++i) {
@@ -230,6 +231,112 @@ namespace grail { namespace cli {
             return true;
         }
 
+        /// build the LL(1) table of a grammar, reporting conflicts as
+        /// warnings and resolving them in some way or another
+        static void build_table(
+            cfg_type &cfg,
+            std::map<std::pair<unsigned, unsigned>, production_type> &table
+        ) throw() {
+
+            // the sets are kept along with the grammar
+            const std::vector<bool> &nullable(grail::cfg::nullable(cfg));
+            const std::vector<grail::cfg::TerminalSet> &first(
+                grail::cfg::first(cfg)
+            );
+            const std::vector<grail::cfg::TerminalSet> &follow(
+                grail::cfg::follow(cfg)
+            );
+
+            production_type prod;
+            variable_type A;
+            terminal_type a;
+            symbol_string_type w;
+            generator_type As(cfg.search(~A));
+            generator_type as(cfg.search(~a));
+            generator_type A_related(cfg.search(~prod, A --->* ~w));
+
+            // the terminals by number, the productions of a variable along
+            // with the sets of terminals that predict them, and the
+            // terminals that predict any production of the variable
+            std::vector<terminal_type> terminals;
+            std::vector<prediction_type> predictions;
+            grail::cfg::TerminalSet predicting_terminals;
+
+            terminals.assign(cfg.num_terminals() + 1U, a);
+            for(as.rewind(); as.match_next(); ) {
+                terminals[a.number()] = a;
+            }
+
+            for(; As.match_next(); ) {
+                predictions.clear();
+                predicting_terminals.reset(cfg.num_terminals() + 2U);
+
+                for(A_related.rewind(); A_related.match_next(); ) {
+                    prediction_type prediction;
+                    prediction.production = prod;
+                    prediction.terminals = 0;
+                    prediction.terminal = 0;
+
+                    // easy case
+                    if(w.is_empty()) {
+                        prediction.terminals = &(follow[A.number()]);
+
+                    // tricky case, need to check nullability
+                    } else if(w.at(0).is_variable()) {
+
+                        variable_type W(w.at(0));
+
+                        // succeed quickly
+                        if(!nullable[W.number()]) {
+                            prediction.terminals = &(first[W.number()]);
+
+                        } else if(all_nullable(nullable, w)){
+                            prediction.terminals = &(follow[W.number()]);
+
+                        // nothing predicts the production
+                        } else {
+                            continue;
+                        }
+
+                    // terminal, only predicted by itself
+                    } else {
+                        const terminal_type first_term(w.at(0));
+                        prediction.terminal = first_term.number();
+                    }
+
+                    if(0 != prediction.terminals) {
+                        predicting_terminals.insert_all(*(prediction.terminals));
+                    } else {
+                        predicting_terminals.insert(prediction.terminal);
+                    }
+
+                    predictions.push_back(prediction);
+                }
+
+                // go over the terminals in order, and over the productions
+                // that each one predicts
+                for(unsigned t(predicting_terminals.find_next(0));
+                    t <= cfg.num_terminals();
+                    t = predicting_terminals.find_next(t)) {
+
+                    a = terminals[t];
+
+                    for(unsigned i(0); i < predictions.size(); ++i) {
+                        const prediction_type &prediction(predictions[i]);
+
+                        if(0 == prediction.terminals
+                            ? t == prediction.terminal
+                            : prediction.terminals->contains(t)) {
+                            add_to_table(
+                                cfg, table, A, a, prediction.production,
+                                nullable, first, follow
+                            );
+                        }
+                    }
+                }
+            }
+        }
+
         static int main(io::CommandLineOptions &options) throw() {
 
             using fltl::CFG;
@@ -260,23 +367,14 @@ namespace grail { namespace cli {
 
             std::map<std::pair<unsigned, unsigned>, production_type> table;
 
-            std::vector<bool> nullable;
-            std::vector<std::vector<bool> *> first;
-            std::vector<std::vector<bool> *> follow;
-
             // add numberings to the productions
             production_type prod;
             generator_type productions(cfg.search(~prod));
 
-            // build the table, report errors as warnings and resolve in some
-            // way or another
             variable_type A;
             terminal_type a;
             symbol_string_type w;
-            generator_type As(cfg.search(~A));
             generator_type as(cfg.search(~a));
-            generator_type A_related(cfg.search(~prod, A --->* ~w));
-            std::vector<bool> empty_set;
 
             // can't bring in the cfg :(
             if(!io::fread(fp, cfg, file_name)) {
@@ -284,48 +382,7 @@ namespace grail { namespace cli {
                 goto done;
             }
 
-            // empty set of all terminals
-            empty_set.assign(cfg.num_terminals() + 2, false);
-
-            grail::cfg::compute_null_set(cfg, nullable);
-            grail::cfg::compute_first_terminals(cfg, nullable, first);
-            grail::cfg::compute_follow_set(cfg, nullable, first, follow);
-
-            for(; As.match_next(); ) {
-                for(as.rewind(); as.match_next(); ) {
-                    for(A_related.rewind(); A_related.match_next(); ) {
-
-                        // easy case
-                        if(w.is_empty()) {
-                            if(in_follow(follow, A, a)) {
-                                add_to_table(cfg, table, A, a, prod, nullable, first, follow);
-                            }
-
-                        // tricky case, need to check nullability
-                        } else if(w.at(0).is_variable()) {
-
-                            variable_type W(w.at(0));
-                            std::vector<bool> *check_set(&empty_set);
-
-                            // succeed quickly
-                            if(!nullable[W.number()]) {
-                                check_set = first[W.number()];
-
-                            } else if(all_nullable(nullable, w)){
-                                check_set = follow[W.number()];
-                            }
-
-                            if(check_set->at(a.number())) {
-                                add_to_table(cfg, table, A, a, prod, nullable, first, follow);
-                            }
-
-                        // terminal, only care about if it's the one we want
-                        } else if(w.at(0) == a) {
-                            add_to_table(cfg, table, A, a, prod, nullable, first, follow);
-                        }
-                    }
-                }
-            }
+            build_table(cfg, table);
 
             // output the file header
             fprintf(outfile,
@@ -501,17 +558,6 @@ namespace grail { namespace cli {
 
             table.clear();
 
-            for(unsigned i(0); i < first.size(); ++i) {
-                delete first[i];
-                delete follow[i];
-
-                first[i] = 0;
-                follow[i] = 0;
-            }
-
-            first.clear();
-            follow.clear();
-
             return ret;
         }
     };
@@ -0,0 +1,81 @@
+/*
+ * MappedFile.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_MAPPED_FILE_HPP_
+#define FLTL_MAPPED_FILE_HPP_
+
+#include <cstdio>
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+namespace grail { namespace io {
+
+    /// read-only view of the whole contents of a file. regular files are
+    /// memory mapped when the system allows it; anything else (e.g. a
+    /// pipe) is read into memory.
+    ///
+    /// Note: - the contents are aligned to at least 4 bytes.
+    class MappedFile : private fltl::trait::Uncopyable {
+    private:
+
+        const void *contents;
+        size_t num_bytes;
+
+        /// whether or not contents is a memory mapping
+        bool is_mapped;
+
+        /// contents of files that couldn't be mapped
+        std::vector<uint32_t> buffer;
+
+        bool map(FILE *fp) throw();
+        bool read(FILE *fp) throw();
+
+    public:
+
+        MappedFile(void) throw();
+        ~MappedFile(void) throw();
+
+        /// get the contents of a file, starting from the beginning of the
+        /// file if it hasn't been read from yet, otherwise from where it
+        /// was left off.
+        bool open(FILE *fp) throw();
+
+        inline const void *data(void) const throw() {
+            return contents;
+        }
+
+        inline size_t size(void) const throw() {
+            return num_bytes;
+        }
+    };
+}}
+
+#endif /* FLTL_MAPPED_FILE_HPP_ */
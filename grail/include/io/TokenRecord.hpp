@@ -0,0 +1,113 @@
+/*
+ * TokenRecord.hpp
+ *
+ *  Created on: May 24, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_TOKENRECORD_HPP_
+#define FLTL_TOKENRECORD_HPP_
+
+#include <cstring>
+#include <vector>
+
+#include "grail/include/io/UTF8FileTokBuffer.hpp"
+
+namespace grail { namespace io {
+
+    /// the tokens of one input record, stored back-to-back. a record can
+    /// be read by a parser in the same way as a token buffer; it returns an
+    /// empty token once all of its tokens have been read.
+    class TokenRecord {
+    private:
+
+        /// each token, followed by '\0'
+        std::vector<char> chars;
+
+        /// offset of the next token to read
+        size_t next;
+
+    public:
+
+        TokenRecord(void) throw()
+            : chars()
+            , next(0)
+        { }
+
+        /// remove all tokens, keeping the memory for the next record
+        void clear(void) throw() {
+            chars.clear();
+            next = 0;
+        }
+
+        void append(const char *token) throw() {
+            chars.insert(chars.end(), token, token + strlen(token) + 1U);
+        }
+
+        /// read the tokens from the beginning again
+        void rewind(void) throw() {
+            next = 0;
+        }
+
+        const char *read(void) throw() {
+            if(next >= chars.size()) {
+                return "";
+            }
+
+            const char *token(&(chars[next]));
+            next += strlen(token) + 1U;
+            return token;
+        }
+
+        /// fill this record with the next record of some tokens. records
+        /// are ended by a token equal to separator, or by the end of the
+        /// input. if separator is null then the rest of the input is one
+        /// record. returns false if there is no record left to read.
+        template <const unsigned LINE_LENGTH>
+        bool fill(
+            UTF8FileTokBuffer<LINE_LENGTH> &reader,
+            const char *separator
+        ) throw() {
+            clear();
+
+            bool read_something(false);
+            for(const char *token(reader.read());
+                '\0' != *token;
+                token = reader.read()) {
+
+                read_something = true;
+                if(0 != separator && 0 == strcmp(token, separator)) {
+                    break;
+                }
+
+                append(token);
+            }
+
+            return read_something;
+        }
+    };
+
+}}
+
+#endif /* FLTL_TOKENRECORD_HPP_ */
@@ -0,0 +1,102 @@
+/*
+ * binary_cfg.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_BINARY_CFG_HPP_
+#define FLTL_BINARY_CFG_HPP_
+
+#include <stdint.h>
+
+namespace grail { namespace io { namespace detail {
+
+    /// a compiled CFG (see the cfg-compile tool) is laid out as follows,
+    /// where every number is a 32-bit integer in the byte order of the
+    /// machine that wrote it:
+    ///
+    ///     header
+    ///     terminal kinds      [num_terminals]     1 for a variable terminal
+    ///     production offsets  [num_variables + 1]
+    ///     symbol offsets      [num_productions + 1]
+    ///     symbols             [num_symbols]       i is the ith variable,
+    ///                                             -i the ith terminal
+    ///     names                                   NUL-terminated names of
+    ///                                             the variables, then the
+    ///                                             terminals
+    ///
+    /// the productions of the ith variable are those in the range
+    /// [production_offsets[i - 1], production_offsets[i]), and similarly
+    /// for the symbols of the productions.
+    struct BinaryCFGHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t num_variables;
+        uint32_t num_terminals;
+        uint32_t num_productions;
+        uint32_t num_symbols;
+
+        /// variable number of the start variable, or zero
+        uint32_t start_variable;
+    };
+
+    enum {
+        BINARY_CFG_VERSION = 1U,
+        BINARY_CFG_BYTE_ORDER = 0x01020304U
+    };
+
+    /// the first byte can't begin a CFG in text form
+    static const char BINARY_CFG_MAGIC[8] = "\177Grail+";
+
+    /// byte offsets of the sections of a compiled CFG
+    class BinaryCFGLayout {
+    public:
+
+        uint64_t terminal_kinds;
+        uint64_t production_offsets;
+        uint64_t symbol_offsets;
+        uint64_t symbols;
+        uint64_t names;
+
+        explicit BinaryCFGLayout(const BinaryCFGHeader &header) throw()
+            : terminal_kinds(sizeof(BinaryCFGHeader))
+            , production_offsets(
+                terminal_kinds + 4U * static_cast<uint64_t>(header.num_terminals)
+            )
+            , symbol_offsets(
+                production_offsets
+                + 4U * (static_cast<uint64_t>(header.num_variables) + 1U)
+            )
+            , symbols(
+                symbol_offsets
+                + 4U * (static_cast<uint64_t>(header.num_productions) + 1U)
+            )
+            , names(symbols + 4U * static_cast<uint64_t>(header.num_symbols))
+        { }
+    };
+}}}
+
+#endif /* FLTL_BINARY_CFG_HPP_ */
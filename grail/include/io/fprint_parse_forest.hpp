@@ -0,0 +1,152 @@
+/*
+ * fprint_parse_forest.hpp
+ *
+ *  Created on: May 22, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_FPRINT_PARSE_FOREST_HPP_
+#define FLTL_FPRINT_PARSE_FOREST_HPP_
+
+#include <cstdio>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/cfg/ParseForest.hpp"
+
+#include "grail/include/io/fprint_cfg.hpp"
+
+namespace grail { namespace io {
+
+    /// implements printing of shared packed parse forests
+    template <typename AlphaT>
+    class fprint_parse_forest_impl {
+    public:
+
+        typedef fltl::CFG<AlphaT> cfg_type;
+        typedef grail::cfg::ParseForest<AlphaT> forest_type;
+        typedef typename forest_type::node_type node_type;
+        typedef typename forest_type::packed_node_type packed_node_type;
+        typedef typename forest_type::rule_table_type rule_table_type;
+        typedef typename cfg_type::symbol_string_type symbol_string_type;
+
+        /// print out a symbol node as (X, i, j) and an intermediate node
+        /// as (A --> alpha . beta, i, j)
+        static int print_node(
+            FILE *ff,
+            const cfg_type &gram,
+            const forest_type &forest,
+            const node_type *node
+        ) throw() {
+            int num(fprintf(ff, "("));
+
+            if(forest_type::SYMBOL_NODE == node->kind) {
+                num += fprint(ff, gram, node->symbol);
+            } else {
+                const rule_table_type &rules(forest.get_rules());
+                const symbol_string_type syms(
+                    rules.production(node->rule).symbols()
+                );
+                const unsigned dot(rules[node->rule].dot);
+
+                num += fprintf(ff, "%s ->", gram.get_name(
+                    rules.production(node->rule).variable()
+                ));
+
+                for(unsigned i(0); i < syms.length(); ++i) {
+                    if(i == dot) {
+                        num += fprintf(ff, " .");
+                    }
+                    num += fprintf(ff, " ");
+                    num += fprint(ff, gram, syms.at(i));
+                }
+
+                if(dot == syms.length()) {
+                    num += fprintf(ff, " .");
+                }
+            }
+
+            num += fprintf(ff, ", %u, %u)", node->start, node->end);
+            return num;
+        }
+    };
+
+    /// print out every node of a parse forest along with its alternative
+    /// derivations, one per line
+    template <typename AlphaT>
+    int fprint(
+        FILE *ff,
+        const fltl::CFG<AlphaT> &gram,
+        const grail::cfg::ParseForest<AlphaT> &forest
+    ) throw() {
+        typedef fprint_parse_forest_impl<AlphaT> impl;
+        typedef typename impl::node_type node_type;
+        typedef typename impl::packed_node_type packed_node_type;
+
+        int num(0);
+
+        if(0 != forest.get_root()) {
+            num += fprintf(ff, "root: ");
+            num += impl::print_node(ff, gram, forest, forest.get_root());
+            num += fprintf(ff, "\n");
+        }
+
+        for(unsigned i(0); i < forest.num_nodes(); ++i) {
+            const node_type *node(forest.get_node(i));
+            if(0 == node->first_packed) {
+                continue;
+            }
+
+            num += impl::print_node(ff, gram, forest, node);
+            num += fprintf(ff, "\n");
+
+            for(const packed_node_type *packed(node->first_packed);
+                0 != packed;
+                packed = packed->next) {
+
+                num += fprintf(ff, "    =>");
+
+                if(0 == packed->left && 0 == packed->right) {
+                    num += fprintf(ff, " epsilon");
+                }
+
+                if(0 != packed->left) {
+                    num += fprintf(ff, " ");
+                    num += impl::print_node(ff, gram, forest, packed->left);
+                }
+
+                if(0 != packed->right) {
+                    num += fprintf(ff, " ");
+                    num += impl::print_node(ff, gram, forest, packed->right);
+                }
+
+                num += fprintf(ff, "\n");
+            }
+        }
+
+        return num;
+    }
+}}
+
+#endif /* FLTL_FPRINT_PARSE_FOREST_HPP_ */
@@ -35,12 +35,153 @@
 
 #include "grail/include/cfg/ParseTree.hpp"
 
+#include "grail/include/io/fprint_cfg.hpp"
+
 namespace grail { namespace io {
 
     class dot_language { };
     class lisp_language { };
     class tree_language { };
 
+    /// implements printing of parse trees
+    template <typename AlphaT>
+    class fprint_parse_tree_impl {
+    public:
+
+        typedef fltl::CFG<AlphaT> cfg_type;
+        typedef grail::cfg::ParseTree<AlphaT> tree_type;
+        typedef typename cfg_type::terminal_type terminal_type;
+
+        /// print out the label of a node of the tree. the leaves of the tree
+        /// are printed as their lexemes, along with the name of the terminal
+        /// if the terminal is a variable terminal.
+        static int print_label(
+            FILE *ff,
+            const cfg_type &gram,
+            const tree_type *tree
+        ) throw() {
+            if(-1 != tree->num_children) {
+                return fprint(ff, gram, tree->symbol);
+            }
+
+            const terminal_type term(tree->symbol);
+            int num(0);
+
+            if(gram.is_variable_terminal(term)) {
+                num += fprintf(ff, "%s ", gram.get_name(term));
+            }
+
+            num += fprintf(ff, "\"");
+            if(0 != tree->data.alpha) {
+                num += fprint(ff, *(tree->data.alpha));
+            }
+            num += fprintf(ff, "\"");
+            return num;
+        }
+
+        /// print out an indented tree, one node per line
+        static int print_tree(
+            FILE *ff,
+            const cfg_type &gram,
+            const tree_type *tree,
+            const unsigned depth
+        ) throw() {
+            int num(0);
+            for(unsigned i(0); i < depth; ++i) {
+                num += fprintf(ff, "  ");
+            }
+
+            num += print_label(ff, gram, tree);
+            num += fprintf(ff, "\n");
+
+            for(int i(0); i < tree->num_children; ++i) {
+                if(0 != tree->data.slots[i]) {
+                    num += print_tree(ff, gram, tree->data.slots[i], depth + 1U);
+                }
+            }
+            return num;
+        }
+
+        /// print out a tree as an s-expression
+        static int print_lisp(
+            FILE *ff,
+            const cfg_type &gram,
+            const tree_type *tree
+        ) throw() {
+            if(-1 == tree->num_children) {
+                return print_label(ff, gram, tree);
+            }
+
+            int num(fprintf(ff, "("));
+            num += print_label(ff, gram, tree);
+
+            for(int i(0); i < tree->num_children; ++i) {
+                if(0 != tree->data.slots[i]) {
+                    num += fprintf(ff, " ");
+                    num += print_lisp(ff, gram, tree->data.slots[i]);
+                }
+            }
+
+            num += fprintf(ff, ")");
+            return num;
+        }
+
+        /// print out the nodes and edges of a tree in the DOT language;
+        /// returns the id of the next node
+        static unsigned print_dot(
+            FILE *ff,
+            const cfg_type &gram,
+            const tree_type *tree,
+            const unsigned id,
+            int &num
+        ) throw() {
+            num += fprintf(ff, "    n%u [label=\"", id);
+
+            if(-1 == tree->num_children) {
+                if(gram.is_variable_terminal(terminal_type(tree->symbol))) {
+                    num += fprintf(
+                        ff, "%s ", gram.get_name(terminal_type(tree->symbol))
+                    );
+                }
+
+                num += fprintf(ff, "\\\"");
+                if(0 != tree->data.alpha) {
+                    num += print_escaped(ff, *(tree->data.alpha));
+                }
+                num += fprintf(ff, "\\\"\" shape=box];\n");
+                return id + 1U;
+            }
+
+            num += fprint(ff, gram, tree->symbol);
+            num += fprintf(ff, "\"];\n");
+
+            unsigned next_id(id + 1U);
+            for(int i(0); i < tree->num_children; ++i) {
+                if(0 != tree->data.slots[i]) {
+                    num += fprintf(ff, "    n%u -> n%u;\n", id, next_id);
+                    next_id = print_dot(
+                        ff, gram, tree->data.slots[i], next_id, num
+                    );
+                }
+            }
+            return next_id;
+        }
+
+    private:
+
+        /// print out a lexeme so that it can be placed in a DOT string
+        static int print_escaped(FILE *ff, const char *lexeme) throw() {
+            int num(0);
+            for(; '\0' != *lexeme; ++lexeme) {
+                if('"' == *lexeme || '\\' == *lexeme) {
+                    num += fprintf(ff, "\\");
+                }
+                num += fprintf(ff, "%c", *lexeme);
+            }
+            return num;
+        }
+    };
+
     template <typename AlphaT>
     int fprint(
         FILE *ff,
@@ -48,10 +189,12 @@ namespace grail { namespace io {
         const grail::cfg::ParseTree<AlphaT> *tree,
         const dot_language
     ) throw() {
-
-        (void) ff;
-        (void) gram;
-        (void) tree;
+        int num(fprintf(ff, "digraph {\n"));
+        if(0 != tree) {
+            fprint_parse_tree_impl<AlphaT>::print_dot(ff, gram, tree, 0U, num);
+        }
+        num += fprintf(ff, "}\n");
+        return num;
     }
 
     template <typename AlphaT>
@@ -61,10 +204,12 @@ namespace grail { namespace io {
         const grail::cfg::ParseTree<AlphaT> *tree,
         const lisp_language
     ) throw() {
-
-        (void) ff;
-        (void) gram;
-        (void) tree;
+        if(0 == tree) {
+            return 0;
+        }
+        int num(fprint_parse_tree_impl<AlphaT>::print_lisp(ff, gram, tree));
+        num += fprintf(ff, "\n");
+        return num;
     }
 
     template <typename AlphaT>
@@ -74,10 +219,10 @@ namespace grail { namespace io {
         const grail::cfg::ParseTree<AlphaT> *tree,
         const tree_language
     ) throw() {
-
-        (void) ff;
-        (void) gram;
-        (void) tree;
+        if(0 == tree) {
+            return 0;
+        }
+        return fprint_parse_tree_impl<AlphaT>::print_tree(ff, gram, tree, 0U);
     }
 }}
 
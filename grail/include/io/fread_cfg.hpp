@@ -30,6 +30,7 @@
 #define FLTL_FREAD_CFG_HPP_
 
 #include <cstring>
+#include <vector>
 #include <stdint.h>
 
 #include "fltl/include/CFG.hpp"
@@ -37,8 +38,10 @@
 #include "grail/include/io/error.hpp"
 #include "grail/include/io/fread.hpp"
 #include "grail/include/io/verbose.hpp"
+#include "grail/include/io/MappedFile.hpp"
 #include "grail/include/io/UTF8FileBuffer.hpp"
 
+#include "grail/include/io/detail/binary_cfg.hpp"
 #include "grail/include/io/detail/find_balanced.hpp"
 #include "grail/include/io/detail/find_next.hpp"
 #include "grail/include/io/detail/find_string.hpp"
@@ -80,6 +83,14 @@ namespace grail { namespace io {
 
         uint8_t next_state(uint8_t curr_state, token_type input) throw();
 
+        /// check that a compiled CFG is well-formed, and find the names of
+        /// its variables and terminals
+        bool check_binary(
+            const MappedFile &file,
+            const char * const file_name,
+            std::vector<const char *> &names
+        ) throw();
+
         /// tokenize a file as if it contained
         template <const bool LOOK_FOR_ERRORS>
         static cfg::token_type get_token(
@@ -503,7 +514,210 @@ namespace grail { namespace io {
         }
     }
 
-    /// read in a context free grammar from a file
+    namespace cfg {
+
+        template <typename AlphaT>
+        static void verbose_sizes(const fltl::CFG<AlphaT> &CFG) throw() {
+            io::verbose("    %u variables,\n", CFG.num_variables());
+            io::verbose("    %u productions,\n", CFG.num_productions());
+            io::verbose("    %u terminals,\n", CFG.num_terminals());
+            io::verbose("    %u variable terminals.\n", CFG.num_variable_terminals());
+        }
+
+        /// productions read in from a text file but not yet added to the
+        /// grammar. a name on the right-hand side of a production is the
+        /// name of a variable only if some production defines it, which
+        /// might be further down in the file, so the names are only looked
+        /// up once the whole file has been read.
+        template <typename AlphaT>
+        class PendingProductions {
+        private:
+
+            typedef typename fltl::CFG<AlphaT>::symbol_type symbol_type;
+            typedef typename fltl::CFG<AlphaT>::variable_type variable_type;
+
+            enum {
+                NO_NAME = ~0U
+            };
+
+            /// variable of each production
+            std::vector<variable_type> variables;
+
+            /// offset of the first symbol of each production, plus one
+            /// past the last production
+            std::vector<unsigned> symbol_offsets;
+
+            /// symbols of the productions, or the offsets of their names
+            /// in `names` if they are yet to be looked up
+            std::vector<symbol_type> symbols;
+            std::vector<unsigned> name_offsets;
+
+            /// NUL-terminated names of the symbols
+            std::vector<char> names;
+
+        public:
+
+            PendingProductions(void) throw()
+                : variables()
+                , symbol_offsets(1U, 0U)
+                , symbols()
+                , name_offsets()
+                , names()
+            { }
+
+            void append(const symbol_type sym) throw() {
+                symbols.push_back(sym);
+                name_offsets.push_back(NO_NAME);
+            }
+
+            void append(const char *name) throw() {
+                symbols.push_back(symbol_type());
+                name_offsets.push_back(static_cast<unsigned>(names.size()));
+                names.insert(names.end(), name, name + strlen(name) + 1U);
+            }
+
+            /// the symbols appended since the last production make up
+            /// a production of var
+            void end_production(const variable_type var) throw() {
+                variables.push_back(var);
+                symbol_offsets.push_back(static_cast<unsigned>(symbols.size()));
+            }
+
+            /// add the productions to a grammar, in the order that they
+            /// were read
+            void add_to(fltl::CFG<AlphaT> &CFG) throw() {
+                typename fltl::CFG<AlphaT>::symbol_buffer_type prod_buffer;
+
+                for(unsigned p(0); p < variables.size(); ++p) {
+                    prod_buffer.clear();
+                    for(unsigned s(symbol_offsets[p]);
+                        s < symbol_offsets[p + 1U];
+                        ++s) {
+
+                        if(NO_NAME == name_offsets[s]) {
+                            prod_buffer.append(symbols[s]);
+                        } else {
+                            prod_buffer.append(CFG.get_variable_symbol(
+                                &(names[name_offsets[s]])
+                            ));
+                        }
+                    }
+
+                    CFG.add_production(variables[p], prod_buffer);
+                }
+            }
+        };
+
+        /// read in a context-free grammar compiled by the cfg-compile tool
+        template <typename AlphaT>
+        static bool fread_binary(
+            FILE *ff,
+            fltl::CFG<AlphaT> &CFG,
+            const char * const file_name
+        ) throw() {
+            typedef typename fltl::CFG<AlphaT>::symbol_type symbol_type;
+
+            MappedFile file;
+            std::vector<const char *> names;
+
+            if(!file.open(ff)) {
+                error(
+                    "Unable to read the compiled context-free grammar in "
+                    "'%s'.",
+                    file_name
+                );
+                return false;
+            }
+
+            if(!check_binary(file, file_name, names)) {
+                return false;
+            }
+
+            const char *bytes(reinterpret_cast<const char *>(file.data()));
+            detail::BinaryCFGHeader header;
+            memcpy(&header, bytes, sizeof header);
+
+            const detail::BinaryCFGLayout layout(header);
+            const uint32_t *terminal_kinds(reinterpret_cast<const uint32_t *>(
+                bytes + layout.terminal_kinds
+            ));
+            const uint32_t *production_offsets(
+                reinterpret_cast<const uint32_t *>(
+                    bytes + layout.production_offsets
+                )
+            );
+            const uint32_t *symbol_offsets(reinterpret_cast<const uint32_t *>(
+                bytes + layout.symbol_offsets
+            ));
+            const int32_t *symbols(reinterpret_cast<const int32_t *>(
+                bytes + layout.symbols
+            ));
+
+            // symbols of the variables, then of the terminals
+            std::vector<symbol_type> grammar_symbols(1U);
+            grammar_symbols.reserve(
+                1U + header.num_variables + header.num_terminals
+            );
+
+            for(uint32_t i(0); i < header.num_variables; ++i) {
+                grammar_symbols.push_back(CFG.get_variable(names[i]));
+            }
+
+            typename fltl::CFG<AlphaT>::alphabet_type terminal;
+            for(uint32_t i(0); i < header.num_terminals; ++i) {
+                const char *name(names[header.num_variables + i]);
+                if(0 != terminal_kinds[i]) {
+                    grammar_symbols.push_back(CFG.get_variable_symbol(name));
+                } else {
+                    fltl::CFG<AlphaT>::traits_type::unserialize(name, terminal);
+                    grammar_symbols.push_back(CFG.get_terminal(terminal));
+                }
+            }
+
+            if(0 != header.start_variable) {
+                CFG.set_start_variable(
+                    grammar_symbols[header.start_variable]
+                );
+            }
+
+            typename fltl::CFG<AlphaT>::symbol_buffer_type prod_buffer;
+
+            for(uint32_t i(0); i < header.num_variables; ++i) {
+                const typename fltl::CFG<AlphaT>::variable_type var(
+                    grammar_symbols[i + 1U]
+                );
+
+                for(uint32_t p(production_offsets[i]);
+                    p < production_offsets[i + 1U];
+                    ++p) {
+
+                    prod_buffer.clear();
+                    for(uint32_t s(symbol_offsets[p]);
+                        s < symbol_offsets[p + 1U];
+                        ++s) {
+
+                        if(0 < symbols[s]) {
+                            prod_buffer.append(grammar_symbols[
+                                static_cast<uint32_t>(symbols[s])
+                            ]);
+                        } else {
+                            prod_buffer.append(grammar_symbols[
+                                header.num_variables
+                                + static_cast<uint32_t>(-symbols[s])
+                            ]);
+                        }
+                    }
+
+                    CFG.add_production(var, prod_buffer);
+                }
+            }
+
+            return true;
+        }
+    }
+
+    /// read in a context free grammar from a file, either in text form or
+    /// compiled by the cfg-compile tool
     template <typename AlphaT>
     bool fread(
         FILE *ff,
@@ -517,6 +731,21 @@ namespace grail { namespace io {
 
         io::verbose("Reading CFG from '%s'...\n", file_name);
 
+        // compiled grammars begin with a byte that can't begin a grammar
+        // in text form
+        const int first_byte(getc(ff));
+        if(EOF != first_byte) {
+            ungetc(first_byte, ff);
+        }
+
+        if(detail::BINARY_CFG_MAGIC[0] == first_byte) {
+            if(!cfg::fread_binary(ff, CFG, file_name)) {
+                return false;
+            }
+            cfg::verbose_sizes(CFG);
+            return true;
+        }
+
         cfg::token_type tt(cfg::T_END);
         UTF8FileBuffer<cfg::BUFFER_SIZE> buffer(ff);
 
@@ -524,11 +753,13 @@ namespace grail { namespace io {
         char scratch[cfg::SCRATCH_SIZE + 20] = {'\0'};
         char *scratch_end(&(scratch[cfg::SCRATCH_SIZE - 1]));
 
-        // pre-process; this goes and looks for syntax errors and tries
-        // to build up a map of all of the variables.
+        // the productions are only added to the grammar once the whole
+        // file has been read without errors.
         uint8_t prev_state(cfg::STATE_INITIAL);
         uint8_t state(cfg::STATE_INITIAL);
         typename fltl::CFG<AlphaT>::alphabet_type terminal;
+        typename fltl::CFG<AlphaT>::variable_type var;
+        cfg::PendingProductions<AlphaT> productions;
 
         for(unsigned line(0), col(0);;) {
 
@@ -542,19 +773,11 @@ namespace grail { namespace io {
 
             if(cfg::T_ERROR == tt) {
                 return false;
-
-            // add in the terminals
-            } else if(cfg::T_TERMINAL == tt) {
-                fltl::CFG<AlphaT>::traits_type::unserialize(
-                    scratch,
-                    terminal
-                );
-                CFG.get_terminal(terminal);
             }
 
             switch(state) {
             case cfg::STATE_FINAL:
-                goto parsed_successfully;
+                goto done_parsing;
             case cfg::STATE_SINK:
 
                 switch(tt) {
@@ -602,25 +825,8 @@ namespace grail { namespace io {
                     );
                     return false;
                 }
-                CFG.get_variable(scratch);
+                var = CFG.get_variable(scratch);
                 break;
-            }
-        }
-    parsed_successfully:
-
-        // go back to the start of the file
-        buffer.reset();
-        typename fltl::CFG<AlphaT>::symbol_buffer_type prod_buffer;
-        typename fltl::CFG<AlphaT>::variable_type var;
-
-        for(state = cfg::STATE_INITIAL; ;) {
-
-            scratch[0] = '\0';
-            tt = cfg::get_token<false>(buffer, scratch, scratch_end, file_name);
-            prev_state = state;
-            state = cfg::next_state(state, tt);
-
-            switch(state) {
 
             case cfg::STATE_CAT_SINGLE_LINE:
                 goto add_symbol;
@@ -633,17 +839,9 @@ namespace grail { namespace io {
             case cfg::STATE_DONE_PRODUCTION:
                 if(cfg::STATE_CAT_SINGLE_LINE == prev_state
                 || cfg::STATE_EXTEND_OR_CAT_MULTILINE == prev_state) {
-                    CFG.add_production(var, prod_buffer);
-                    prod_buffer.clear();
+                    productions.end_production(var);
                 }
                 break;
-
-            case cfg::STATE_FINAL:
-                goto done_parsing;
-
-            case cfg::STATE_SEEN_PRODUCTION_VARIABLE:
-                var = CFG.get_variable(scratch);
-                break;
             }
 
             continue;
@@ -654,21 +852,18 @@ namespace grail { namespace io {
                     scratch,
                     terminal
                 );
-                prod_buffer.append(CFG.get_terminal(terminal));
+                productions.append(CFG.get_terminal(terminal));
             } else if(cfg::T_SYMBOL == tt) {
                 if(0 != strcmp(scratch, "epsilon")) {
-                    prod_buffer.append(CFG.get_variable_symbol(scratch));
+                    productions.append(scratch);
                 }
             }
         }
 
     done_parsing:
 
-        io::verbose("    %u variables,\n", CFG.num_variables());
-        io::verbose("    %u productions,\n", CFG.num_productions());
-        io::verbose("    %u terminals,\n", CFG.num_terminals());
-        io::verbose("    %u variable terminals.\n", CFG.num_variable_terminals());
-
+        productions.add_to(CFG);
+        cfg::verbose_sizes(CFG);
         return true;
     }
 
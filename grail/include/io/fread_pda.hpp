@@ -33,6 +33,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <map>
+#include <vector>
 #include <stdint.h>
 
 #include "fltl/include/PDA.hpp"
@@ -428,6 +429,53 @@ namespace grail { namespace io {
         }
     }
 
+    namespace pda {
+
+        /// tokens of a file that has already been checked for errors, kept
+        /// so that the file can be parsed a second time without reading it
+        /// again.
+        class TokenList {
+        private:
+
+            /// type of each token
+            std::vector<uint8_t> types;
+
+            /// offset of the text of each token in `text`
+            std::vector<unsigned> text_offsets;
+
+            /// NUL-terminated text of the tokens
+            std::vector<char> text;
+
+            unsigned next_token;
+
+        public:
+
+            TokenList(void) throw()
+                : types()
+                , text_offsets()
+                , text()
+                , next_token(0)
+            { }
+
+            void append(const token_type tt, const char *scratch) throw() {
+                types.push_back(static_cast<uint8_t>(tt));
+                text_offsets.push_back(static_cast<unsigned>(text.size()));
+                text.insert(text.end(), scratch, scratch + strlen(scratch) + 1U);
+            }
+
+            /// get the next token and copy its text into scratch
+            token_type next(char *scratch) throw() {
+                if(next_token >= types.size()) {
+                    scratch[0] = '\0';
+                    return T_END;
+                }
+
+                strcpy(scratch, &(text[text_offsets[next_token]]));
+                return static_cast<token_type>(types[next_token++]);
+            }
+        };
+    }
+
     /// read in a PDA from a file
     template <typename AlphaT>
     bool fread(
@@ -456,6 +504,10 @@ namespace grail { namespace io {
         uint8_t state(pda::STATE_START);
         uint8_t prev_state(pda::STATE_SINK);
 
+        // the tokens are parsed a second time once we know how many start
+        // states there are
+        pda::TokenList tokens;
+
         for(;;) {
             tt = pda::get_token<true>(buffer, scratch, scratch_end, file_name);
 
@@ -463,6 +515,8 @@ namespace grail { namespace io {
                 return false;
             }
 
+            tokens.append(tt, scratch);
+
             prev_state = state;
             state = pda::next_state(state, tt);
 
@@ -538,7 +592,6 @@ namespace grail { namespace io {
             state_map[start_state_val] = PDA.get_start_state();
         }
 
-        buffer.reset();
         state = pda::STATE_START;
         prev_state = pda::STATE_SINK;
         uint8_t prev_prev_state(pda::STATE_SINK);
@@ -551,9 +604,9 @@ namespace grail { namespace io {
 
         unsigned long state_id;
 
-        // re-parse without error checking
+        // re-parse the tokens without error checking
         for(;;) {
-            tt = pda::get_token<false>(buffer, scratch, scratch_end, file_name);
+            tt = tokens.next(scratch);
 
             prev_prev_state = prev_state;
             prev_state = state;
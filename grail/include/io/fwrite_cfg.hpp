@@ -0,0 +1,166 @@
+/*
+ * fwrite_cfg.hpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_FWRITE_CFG_HPP_
+#define FLTL_FWRITE_CFG_HPP_
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <stdint.h>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/io/fprint.hpp"
+
+#include "grail/include/io/detail/binary_cfg.hpp"
+
+namespace grail { namespace io {
+
+    namespace cfg {
+        template <typename T>
+        static bool fwrite_array(FILE *ff, const std::vector<T> &arr) throw() {
+            return arr.empty()
+                || arr.size() == std::fwrite(&(arr[0]), sizeof(T), arr.size(), ff);
+        }
+    }
+
+    /// write out a context-free grammar in the compiled form that fread
+    /// reads without parsing (see detail/binary_cfg.hpp)
+    template <typename AlphaT>
+    bool fwrite(FILE *ff, const fltl::CFG<AlphaT> &cfg) throw() {
+
+        typedef fltl::CFG<AlphaT> cfg_type;
+        typedef typename cfg_type::symbol_type symbol_type;
+        typedef typename cfg_type::variable_type variable_type;
+        typedef typename cfg_type::terminal_type terminal_type;
+        typedef typename cfg_type::generator_type generator_type;
+
+        typename cfg_type::frozen_grammar_type grammar;
+        cfg.freeze(grammar);
+
+        // the variables are numbered from one, in order
+        std::vector<variable_type> variables;
+        std::vector<uint32_t> variable_numbers(
+            grammar.num_variables_capacity(), 0U
+        );
+
+        variable_type V;
+        for(generator_type vars(cfg.search(~V)); vars.match_next(); ) {
+            variables.push_back(V);
+            variable_numbers[V.number()] = static_cast<uint32_t>(
+                variables.size()
+            );
+        }
+
+        std::vector<terminal_type> terminals;
+        std::vector<uint32_t> terminal_kinds;
+
+        terminal_type T;
+        for(generator_type terms(cfg.search(~T)); terms.match_next(); ) {
+            terminals.push_back(T);
+            terminal_kinds.push_back(cfg.is_variable_terminal(T) ? 1U : 0U);
+        }
+
+        std::vector<uint32_t> production_offsets(1U, 0U);
+        std::vector<uint32_t> symbol_offsets(1U, 0U);
+        std::vector<int32_t> symbols;
+
+        production_offsets.reserve(grammar.num_variables() + 1U);
+        symbol_offsets.reserve(grammar.num_productions() + 1U);
+
+        for(unsigned i(0); i < grammar.num_variables(); ++i) {
+            const unsigned var(grammar.variable(i));
+
+            for(unsigned p(grammar.productions_begin(var));
+                p < grammar.productions_end(var);
+                ++p) {
+
+                for(const symbol_type *sym(grammar.symbols_begin(p));
+                    sym < grammar.symbols_end(p);
+                    ++sym) {
+
+                    if(sym->is_variable()) {
+                        symbols.push_back(static_cast<int32_t>(
+                            variable_numbers[sym->number()]
+                        ));
+                    } else {
+                        symbols.push_back(
+                            -static_cast<int32_t>(sym->number())
+                        );
+                    }
+                }
+
+                symbol_offsets.push_back(static_cast<uint32_t>(symbols.size()));
+            }
+
+            production_offsets.push_back(
+                static_cast<uint32_t>(symbol_offsets.size() - 1U)
+            );
+        }
+
+        detail::BinaryCFGHeader header;
+        memcpy(header.magic, detail::BINARY_CFG_MAGIC, sizeof header.magic);
+        header.version = detail::BINARY_CFG_VERSION;
+        header.byte_order = detail::BINARY_CFG_BYTE_ORDER;
+        header.num_variables = static_cast<uint32_t>(variables.size());
+        header.num_terminals = static_cast<uint32_t>(terminals.size());
+        header.num_productions = grammar.num_productions();
+        header.num_symbols = static_cast<uint32_t>(symbols.size());
+        header.start_variable = grammar.has_start_variable()
+            ? variable_numbers[grammar.start_variable()]
+            : 0U;
+
+        if(1U != std::fwrite(&header, sizeof header, 1U, ff)
+        || !cfg::fwrite_array(ff, terminal_kinds)
+        || !cfg::fwrite_array(ff, production_offsets)
+        || !cfg::fwrite_array(ff, symbol_offsets)
+        || !cfg::fwrite_array(ff, symbols)) {
+            return false;
+        }
+
+        for(unsigned i(0); i < variables.size(); ++i) {
+            const char *name(cfg.get_name(variables[i]));
+            std::fwrite(name, 1U, strlen(name) + 1U, ff);
+        }
+
+        for(unsigned i(0); i < terminals.size(); ++i) {
+            if(0 != terminal_kinds[i]) {
+                const char *name(cfg.get_name(terminals[i]));
+                std::fwrite(name, 1U, strlen(name) + 1U, ff);
+            } else {
+                fprint(ff, cfg.get_alpha(terminals[i]));
+                fputc('\0', ff);
+            }
+        }
+
+        return 0 == ferror(ff);
+    }
+}}
+
+#endif /* FLTL_FWRITE_CFG_HPP_ */
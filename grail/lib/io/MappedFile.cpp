@@ -0,0 +1,131 @@
+/*
+ * MappedFile.cpp
+ *
+ *  Created on: May 28, 2012
+ *      Author: Peter Goodman
+ *     Version: $Id$
+ *
+ * Copyright 2012 Peter Goodman, all rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+
+#ifndef GRAIL_USE_JS
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#include "grail/include/io/MappedFile.hpp"
+
+namespace grail { namespace io {
+
+    enum {
+        READ_CHUNK_SIZE = 1U << 16U
+    };
+
+    MappedFile::MappedFile(void) throw()
+        : contents(0)
+        , num_bytes(0)
+        , is_mapped(false)
+        , buffer()
+    { }
+
+    MappedFile::~MappedFile(void) throw() {
+#ifndef GRAIL_USE_JS
+        if(is_mapped) {
+            munmap(const_cast<void *>(contents), num_bytes);
+        }
+#endif
+        contents = 0;
+        num_bytes = 0;
+        is_mapped = false;
+    }
+
+    bool MappedFile::open(FILE *fp) throw() {
+        if(0 == fp || 0 != contents) {
+            return false;
+        }
+
+        return map(fp) || read(fp);
+    }
+
+    /// map a regular file that hasn't been read from yet
+    bool MappedFile::map(FILE *fp) throw() {
+#ifndef GRAIL_USE_JS
+        if(0 != ftell(fp)) {
+            return false;
+        }
+
+        const int fd(fileno(fp));
+        struct stat info;
+
+        if(0 > fd || 0 != fstat(fd, &info) || !S_ISREG(info.st_mode)) {
+            return false;
+        }
+
+        if(0 >= info.st_size) {
+            return false;
+        }
+
+        void *addr(mmap(
+            0, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0
+        ));
+
+        if(MAP_FAILED == addr) {
+            return false;
+        }
+
+        contents = addr;
+        num_bytes = static_cast<size_t>(info.st_size);
+        is_mapped = true;
+        return true;
+#else
+        (void) fp;
+        return false;
+#endif
+    }
+
+    /// read what's left of a file into memory
+    bool MappedFile::read(FILE *fp) throw() {
+        size_t used(0);
+
+        for(size_t amount(READ_CHUNK_SIZE); READ_CHUNK_SIZE == amount; ) {
+            if(buffer.size() * sizeof(uint32_t) < used + READ_CHUNK_SIZE) {
+                buffer.resize(
+                    buffer.size() * 2U + READ_CHUNK_SIZE / sizeof(uint32_t), 0
+                );
+            }
+
+            char *bytes(reinterpret_cast<char *>(&(buffer[0])));
+            amount = fread(bytes + used, 1, READ_CHUNK_SIZE, fp);
+            used += amount;
+        }
+
+        if(0 != ferror(fp)) {
+            return false;
+        }
+
+        contents = &(buffer[0]);
+        num_bytes = used;
+        return true;
+    }
+}}
@@ -60,4 +60,181 @@ namespace grail { namespace io { namespace cfg {
         return trans[curr_state][input];
     }
 
+    /// is this the name of a variable or variable terminal that could be
+    /// read from a CFG in text form?
+    static bool is_symbol_name(const char *name) throw() {
+        if('\0' == *name || 0 == strcmp("epsilon", name)) {
+            return false;
+
+        } else if('$' == *name) {
+            for(++name; '\0' != *name; ++name) {
+                if(!is_numeric_codepoint(name)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        for(; '\0' != *name; ++name) {
+            if(!is_symbol_codepoint(name)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /// check that the offsets of a compiled CFG are increasing and stay
+    /// within their section
+    static bool check_offsets(
+        const uint32_t *offsets,
+        const uint32_t num_offsets,
+        const uint32_t last_offset
+    ) throw() {
+        if(0 != offsets[0] || last_offset != offsets[num_offsets - 1U]) {
+            return false;
+        }
+
+        for(uint32_t i(1U); i < num_offsets; ++i) {
+            if(offsets[i - 1U] > offsets[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool check_binary(
+        const MappedFile &file,
+        const char * const file_name,
+        std::vector<const char *> &names
+    ) throw() {
+        const char *bytes(reinterpret_cast<const char *>(file.data()));
+        const char *end(bytes + file.size());
+        detail::BinaryCFGHeader header;
+
+        if(sizeof header > file.size()) {
+            goto corrupted;
+        }
+
+        memcpy(&header, bytes, sizeof header);
+
+        if(0 != memcmp(
+            header.magic, detail::BINARY_CFG_MAGIC, sizeof header.magic
+        )) {
+            goto corrupted;
+
+        } else if(detail::BINARY_CFG_VERSION != header.version) {
+            error(
+                "The context-free grammar in '%s' was compiled by a different "
+                "version of Grail+ (format version %u instead of %u). Compile "
+                "it again with cfg-compile.",
+                file_name, header.version, detail::BINARY_CFG_VERSION
+            );
+            return false;
+
+        } else if(detail::BINARY_CFG_BYTE_ORDER != header.byte_order) {
+            error(
+                "The context-free grammar in '%s' was compiled on a machine "
+                "with a different byte order. Compile it again with "
+                "cfg-compile.",
+                file_name
+            );
+            return false;
+        }
+
+        {
+            const detail::BinaryCFGLayout layout(header);
+            if(layout.names > file.size()) {
+                goto corrupted;
+            }
+
+            const uint32_t *terminal_kinds(reinterpret_cast<const uint32_t *>(
+                bytes + layout.terminal_kinds
+            ));
+            const int32_t *symbols(reinterpret_cast<const int32_t *>(
+                bytes + layout.symbols
+            ));
+
+            if(!check_offsets(
+                reinterpret_cast<const uint32_t *>(
+                    bytes + layout.production_offsets
+                ),
+                header.num_variables + 1U,
+                header.num_productions
+            ) || !check_offsets(
+                reinterpret_cast<const uint32_t *>(
+                    bytes + layout.symbol_offsets
+                ),
+                header.num_productions + 1U,
+                header.num_symbols
+            )) {
+                goto corrupted;
+            }
+
+            if(header.start_variable > header.num_variables) {
+                goto corrupted;
+            }
+
+            for(uint32_t i(0); i < header.num_terminals; ++i) {
+                if(1U < terminal_kinds[i]) {
+                    goto corrupted;
+                }
+            }
+
+            for(uint32_t i(0); i < header.num_symbols; ++i) {
+                const int64_t sym(symbols[i]);
+                if(0 == sym
+                || static_cast<int64_t>(header.num_variables) < sym
+                || -static_cast<int64_t>(header.num_terminals) > sym) {
+                    goto corrupted;
+                }
+            }
+
+            // the names of the variables and then of the terminals take up
+            // the rest of the file
+            const uint32_t num_names(
+                header.num_variables + header.num_terminals
+            );
+            const char *name(bytes + layout.names);
+
+            names.clear();
+            names.reserve(num_names);
+
+            for(uint32_t i(0); i < num_names; ++i) {
+                const char *name_end(reinterpret_cast<const char *>(memchr(
+                    name, '\0', static_cast<size_t>(end - name)
+                )));
+
+                if(0 == name_end) {
+                    goto corrupted;
+                }
+
+                // terminal strings can be anything
+                if((i < header.num_variables
+                 || 0 != terminal_kinds[i - header.num_variables])
+                && !is_symbol_name(name)) {
+                    goto corrupted;
+                }
+
+                names.push_back(name);
+                name = name_end + 1;
+            }
+
+            if(end != name) {
+                goto corrupted;
+            }
+        }
+
+        return true;
+
+    corrupted:
+        error(
+            "The file '%s' is not a well-formed compiled context-free "
+            "grammar.",
+            file_name
+        );
+        return false;
+    }
+
 }}}
@@ -1,4 +1,5 @@
 
+#include "grail/include/cli/CFG_COMPILE.hpp"
 #include "grail/include/cli/CFG_INFO.hpp"
 #include "grail/include/cli/CFG_PARSE.hpp"
 #include "grail/include/cli/CFG_REMOVE_LR.hpp"
@@ -8,6 +9,7 @@
 #include "grail/include/cli/PDA_TO_CFG.hpp"
 #include "grail/include/cli/CFG_TO_GNF.hpp"
 #include "grail/include/cli/CFG_TO_LL1.hpp"
+#include "grail/include/cli/CFG_TO_LALR1.hpp"
 //#include "grail/include/cli/CFG_TO_TDOP.hpp"
 
 #include "grail/include/cli/NFA_TO_DOT.hpp"
@@ -15,6 +17,7 @@
 
 #include "grail/include/cli/PDA_INTERSECT_NFA.hpp"
 
+GRAIL_DECLARE_TOOL(CFG_COMPILE)
 GRAIL_DECLARE_TOOL(CFG_INFO)
 GRAIL_DECLARE_TOOL(CFG_PARSE)
 GRAIL_DECLARE_TOOL(CFG_REMOVE_LR)
@@ -23,6 +26,7 @@ GRAIL_DECLARE_TOOL(CFG_TO_CNF)
 GRAIL_DECLARE_TOOL(CFG_TO_GNF)
 GRAIL_DECLARE_TOOL(CFG_TO_PDA)
 GRAIL_DECLARE_TOOL(CFG_TO_LL1)
+GRAIL_DECLARE_TOOL(CFG_TO_LALR1)
 //GRAIL_DECLARE_TOOL(CFG_TO_TDOP)
 
 GRAIL_DECLARE_TOOL(NFA_DOMINATORS)
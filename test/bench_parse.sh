@@ -0,0 +1,21 @@
+#!/bin/bash
+#
+# bench_parse.sh
+#
+# Compare the running times of the cfg-parse engines on the sample token
+# files. Run from the root of the repository after building bin/grail.
+#
+# usage: test/bench_parse.sh [engine ...]
+#
+
+GRAIL=${GRAIL:-bin/grail}
+ENGINES=${*:-"earley cyk"}
+TIMEFORMAT="%3U s user"
+
+for grammar in ansic math ; do
+    for engine in $ENGINES ; do
+        printf "%-6s %-7s " $grammar $engine
+        time $GRAIL --tool=cfg-parse --engine=$engine \
+            test/$grammar.cfg test/$grammar.tokens | tr '\n' ' '
+    done
+done
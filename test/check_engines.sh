@@ -0,0 +1,45 @@
+#!/bin/bash
+#
+# check_engines.sh
+#
+# Check that the cfg-parse engines agree with the Earley engine. Each
+# grammar test/<name>.cfg that has a test/<name>.records file is parsed
+# by each engine, and its verdicts for the records are compared against
+# those of the Earley engine. Run from the root of the repository after
+# building bin/grail.
+#
+# usage: test/check_engines.sh [engine ...]
+#
+
+GRAIL=${GRAIL:-bin/grail}
+ENGINES=${*:-"cyk"}
+FAILED=0
+
+for records in test/*.records ; do
+    grammar=${records%.records}.cfg
+    expected=$($GRAIL --tool=cfg-parse --engine=earley --records \
+        $grammar $records)
+
+    # an engine that can't run prints no verdicts, so don't let two empty
+    # outputs pass as agreement
+    if [ $? != 0 ] || [ -z "$expected" ] ; then
+        echo "$grammar: the earley engine gave no verdicts"
+        exit 1
+    fi
+
+    for engine in $ENGINES ; do
+        printf "%-20s %-7s " $(basename $grammar .cfg) $engine
+        actual=$($GRAIL --tool=cfg-parse --engine=$engine --records \
+            $grammar $records)
+
+        if [ "$expected" == "$actual" ] ; then
+            echo "ok"
+        else
+            echo "FAILED"
+            diff <(echo "$expected") <(echo "$actual")
+            FAILED=1
+        fi
+    done
+done
+
+exit $FAILED